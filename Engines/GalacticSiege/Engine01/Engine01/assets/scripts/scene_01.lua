@@ -54,7 +54,10 @@ scene = {
                 circle_collider = {
                     radius = 32,
                     width = 64,
-                    heigth = 64
+                    heigth = 64,
+                    layer = collision_layer.player,
+                    mask = collision_layer.enemy | collision_layer.enemy_bullet
+                        | collision_layer.boss_bullet | collision_layer.power_up
                 },
                 rigid_body = {
                     velocity = {x = 0, y = 0},
@@ -63,7 +63,10 @@ scene = {
                 circle_collider = {
                     radius = 32,
                     width = 64,
-                    heigth = 64
+                    heigth = 64,
+                    layer = collision_layer.player,
+                    mask = collision_layer.enemy | collision_layer.enemy_bullet
+                        | collision_layer.boss_bullet | collision_layer.power_up
                 },
                 rigid_body = {
                     velocity = {x = 0, y = 0},
@@ -140,7 +143,9 @@ scene = {
                 circle_collider = {
                     radius = 100,
                     width = 256,
-                    heigth = 256
+                    heigth = 256,
+                    layer = collision_layer.enemy,
+                    mask = collision_layer.player | collision_layer.player_bullet
                 },
                 rigid_body = {
                     velocity = {x = 0, y = 0},
@@ -14,7 +14,7 @@
  * @param scriptPath Path to the Lua script file.
  * @param luaFunctionName The name of the Lua function to bind.
  */
-void AddScriptComponent(Entity entity, const std::string& scriptPath, const std::string& luaFunctionName);
+void AddScriptComponent(DeferredEntity entity, const std::string& scriptPath, const std::string& luaFunctionName);
 /**
  * @brief Adds TransformComponent and RigidBodyComponent to enemy entities with randomized start positions and velocities.
  *
@@ -23,7 +23,7 @@ void AddScriptComponent(Entity entity, const std::string& scriptPath, const std:
  * @param windowWidth Width of the game window.
  * @param type Type identifier of the entity to define behavior.
  */
-void AddTransformAndRigidBodyComponent(Entity enemy, int windowHeigth, int windowWidth, int type);
+void AddTransformAndRigidBodyComponent(DeferredEntity enemy, int windowHeigth, int windowWidth, int type);
 /**
  * @brief Plays a sound effect by ID at a given volume.
  *
@@ -74,12 +74,13 @@ void GoToNextScene() {
  * @param playerY Y position of the player.
  */
 void BulletFactory(double playerX, double playerY) {
-	Entity bullet = Game::GetInstance().registry->CreateEntity();
-	bullet.AddComponent<CircleColliderComponent>(32, 32, 32);
-	bullet.AddComponent<RigidBodyComponent>(glm::vec2(0, -400));
-	bullet.AddComponent<SpriteComponent>("bullet", 64, 64, 0, 0);
-	bullet.AddComponent<TransformComponent>(glm::vec2(playerX + 10, playerY + 10), glm::vec2(0.5, 0.5), 0.0);
-	bullet.AddComponent<EntityTypeComponent>(2);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity bullet = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(bullet, 32, 32, 32, LAYER_PLAYER_BULLET, LAYER_ENEMY | LAYER_BOSS_BULLET);
+	commands.AddComponent<RigidBodyComponent>(bullet, glm::vec2(0, -400), true);
+	commands.AddComponent<SpriteComponent>(bullet, "bullet", 64, 64, 0, 0);
+	commands.AddComponent<TransformComponent>(bullet, glm::vec2(playerX + 10, playerY + 10), glm::vec2(0.5, 0.5), 0.0);
+	commands.AddComponent<EntityTypeComponent>(bullet, 2);
 	PlaySoundEffect("player_shoot", 16);
 }
 /**
@@ -90,12 +91,13 @@ void BulletFactory(double playerX, double playerY) {
  */
 void EnemyBulletsFactory(double enemyX, double enemyY) {
 	glm::vec2 enemyPos(enemyX + 10, enemyY + 10);
-	Entity enemyBullet = Game::GetInstance().registry->CreateEntity();
-	enemyBullet.AddComponent<CircleColliderComponent>(25, 20, 42);
-	enemyBullet.AddComponent<RigidBodyComponent>(glm::vec2(0, 400));
-	enemyBullet.AddComponent<SpriteComponent>("enemy1projectile", 14, 42, 0, 0);
-	enemyBullet.AddComponent<TransformComponent>(enemyPos, glm::vec2(1.0, 1.0), 0.0);
-	enemyBullet.AddComponent<EntityTypeComponent>(4);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity enemyBullet = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(enemyBullet, 25, 20, 42, LAYER_ENEMY_BULLET, LAYER_PLAYER);
+	commands.AddComponent<RigidBodyComponent>(enemyBullet, glm::vec2(0, 400), true);
+	commands.AddComponent<SpriteComponent>(enemyBullet, "enemy1projectile", 14, 42, 0, 0);
+	commands.AddComponent<TransformComponent>(enemyBullet, enemyPos, glm::vec2(1.0, 1.0), 0.0);
+	commands.AddComponent<EntityTypeComponent>(enemyBullet, 4);
 }
 /**
  * @brief Enemy type 3 attacks by firing bullets in 8 directions.
@@ -109,14 +111,15 @@ void Enemy3Attack(double enemyX, double enemyY) {
 		glm::vec2(0, -1), glm::vec2(0.707f, -0.707f), glm::vec2(1, 0), glm::vec2(0.707f, 0.707f),
 		glm::vec2(0, 1), glm::vec2(-0.707f, 0.707f), glm::vec2(-1, 0), glm::vec2(-0.707f, -0.707f)
 	};
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
 	for (const auto& dir : directions) {
 		float angle = glm::degrees(atan2(dir.y, dir.x)) - 45.0f;
-		Entity enemyBullet = Game::GetInstance().registry->CreateEntity();
-		enemyBullet.AddComponent<CircleColliderComponent>(32, 32, 32);
-		enemyBullet.AddComponent<RigidBodyComponent>(dir * 300.0f);
-		enemyBullet.AddComponent<SpriteComponent>("enemy3projectile", 32, 32, 0, 0);
-		enemyBullet.AddComponent<TransformComponent>(enemyPos, glm::vec2(0.75, 0.75), angle);
-		enemyBullet.AddComponent<EntityTypeComponent>(4);
+		DeferredEntity enemyBullet = commands.CreateEntity();
+		commands.AddComponent<CircleColliderComponent>(enemyBullet, 32, 32, 32, LAYER_ENEMY_BULLET, LAYER_PLAYER);
+		commands.AddComponent<RigidBodyComponent>(enemyBullet, dir * 300.0f, true);
+		commands.AddComponent<SpriteComponent>(enemyBullet, "enemy3projectile", 32, 32, 0, 0);
+		commands.AddComponent<TransformComponent>(enemyBullet, enemyPos, glm::vec2(0.75, 0.75), angle);
+		commands.AddComponent<EntityTypeComponent>(enemyBullet, 4);
 	}
 }
 /**
@@ -126,15 +129,16 @@ void Enemy3Attack(double enemyX, double enemyY) {
  * @param windowWidth Game window width.
  */
 void Enemy1Factory(int windowHeight, int windowWidth) {
-	Entity enemy1 = Game::GetInstance().registry->CreateEntity();
-	enemy1.AddComponent<CircleColliderComponent>(64, 64, 64);
-	enemy1.AddComponent<SpriteComponent>("enemy1", 128, 128, 0, 0);
-	enemy1.AddComponent<HealthComponent>(3);
-	enemy1.AddComponent<ScoreComponent>(100);
-	enemy1.AddComponent<EntityTypeComponent>(3);
-	enemy1.AddComponent<IsEntityInsideTheScreenComponent>(false);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity enemy1 = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(enemy1, 64, 64, 64, LAYER_ENEMY, LAYER_PLAYER | LAYER_PLAYER_BULLET);
+	commands.AddComponent<SpriteComponent>(enemy1, "enemy1", 128, 128, 0, 0);
+	commands.AddComponent<HealthComponent>(enemy1, 3);
+	commands.AddComponent<ScoreComponent>(enemy1, 100);
+	commands.AddComponent<EntityTypeComponent>(enemy1, 3);
+	commands.AddComponent<IsEntityInsideTheScreenComponent>(enemy1, false);
 	AddScriptComponent(enemy1, "./assets/scripts/enemy1.lua", "updateEnemy1Position");
-	AddTransformAndRigidBodyComponent(enemy1, windowHeight, windowWidth, enemy1.GetComponent<EntityTypeComponent>().entityType);
+	AddTransformAndRigidBodyComponent(enemy1, windowHeight, windowWidth, 3);
 }
 /**
  * @brief Factory function to create enemy 2.
@@ -143,14 +147,15 @@ void Enemy1Factory(int windowHeight, int windowWidth) {
  * @param windowWidth Game window width.
  */
 void Enemy2Factory(int windowHeight, int windowWidth) {
-	Entity enemy2 = Game::GetInstance().registry->CreateEntity();
-	enemy2.AddComponent<CircleColliderComponent>(64, 64, 64);
-	enemy2.AddComponent<SpriteComponent>("enemy2", 128, 128, 0, 0);
-	enemy2.AddComponent<HealthComponent>(2);
-	enemy2.AddComponent<ScoreComponent>(50);
-	enemy2.AddComponent<EntityTypeComponent>(5);
-	enemy2.AddComponent<IsEntityInsideTheScreenComponent>(false);
-	AddTransformAndRigidBodyComponent(enemy2, windowHeight, windowWidth, enemy2.GetComponent<EntityTypeComponent>().entityType);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity enemy2 = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(enemy2, 64, 64, 64, LAYER_ENEMY, LAYER_PLAYER | LAYER_PLAYER_BULLET);
+	commands.AddComponent<SpriteComponent>(enemy2, "enemy2", 128, 128, 0, 0);
+	commands.AddComponent<HealthComponent>(enemy2, 2);
+	commands.AddComponent<ScoreComponent>(enemy2, 50);
+	commands.AddComponent<EntityTypeComponent>(enemy2, 5);
+	commands.AddComponent<IsEntityInsideTheScreenComponent>(enemy2, false);
+	AddTransformAndRigidBodyComponent(enemy2, windowHeight, windowWidth, 5);
 }
 /**
  * @brief Factory function to create enemy 3.
@@ -159,15 +164,16 @@ void Enemy2Factory(int windowHeight, int windowWidth) {
  * @param windowWidth Game window width.
  */
 void Enemy3Factory(int windowHeight, int windowWidth) {
-	Entity enemy3 = Game::GetInstance().registry->CreateEntity();
-	enemy3.AddComponent<CircleColliderComponent>(96, 96, 96);
-	enemy3.AddComponent<SpriteComponent>("enemy3", 128, 128, 0, 0);
-	enemy3.AddComponent<HealthComponent>(6);
-	enemy3.AddComponent<ScoreComponent>(250);
-	enemy3.AddComponent<EntityTypeComponent>(6);
-	enemy3.AddComponent<IsEntityInsideTheScreenComponent>(false);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity enemy3 = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(enemy3, 96, 96, 96, LAYER_ENEMY, LAYER_PLAYER | LAYER_PLAYER_BULLET);
+	commands.AddComponent<SpriteComponent>(enemy3, "enemy3", 128, 128, 0, 0);
+	commands.AddComponent<HealthComponent>(enemy3, 6);
+	commands.AddComponent<ScoreComponent>(enemy3, 250);
+	commands.AddComponent<EntityTypeComponent>(enemy3, 6);
+	commands.AddComponent<IsEntityInsideTheScreenComponent>(enemy3, false);
 	AddScriptComponent(enemy3, "./assets/scripts/enemy3.lua", "updateEnemy3Position");
-	AddTransformAndRigidBodyComponent(enemy3, windowHeight, windowWidth, enemy3.GetComponent<EntityTypeComponent>().entityType);
+	AddTransformAndRigidBodyComponent(enemy3, windowHeight, windowWidth, 6);
 }
 /**
  * @brief Factory function to create an extra life power-up at a random position.
@@ -176,14 +182,15 @@ void Enemy3Factory(int windowHeight, int windowWidth) {
  * @param windowWidth Game window width.
  */
 void ExtraLifeFactory(int windowHeigth, int windowWidth) {
-	Entity extraLife = Game::GetInstance().registry->CreateEntity();
-	extraLife.AddComponent<CircleColliderComponent>(50, 50, 50);
-	extraLife.AddComponent<SpriteComponent>("extraLife", 87, 87, 0, 0);
-	extraLife.AddComponent<EntityTypeComponent>(10);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity extraLife = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(extraLife, 50, 50, 50, LAYER_POWER_UP, LAYER_PLAYER);
+	commands.AddComponent<SpriteComponent>(extraLife, "extraLife", 87, 87, 0, 0);
+	commands.AddComponent<EntityTypeComponent>(extraLife, 10);
 	int posX = rand() % (windowWidth - 50);
 	int posY = rand() % (windowHeigth - 50);
 	glm::vec2 pos = glm::vec2(posX, posY);
-	extraLife.AddComponent<TransformComponent>(pos, glm::vec2(0.5, 0.5), 0.0);
+	commands.AddComponent<TransformComponent>(extraLife, pos, glm::vec2(0.5, 0.5), 0.0);
 }
 /**
  * @brief Factory function to create a nuke power-up at a random position.
@@ -192,14 +199,15 @@ void ExtraLifeFactory(int windowHeigth, int windowWidth) {
  * @param windowWidth Game window width.
  */
 void NukeFactory(int windowHeigth, int windowWidth) {
-	Entity nuke = Game::GetInstance().registry->CreateEntity();
-	nuke.AddComponent<CircleColliderComponent>(50, 50, 50);
-	nuke.AddComponent<SpriteComponent>("nuke", 87, 87, 0, 0);
-	nuke.AddComponent<EntityTypeComponent>(11);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity nuke = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(nuke, 50, 50, 50, LAYER_POWER_UP, LAYER_PLAYER);
+	commands.AddComponent<SpriteComponent>(nuke, "nuke", 87, 87, 0, 0);
+	commands.AddComponent<EntityTypeComponent>(nuke, 11);
 	int posX = rand() % (windowWidth - 50);
 	int posY = rand() % (windowHeigth - 50);
 	glm::vec2 pos = glm::vec2(posX, posY);
-	nuke.AddComponent<TransformComponent>(pos, glm::vec2(0.5, 0.5), 0.0);
+	commands.AddComponent<TransformComponent>(nuke, pos, glm::vec2(0.5, 0.5), 0.0);
 }
 /**
  * @brief Creates a boss projectile entity.
@@ -212,15 +220,16 @@ void NukeFactory(int windowHeigth, int windowWidth) {
 void BossAttack(double dirX, double dirY, double posX, double posY) {
 	glm::vec2 dir(dirX, dirY);
 	glm::vec2 pos(posX + 25, posY + 25);
-	Entity bossBullet = Game::GetInstance().registry->CreateEntity();
-	bossBullet.AddComponent<CircleColliderComponent>(32, 32, 32);
-	bossBullet.AddComponent<RigidBodyComponent>(dir);
-	bossBullet.AddComponent<SpriteComponent>("bossProjectile", 32, 32, 0, 0);
-	bossBullet.AddComponent<TransformComponent>(pos, glm::vec2(1.0, 1.0), 0.0);
-	bossBullet.AddComponent<EntityTypeComponent>(13);
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
+	DeferredEntity bossBullet = commands.CreateEntity();
+	commands.AddComponent<CircleColliderComponent>(bossBullet, 32, 32, 32, LAYER_BOSS_BULLET, LAYER_PLAYER | LAYER_PLAYER_BULLET);
+	commands.AddComponent<RigidBodyComponent>(bossBullet, dir, true);
+	commands.AddComponent<SpriteComponent>(bossBullet, "bossProjectile", 32, 32, 0, 0);
+	commands.AddComponent<TransformComponent>(bossBullet, pos, glm::vec2(1.0, 1.0), 0.0);
+	commands.AddComponent<EntityTypeComponent>(bossBullet, 13);
 }
 
-void AddScriptComponent(Entity entity, const std::string& scriptPath, const std::string& luaFunctionName) {
+void AddScriptComponent(DeferredEntity entity, const std::string& scriptPath, const std::string& luaFunctionName) {
 	sol::state& lua = Game::GetInstance().lua;
 	lua.script_file(scriptPath);
 
@@ -264,11 +273,12 @@ void AddScriptComponent(Entity entity, const std::string& scriptPath, const std:
 		script.createNuke = func;
 	}
 
-	entity.AddComponent<ScriptComponent>(script);
+	Game::GetInstance().registry->GetCommandBuffer().AddComponent<ScriptComponent>(entity, std::move(script));
 }
 
 
-void AddTransformAndRigidBodyComponent(Entity enemy, int windowHeight, int windowWidth, int type) {
+void AddTransformAndRigidBodyComponent(DeferredEntity enemy, int windowHeight, int windowWidth, int type) {
+	CommandBuffer& commands = Game::GetInstance().registry->GetCommandBuffer();
 	glm::vec2 startPosition;
 	glm::vec2 velocity;
 	int edge = 0;
@@ -292,7 +302,7 @@ void AddTransformAndRigidBodyComponent(Entity enemy, int windowHeight, int windo
 			velocity = glm::vec2(0, -100);
 			break;
 		}
-		enemy.AddComponent<TransformComponent>(startPosition, glm::vec2(0.75, 0.75), 0.0);
+		commands.AddComponent<TransformComponent>(enemy, startPosition, glm::vec2(0.75, 0.75), 0.0);
 	}
 	else {
 		edge = rand() % 2;
@@ -313,9 +323,9 @@ void AddTransformAndRigidBodyComponent(Entity enemy, int windowHeight, int windo
 			velocity = glm::vec2(-150, 0);
 			break;
 		}
-		enemy.AddComponent<TransformComponent>(startPosition, glm::vec2(0.5, 0.5), 0.0);
+		commands.AddComponent<TransformComponent>(enemy, startPosition, glm::vec2(0.5, 0.5), 0.0);
 	}
-	enemy.AddComponent<RigidBodyComponent>(velocity);
+	commands.AddComponent<RigidBodyComponent>(enemy, velocity);
 }
 
 void PlaySoundEffect(std::string soundEffectId, int volume) {
@@ -331,7 +341,11 @@ void PlaySoundEffect(std::string soundEffectId, int volume) {
  * @return int Boss health.
  */
 int CheckBossHealth() {
-	int bossHealth = Game::GetInstance().registry->GetSystem<GameManagerSystem>().GetBoss().GetComponent<HealthComponent>().health;
+	Entity boss = Game::GetInstance().registry->GetSystem<GameManagerSystem>().GetBoss();
+	if (!boss.HasComponent<HealthComponent>()) {
+		return 0;
+	}
+	int bossHealth = boss.GetComponent<HealthComponent>().health;
 	bool condition = true;
 	if (bossHealth == 10 && condition) {
 		PlaySoundEffect("bossScream", 40);
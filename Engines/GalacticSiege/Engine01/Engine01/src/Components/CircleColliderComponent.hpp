@@ -1,15 +1,35 @@
 #ifndef CIRCLECOLLIDERCOMPONENT_HPP
 #define CIRCLECOLLIDERCOMPONENT_HPP
 
+/**
+ * @brief Collision layers of the game, one bit each.
+ *
+ * A collider belongs to a layer and has a mask with the layers it collides with. Scene scripts
+ * can use the same values through the collision_layer table.
+ */
+enum CollisionLayer : unsigned int {
+	LAYER_DEFAULT = 1u << 0,        ///< Colliders that set no layer.
+	LAYER_PLAYER = 1u << 1,         ///< The player ship.
+	LAYER_PLAYER_BULLET = 1u << 2,  ///< Bullets shot by the player.
+	LAYER_ENEMY = 1u << 3,          ///< Enemies and the boss.
+	LAYER_ENEMY_BULLET = 1u << 4,   ///< Bullets shot by enemies.
+	LAYER_BOSS_BULLET = 1u << 5,    ///< Bullets shot by the boss, which player bullets can destroy.
+	LAYER_POWER_UP = 1u << 6,       ///< Extra lives and nukes.
+	LAYER_ALL = 0xFFFFFFFFu         ///< Mask that collides with every layer.
+};
+
 /**
  * @brief Component representing a circular collider for an entity.
  *
- * Contains the radius and dimensions of the collider.
+ * Contains the radius and dimensions of the collider, and the collision layer it belongs to
+ * together with the mask of layers it collides with.
  */
 struct CircleColliderComponent {
 	int radius; ///< Radius of the circular collider.
 	int width;  ///< Width of the collider's bounding box.
 	int height; ///< Height of the collider's bounding box.
+	unsigned int layer; ///< Layer bit of the collider.
+	unsigned int mask;  ///< Layers this collider collides with.
 
 	/**
 	 * @brief Construct a new CircleColliderComponent object.
@@ -17,12 +37,17 @@ struct CircleColliderComponent {
 	 * @param radius Radius of the circle collider (default 0).
 	 * @param width Width of the bounding box (default 0).
 	 * @param height Height of the bounding box (default 0).
+	 * @param layer Layer bit of the collider (default LAYER_DEFAULT).
+	 * @param mask Layers the collider collides with (default LAYER_ALL).
 	 */
-	CircleColliderComponent(int radius = 0, int width = 0, int height = 0) {
+	CircleColliderComponent(int radius = 0, int width = 0, int height = 0,
+		unsigned int layer = LAYER_DEFAULT, unsigned int mask = LAYER_ALL) {
 		this->radius = radius;
 		this->width = width;
 		this->height = height;
+		this->layer = layer;
+		this->mask = mask;
 	}
 };
 
-#endif // !CIRCLECOLLIDERCOMPONENT_HPP
\ No newline at end of file
+#endif // !CIRCLECOLLIDERCOMPONENT_HPP
@@ -5,17 +5,24 @@
 
 /**
  * @brief Component that stores velocity for physics calculations.
+ *
+ * Fast bodies, such as bullets, may move farther than the size of a collider in one frame, so
+ * the collision system sweeps their collider along the path of the frame instead of only testing
+ * where it ends.
  */
 struct RigidBodyComponent {
 	glm::vec2 velocity;  ///< Velocity vector of the entity.
+	bool isFast;         ///< Whether collisions are searched along the whole movement of the frame.
 
     /**
      * @brief Construct a new Rigid Body Component object
      *
      * @param velocity Initial velocity (default is zero vector).
+     * @param isFast Whether the collider is swept along its movement (default false).
      */
-	RigidBodyComponent(glm::vec2 velocity = glm::vec2(0.0)) {
+	RigidBodyComponent(glm::vec2 velocity = glm::vec2(0.0), bool isFast = false) {
 		this->velocity = velocity;
+		this->isFast = isFast;
 	}
 };
 
@@ -1,6 +1,7 @@
 #ifndef SCRIPTCOMPONENT_HPP 
 #define SCRIPTCOMPONENT_HPP
 
+#include <utility>
 #include <sol/sol.hpp>
 
 /**
@@ -43,17 +44,17 @@ struct ScriptComponent {
 		sol::function createEnemy3 = sol::lua_nil, sol::function createExtraLife = sol::lua_nil,
 		sol::function updateEnemy3Position = sol::lua_nil, sol::function bossMechanics = sol::lua_nil,
 		sol::function createNuke = sol::lua_nil) {
-		this->update = update;
-		this->onClick = onClick;
-		this->updateBullets = updateBullets;
-		this->updateEnemy1Position = updateEnemy1Position;
-		this->createEnemy1 = createEnemy1;
-		this->createEnemy2 = createEnemy2;
-		this->createEnemy3 = createEnemy3;
-		this->createExtraLife = createExtraLife;
-		this->updateEnemy3Position = updateEnemy3Position;
-		this->bossMechanics = bossMechanics;
-		this->createNuke = createNuke;
+		this->update = std::move(update);
+		this->onClick = std::move(onClick);
+		this->updateBullets = std::move(updateBullets);
+		this->updateEnemy1Position = std::move(updateEnemy1Position);
+		this->createEnemy1 = std::move(createEnemy1);
+		this->createEnemy2 = std::move(createEnemy2);
+		this->createEnemy3 = std::move(createEnemy3);
+		this->createExtraLife = std::move(createExtraLife);
+		this->updateEnemy3Position = std::move(updateEnemy3Position);
+		this->bossMechanics = std::move(bossMechanics);
+		this->createNuke = std::move(createNuke);
 	}
 };
 
@@ -4,6 +4,7 @@
 #include <SDL.h>
 
 #include <string>
+#include <utility>
 
 /**
  * @brief Component representing a sprite for rendering.
@@ -25,9 +26,9 @@ struct SpriteComponent {
 	 * @param srcRectX X coordinate of the source rectangle within the texture. Default is 0.
 	 * @param srcRectY Y coordinate of the source rectangle within the texture. Default is 0.
 	 */
-	SpriteComponent(const std::string& textureId = "none", int width = 0,
+	SpriteComponent(std::string textureId = "none", int width = 0,
 		int height = 0, int srcRectX = 0, int srcRectY = 0) {
-		this->textureId = textureId;
+		this->textureId = std::move(textureId);
 		this->width = width;
 		this->height = height;
 		this->srcRect = {srcRectX, srcRectY, width, height};
@@ -3,6 +3,7 @@
 
 #include <SDL.h>
 #include <string>
+#include <utility>
 
 /**
  * @brief Component that holds text rendering information.
@@ -26,9 +27,9 @@ struct TextComponent {
 	 * @param b Blue component of text color (0-255). Default 0.
 	 * @param a Alpha component (opacity) of text color (0-255). Default 0.
 	 */
-	TextComponent(const std::string& text = "", const std::string& fontId = "", uint8_t r = 0, uint8_t g = 0, uint8_t b = 0, uint8_t a = 0) {
-		this->text = text;
-		this->fontId = fontId;
+	TextComponent(std::string text = "", std::string fontId = "", uint8_t r = 0, uint8_t g = 0, uint8_t b = 0, uint8_t a = 0) {
+		this->text = std::move(text);
+		this->fontId = std::move(fontId);
 		this->textColor.r = r;
 		this->textColor.g = g;
 		this->textColor.b = b;
@@ -2,16 +2,24 @@
 #define ECS_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <atomic>
 #include <bitset>
+#include <cassert>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <set>
 #include <deque>
 #include <typeindex>
+#include <tuple>
 #include <iostream>
+#include <mutex>
+#include <functional>
+#include <type_traits>
 
 #include "../Utils/Pool.hpp"
+#include "../JobSystem/JobSystem.hpp"
 
 /// Maximum number of different components supported.
 const unsigned int MAX_COMPONENTS = 64;
@@ -19,6 +27,13 @@ const unsigned int MAX_COMPONENTS = 64;
 /// Alias for component signature, represented as a bitset.
 typedef std::bitset<MAX_COMPONENTS> Signature;
 
+/// Bits of an entity handle holding the index; the high bits hold the version.
+const unsigned int ENTITY_INDEX_BITS = 20;
+/// Mask selecting the index bits of an entity handle.
+const std::uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+/// Mask selecting the version once shifted out of an entity handle.
+const std::uint32_t ENTITY_VERSION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+
 /**
  * @brief Base interface for components. Provides a static counter for unique IDs.
  */
@@ -48,6 +63,10 @@ public:
 
 /**
  * @brief Represents an entity in the ECS.
+ *
+ * The entity is a 32-bit handle: an index used to look up its components plus the
+ * version of that index. The version changes when the entity is destroyed, so a
+ * stale copy never aliases a new entity that reuses the index.
  */
 class Entity {
 public:
@@ -56,15 +75,21 @@ public:
 	 */
 	Entity();
 	/**
-	 * @brief Constructor with explicit ID.
-	 * @param id Entity identifier.
+	 * @brief Constructor with explicit index and version.
+	 * @param id Entity index.
+	 * @param version Version of the index when the entity was created.
 	 */
-	Entity(int id);
+	Entity(int id, std::uint32_t version = 0);
 	/**
-	 * @brief Gets the ID of the entity.
-	 * @return int Entity ID.
+	 * @brief Gets the index of the entity.
+	 * @return int Entity index.
 	 */
 	int GetId() const;
+	/**
+	 * @brief Gets the version of the entity index.
+	 * @return std::uint32_t Entity version.
+	 */
+	std::uint32_t GetVersion() const;
 	/**
 	 * @brief Marks the entity as killed (to be removed).
 	 */
@@ -74,12 +99,12 @@ public:
 	 * @return true If the entity is active.
 	 * @return false If the entity is marked dead.
 	 */
-	bool IsAlive();
-	// Comparison operators by entity ID
-	bool operator ==(const Entity& other) const { return id == other.id; };
-	bool operator !=(const Entity& other) const { return id != other.id; };
-	bool operator<(const Entity& other) const { return id < other.id; };
-	bool operator>(const Entity& other) const { return id > other.id; };
+	bool IsAlive() const;
+	// Comparison operators by entity handle
+	bool operator ==(const Entity& other) const { return handle == other.handle; };
+	bool operator !=(const Entity& other) const { return handle != other.handle; };
+	bool operator<(const Entity& other) const { return handle < other.handle; };
+	bool operator>(const Entity& other) const { return handle > other.handle; };
 	/**
 	 * @brief Adds a component to the entity.
 	 *
@@ -115,10 +140,10 @@ public:
 	TComponent& GetComponent() const;
 
 	/// Pointer to the registry managing this entity.
-	class Registry* registry;
+	class Registry* registry = nullptr;
 private:
-	/// Unique entity ID.
-	size_t id;
+	/// Index in the low bits, version in the high bits.
+	std::uint32_t handle;
 };
 
 /**
@@ -134,7 +159,7 @@ public:
 	 */
 	void AddEntityToSystem(Entity entity);
 	/**
-	 * @brief Removes an entity from the system.
+	 * @brief Removes an entity from the system in constant time, moving the last entity into its slot.
 	 * @param entity Entity to remove.
 	 */
 	void RemoveEntityFromSystem(Entity entity);
@@ -143,6 +168,19 @@ public:
 	 * @return std::vector<Entity> Vector of entities.
 	 */
 	std::vector<Entity> GetSystemEntiities() const;
+	/**
+	 * @brief Calls func(Entity) for every entity of the system, in chunks run in parallel.
+	 *
+	 * The function may touch the components of its entity and kill it, but must not
+	 * create entities or add or remove components.
+	 *
+	 * @tparam TFunc Callable type.
+	 * @param jobSystem Workers that run the chunks.
+	 * @param func Function to call.
+	 * @param chunkSize Number of entities per job.
+	 */
+	template <typename TFunc>
+	void ParallelForEach(JobSystem& jobSystem, TFunc func, int chunkSize = JobSystem::DEFAULT_CHUNK_SIZE) const;
 	/**
 	 * @brief Returns the signature of components required by this system.
 	 * @return const Signature& Component signature.
@@ -155,11 +193,270 @@ public:
 	 */
 	template<typename TComponent>
 	void RequiredComponent();
+
+	/// Pointer to the registry owning this system, set by Registry::AddSystem.
+	class Registry* registry = nullptr;
 private:
 	/// Signature of required components.
 	Signature componentSignature;
 	/// List of entities that match the signature.
 	std::vector<Entity> entities;
+	/// Position of each entity index in the entities list, or -1.
+	std::vector<int> entityIdToIndex;
+};
+
+/**
+ * @brief Iterates the entities that own a set of components, reading the pools directly.
+ *
+ * Walks the packed storage of the first component type and skips entities missing any
+ * of the others, so it allocates nothing. Entities that gain the first component while
+ * iterating are visited on the next pass.
+ *
+ * @tparam TComponents Component types an entity must own.
+ */
+template <typename... TComponents>
+class View {
+public:
+	/**
+	 * @brief Constructs a view over the given pools.
+	 * @param registry Registry owning the pools.
+	 * @param pools One pool per component type, or nullptr if it does not exist yet.
+	 */
+	View(class Registry* registry, Pool<TComponents>*... pools)
+		: registry(registry), pools(pools...) {}
+	/**
+	 * @brief Calls func(Entity, TComponents&...) for every matching entity.
+	 *
+	 * @tparam TFunc Callable type.
+	 * @param func Function to call.
+	 */
+	template <typename TFunc>
+	void Each(TFunc func) const;
+	/**
+	 * @brief Same as Each, but splits the entities in chunks run in parallel.
+	 *
+	 * The function may touch the components it gets and kill the entity, but must not
+	 * create entities or add or remove components.
+	 *
+	 * @tparam TFunc Callable type.
+	 * @param jobSystem Workers that run the chunks.
+	 * @param func Function to call.
+	 * @param chunkSize Number of pool slots per job.
+	 */
+	template <typename TFunc>
+	void ParallelEach(JobSystem& jobSystem, TFunc func, int chunkSize = JobSystem::DEFAULT_CHUNK_SIZE) const;
+	/**
+	 * @brief Gets a component of an entity visited by this view.
+	 *
+	 * @tparam TComponent One of the view's component types.
+	 * @param entity Entity to get the component from.
+	 * @return TComponent& Reference to the component.
+	 */
+	template <typename TComponent>
+	TComponent& Get(Entity entity) const {
+		return std::get<Pool<TComponent>*>(pools)->Get(entity.GetId());
+	}
+private:
+	/// Registry assigned to the entities handed out.
+	class Registry* registry;
+	/// Typed pools of each component type.
+	std::tuple<Pool<TComponents>*...> pools;
+};
+
+/**
+ * @brief Type-erased interface of an archetype, used by the registry to keep it packed.
+ */
+class IArchetype {
+public:
+	virtual ~IArchetype() = default;
+	/**
+	 * @brief Packs or unpacks an entity after its components change.
+	 * @param entityId Entity index.
+	 * @param entitySignature Signature the entity has after the change.
+	 */
+	virtual void Refresh(int entityId, const Signature& entitySignature) = 0;
+	/**
+	 * @brief Forgets every packed entity, used when the pools are destroyed.
+	 */
+	virtual void Clear() = 0;
+	/**
+	 * @brief Returns the components owned by the archetype.
+	 * @return const Signature& Component signature.
+	 */
+	const Signature& GetSignature() const { return signature; }
+protected:
+	/// Components owned by the archetype.
+	Signature signature;
+};
+
+/**
+ * @brief Archetype storage for entities that always own the same set of components.
+ *
+ * The archetype owns the pools of its component types and keeps every entity that has
+ * all of them packed at the front of each pool, in the same order. Those slots form one
+ * column per component (SoA), so Each walks them linearly with no lookups. The pools are
+ * still the regular Pool<T>, so GetComponent, views and system signatures are unaffected.
+ * A component type can only be owned by one archetype.
+ *
+ * @tparam TComponents Component types of the archetype.
+ */
+template <typename... TComponents>
+class Archetype : public IArchetype {
+public:
+	/**
+	 * @brief Constructs an empty archetype.
+	 * @param registry Registry owning the pools.
+	 */
+	Archetype(class Registry* registry);
+	void Refresh(int entityId, const Signature& entitySignature) override;
+	void Clear() override { size = 0; }
+	/**
+	 * @brief Calls func(Entity, TComponents&...) for every entity of the archetype.
+	 *
+	 * Killing entities is deferred and safe; removing one of the owned components while
+	 * iterating reorders the packed slots and may skip an entity until the next pass.
+	 *
+	 * @tparam TFunc Callable type.
+	 * @param func Function to call.
+	 */
+	template <typename TFunc>
+	void Each(TFunc func) const;
+	/**
+	 * @brief Gets the number of packed entities.
+	 * @return int Number of entities owning all the components.
+	 */
+	int GetSize() const { return size; }
+private:
+	/**
+	 * @brief Checks if an entity is in the packed slots.
+	 * @param entityId Entity index.
+	 * @return true If the entity is packed.
+	 */
+	bool IsPacked(int entityId) const;
+	/**
+	 * @brief Moves the component of an entity to a slot, swapping it with the one there.
+	 *
+	 * @tparam TComponent Component type.
+	 * @param entityId Entity index.
+	 * @param slot Destination slot.
+	 */
+	template <typename TComponent>
+	void MoveToSlot(int entityId, int slot) const;
+
+	/// Registry owning the pools.
+	class Registry* registry;
+	/// Number of packed entities; slots [0, size) of every pool belong to the archetype.
+	int size = 0;
+};
+
+/**
+ * @brief Entity created through a CommandBuffer; it exists once the buffer is flushed.
+ *
+ * Only valid with the buffer that created it, until its next flush.
+ */
+struct DeferredEntity {
+	/// Position of the entity among the ones created by the buffer since the last flush.
+	int index;
+};
+
+/**
+ * @brief Records structural changes and applies them later, in one batch, in Registry::Update.
+ *
+ * Creating entities or adding components while a system iterates can grow the pools and
+ * invalidate references the loop still holds. Recording them instead is always safe, also
+ * from worker threads. Commands are applied in the order they were recorded, and the ones
+ * targeting an entity that died in the meantime are dropped.
+ *
+ * Commands are stored in std::function, which must be copyable, so the constructor arguments
+ * given to AddComponent must be copyable too; move-only components cannot be recorded.
+ */
+class CommandBuffer {
+public:
+	/**
+	 * @brief Records the creation of an entity.
+	 * @return DeferredEntity Handle used to add components to the new entity.
+	 */
+	DeferredEntity CreateEntity();
+	/**
+	 * @brief Records adding a component to an existing entity.
+	 *
+	 * @tparam TComponent Component type.
+	 * @tparam TArgs Constructor argument types; must be copyable, they are stored until the flush.
+	 * @param entity Entity to add the component to.
+	 * @param args Arguments forwarded to the component constructor.
+	 */
+	template <typename TComponent, typename... TArgs>
+	void AddComponent(Entity entity, TArgs&&... args);
+	/**
+	 * @brief Records adding a component to an entity created by this buffer.
+	 *
+	 * @tparam TComponent Component type.
+	 * @tparam TArgs Constructor argument types; must be copyable, they are stored until the flush.
+	 * @param entity Entity to add the component to.
+	 * @param args Arguments forwarded to the component constructor.
+	 */
+	template <typename TComponent, typename... TArgs>
+	void AddComponent(DeferredEntity entity, TArgs&&... args);
+	/**
+	 * @brief Records removing a component from an entity.
+	 *
+	 * @tparam TComponent Component type.
+	 * @param entity Entity to remove the component from.
+	 */
+	template <typename TComponent>
+	void RemoveComponent(Entity entity);
+	/**
+	 * @brief Records killing an entity.
+	 * @param entity Entity to kill.
+	 */
+	void KillEntity(Entity entity);
+	/**
+	 * @brief Applies every recorded command to a registry and empties the buffer.
+	 *
+	 * Commands recorded while flushing are kept for the next flush.
+	 *
+	 * @param registry Registry to apply the commands to.
+	 */
+	void Flush(class Registry& registry);
+	/**
+	 * @brief Drops every recorded command.
+	 */
+	void Clear();
+
+private:
+	/// Entity a command applies to: an existing one, or one created by the buffer.
+	struct Target {
+		Entity entity;
+		int createdIndex = -1;
+	};
+	/// A recorded command; created holds the entities created so far in the flush.
+	typedef std::function<void(class Registry&, std::vector<Entity>& created)> Command;
+	/**
+	 * @brief Records adding a component to a target.
+	 *
+	 * @tparam TComponent Component type.
+	 * @tparam TArgs Constructor argument types.
+	 * @param target Entity to add the component to.
+	 * @param args Arguments moved into the command and kept until the flush.
+	 */
+	template <typename TComponent, typename... TArgs>
+	void RecordAddComponent(Target target, TArgs&&... args);
+	/**
+	 * @brief Resolves the entity of a target during a flush.
+	 *
+	 * @param registry Registry being flushed.
+	 * @param target The target.
+	 * @param created Entities created so far in the flush.
+	 * @return Entity The entity, or an invalid one if it is no longer alive.
+	 */
+	static Entity Resolve(class Registry& registry, const Target& target, const std::vector<Entity>& created);
+
+	/// Guards the commands, which may be recorded from several threads.
+	std::mutex mutex;
+	/// Commands in recording order.
+	std::vector<Command> commands;
+	/// Number of entities created since the last flush.
+	int createdCount = 0;
 };
 
 /**
@@ -175,21 +472,50 @@ public:
 	void Update();
 	/**
 	 * @brief Creates a new entity.
+	 *
+	 * At most ENTITY_INDEX_MASK entities can be alive at once, since the last index is the null
+	 * handle; creating one more aborts the program.
+	 *
 	 * @return Entity Newly created entity.
 	 */
 	Entity CreateEntity();
 	/**
 	 * @brief Marks an entity to be killed.
+	 *
+	 * Safe to call from parallel loops; Update destroys the marked entities in index
+	 * order, so the result does not depend on thread timing.
+	 *
 	 * @param entity Entity to kill.
 	 */
 	void KillEntity(Entity entity);
 	/**
-	 * @brief Checks if an entity is alive.
+	 * @brief Checks if an entity is alive: its version is current and it is not marked to be killed.
 	 * @param entity Entity to check.
 	 * @return true If the entity is alive.
 	 * @return false Otherwise.
 	 */
-	bool CheckIfEntityIsAlive(Entity entity);
+	bool CheckIfEntityIsAlive(Entity entity) const;
+	/**
+	 * @brief Gets when an entity was created relative to the others.
+	 *
+	 * The value grows with every created entity and is not reused with the index, so sorting by
+	 * it gives the creation order however the pools were reordered.
+	 *
+	 * @param entity A live entity.
+	 * @return std::uint64_t The creation order of the entity.
+	 */
+	std::uint64_t GetCreationOrder(Entity entity) const;
+	/**
+	 * @brief Gets the current entity at an index.
+	 * @param entityId Entity index.
+	 * @return Entity Handle with the current version of the index.
+	 */
+	Entity GetEntity(int entityId);
+	/**
+	 * @brief Gets the command buffer flushed at the start of every Update.
+	 * @return CommandBuffer& The command buffer.
+	 */
+	CommandBuffer& GetCommandBuffer();
 	/**
 	 * @brief Adds a component to an entity.
 	 *
@@ -227,6 +553,29 @@ public:
 	 */
 	template < typename TComponent, typename... TArgs >
 	TComponent& GetComponent(Entity entity) const;
+	/**
+	 * @brief Creates a view over the entities owning all the given components.
+	 *
+	 * @tparam TComponents Component types to iterate.
+	 * @return View<TComponents...> View reading the pools directly.
+	 */
+	template <typename... TComponents>
+	View<TComponents...> GetView();
+	/**
+	 * @brief Registers archetype storage for a component set, packing the entities that already own it.
+	 *
+	 * @tparam TComponents Component types; none of them may belong to another archetype.
+	 */
+	template <typename... TComponents>
+	void RegisterArchetype();
+	/**
+	 * @brief Gets a registered archetype.
+	 *
+	 * @tparam TComponents Component types, in the order used to register it.
+	 * @return Archetype<TComponents...>& The archetype.
+	 */
+	template <typename... TComponents>
+	Archetype<TComponents...>& GetArchetype() const;
 	/**
 	 * @brief Adds a system to the registry.
 	 *
@@ -276,22 +625,213 @@ public:
 	void ClearAllEntities();
 
 private:
+	template <typename... TComponents>
+	friend class Archetype;
+
+	/**
+	 * @brief Packs or unpacks an entity in every archetype.
+	 * @param entityId Entity index.
+	 * @param entitySignature Signature the entity has after the change.
+	 */
+	void RefreshArchetypes(int entityId, const Signature& entitySignature);
+	/**
+	 * @brief Gets the typed pool of a component type.
+	 *
+	 * @tparam TComponent Component type.
+	 * @return Pool<TComponent>* The pool, or nullptr if it was never created.
+	 */
+	template <typename TComponent>
+	Pool<TComponent>* GetComponentPool() const;
+
 	/// Number of active entities.
 	unsigned int numEntity = 0;
-	/// Pools of components, indexed by component ID.
-	std::vector<std::shared_ptr<IPool>> componentsPools;
+	/// Pools of components, indexed by component ID; owned only here and accessed through raw typed pointers.
+	std::vector<std::unique_ptr<IPool>> componentsPools;
 	/// Signatures of components for each entity.
 	std::vector<Signature> entityComponentSignatures;
 	/// Systems stored by their type.
 	std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
-	/// Entities queued to be added.
-	std::set<Entity> entitiesToBeAdded;
-	/// Entities queued to be killed.
-	std::set<Entity> entitiesToBeKilled;
+	/// Systems interested in each entity signature seen so far, reset when systems change.
+	std::unordered_map<Signature, std::vector<System*>> systemsBySignature;
+	/// Registered archetypes stored by their type.
+	std::unordered_map<std::type_index, std::unique_ptr<IArchetype>> archetypes;
+	/// Components owned by any archetype.
+	Signature archetypeComponents;
+	/// Entities queued to be added, in creation order.
+	std::vector<Entity> entitiesToBeAdded;
+	/// Entities queued to be killed; KillEntity only queues live entities, so there are no duplicates.
+	std::vector<Entity> entitiesToBeKilled;
+	/// Guards the kill queue against kills from parallel loops.
+	std::mutex killMutex;
+	/// Structural changes recorded to be applied at the next Update.
+	CommandBuffer commandBuffer;
 	/// Free entity IDs for reuse.
 	std::deque<int> freeIds;
+	/// Current version of each entity index, kept across ClearAllEntities.
+	std::vector<std::uint32_t> entityVersions;
+	/// Kill mark of an entity index; an atomic byte, since KillEntity sets it from parallel loops while
+	/// CheckIfEntityIsAlive reads it without the lock. Copying only lets CreateEntity grow the vector.
+	struct PendingKillFlag {
+		std::atomic<bool> marked{ false };
+		PendingKillFlag() = default;
+		PendingKillFlag(const PendingKillFlag& other) : marked(other.marked.load(std::memory_order_relaxed)) {}
+	};
+	/// Whether each entity index is marked to be killed.
+	std::vector<PendingKillFlag> entityPendingKill;
+	/// Creation order of the entity at each index.
+	std::vector<std::uint64_t> entityCreationOrder;
+	/// Creation order given to the next created entity.
+	std::uint64_t nextCreationOrder = 0;
 };
 
+template<typename TComponent, typename ...TArgs>
+void CommandBuffer::AddComponent(Entity entity, TArgs && ...args)
+{
+	Target target;
+	target.entity = entity;
+	RecordAddComponent<TComponent>(target, std::forward<TArgs>(args)...);
+}
+
+template<typename TComponent, typename ...TArgs>
+void CommandBuffer::AddComponent(DeferredEntity entity, TArgs && ...args)
+{
+	Target target;
+	target.createdIndex = entity.index;
+	RecordAddComponent<TComponent>(target, std::forward<TArgs>(args)...);
+}
+
+template<typename TComponent, typename ...TArgs>
+void CommandBuffer::RecordAddComponent(Target target, TArgs && ...args)
+{
+	auto arguments = std::make_tuple(std::forward<TArgs>(args)...);
+	static_assert(std::is_copy_constructible<decltype(arguments)>::value,
+		"CommandBuffer::AddComponent arguments must be copyable, since commands are stored in std::function");
+	std::lock_guard<std::mutex> lock(mutex);
+	commands.push_back([target, arguments = std::move(arguments)](Registry& registry, std::vector<Entity>& created) mutable {
+		const Entity entity = Resolve(registry, target, created);
+		if (!entity.registry) {
+			return;
+		}
+		std::apply([&](auto&... componentArgs) {
+			registry.AddComponent<TComponent>(entity, std::move(componentArgs)...);
+		}, arguments);
+	});
+}
+
+template<typename TComponent>
+void CommandBuffer::RemoveComponent(Entity entity)
+{
+	Target target;
+	target.entity = entity;
+	std::lock_guard<std::mutex> lock(mutex);
+	commands.push_back([target](Registry& registry, std::vector<Entity>& created) {
+		const Entity entity = Resolve(registry, target, created);
+		if (entity.registry) {
+			registry.RemoveComponent<TComponent>(entity);
+		}
+	});
+}
+
+template<typename ...TComponents>
+template<typename TFunc>
+void View<TComponents...>::Each(TFunc func) const
+{
+	if (!(std::get<Pool<TComponents>*>(pools) && ...)) {
+		return;
+	}
+	auto* leadPool = std::get<0>(pools);
+	const int size = leadPool->GetSize();
+	for (int i = 0; i < size; i++) {
+		const int entityId = leadPool->GetEntityId(i);
+		if (!(std::get<Pool<TComponents>*>(pools)->Has(entityId) && ...)) {
+			continue;
+		}
+		func(registry->GetEntity(entityId), std::get<Pool<TComponents>*>(pools)->Get(entityId)...);
+	}
+}
+
+template<typename ...TComponents>
+Archetype<TComponents...>::Archetype(Registry* registry)
+	: registry(registry)
+{
+	(signature.set(Component<TComponents>::GetId()), ...);
+}
+
+template<typename ...TComponents>
+void Archetype<TComponents...>::Refresh(int entityId, const Signature& entitySignature)
+{
+	const bool matches = (entitySignature & signature) == signature;
+	if (matches == IsPacked(entityId)) {
+		return;
+	}
+	if (matches) {
+		(MoveToSlot<TComponents>(entityId, size), ...);
+		size++;
+	}
+	else {
+		size--;
+		(MoveToSlot<TComponents>(entityId, size), ...);
+	}
+}
+
+template<typename ...TComponents>
+template<typename TFunc>
+void Archetype<TComponents...>::Each(TFunc func) const
+{
+	if (size == 0) {
+		return;
+	}
+	std::tuple<Pool<TComponents>*...> pools(registry->GetComponentPool<TComponents>()...);
+	auto* leadPool = std::get<0>(pools);
+	for (int i = 0; i < size; i++) {
+		func(registry->GetEntity(leadPool->GetEntityId(i)), std::get<Pool<TComponents>*>(pools)->GetData()[i]...);
+	}
+}
+
+template<typename ...TComponents>
+bool Archetype<TComponents...>::IsPacked(int entityId) const
+{
+	auto* leadPool = registry->GetComponentPool<std::tuple_element_t<0, std::tuple<TComponents...>>>();
+	return leadPool && leadPool->Has(entityId) && leadPool->GetIndex(entityId) < size;
+}
+
+template<typename ...TComponents>
+template<typename TComponent>
+void Archetype<TComponents...>::MoveToSlot(int entityId, int slot) const
+{
+	auto* pool = registry->GetComponentPool<TComponent>();
+	pool->SwapSlots(pool->GetIndex(entityId), slot);
+}
+
+template<typename ...TComponents>
+template<typename TFunc>
+void View<TComponents...>::ParallelEach(JobSystem& jobSystem, TFunc func, int chunkSize) const
+{
+	if (!(std::get<Pool<TComponents>*>(pools) && ...)) {
+		return;
+	}
+	auto* leadPool = std::get<0>(pools);
+	jobSystem.ParallelFor(leadPool->GetSize(), chunkSize, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			const int entityId = leadPool->GetEntityId(i);
+			if (!(std::get<Pool<TComponents>*>(pools)->Has(entityId) && ...)) {
+				continue;
+			}
+			func(registry->GetEntity(entityId), std::get<Pool<TComponents>*>(pools)->Get(entityId)...);
+		}
+	});
+}
+
+template<typename TFunc>
+void System::ParallelForEach(JobSystem& jobSystem, TFunc func, int chunkSize) const
+{
+	jobSystem.ParallelFor(static_cast<int>(entities.size()), chunkSize, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			func(entities[i]);
+		}
+	});
+}
+
 template<typename TComponent>
 void System::RequiredComponent()
 {
@@ -305,20 +845,17 @@ void Registry::AddComponent(Entity entity, TArgs && ...args)
 	const size_t componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
 	if (static_cast<long unsigned int>(componentId) >= componentsPools.size()) {
-		componentsPools.resize(componentId + 10, nullptr);
+		componentsPools.resize(componentId + 10);
 	}
 	if (!componentsPools[componentId]) {
-		std::shared_ptr<Pool<TComponent>> newComponentPool = std::make_shared<Pool<TComponent>>();
-		componentsPools[componentId] = newComponentPool;
-	}
-	std::shared_ptr<Pool<TComponent>> componentPool = 
-		std::static_pointer_cast<Pool<TComponent>>(componentsPools[componentId]);
-	if (entityId >= componentPool->GetSize()) {
-		componentPool->Resize(entityId + 100);
+		componentsPools[componentId] = std::make_unique<Pool<TComponent>>();
 	}
-	TComponent newComponent(std::forward<TArgs>(args)...);
-	componentPool->Set(entityId, newComponent);
+	Pool<TComponent>* componentPool = GetComponentPool<TComponent>();
+	componentPool->Emplace(entityId, std::forward<TArgs>(args)...);
 	entityComponentSignatures[entityId].set(componentId);
+	if (archetypeComponents.test(componentId)) {
+		RefreshArchetypes(entityId, entityComponentSignatures[entityId]);
+	}
 }
 
 template<typename TComponent, typename ...TArgs>
@@ -326,6 +863,12 @@ void Registry::RemoveComponent(Entity entity)
 {
 	const int componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
+	if (archetypeComponents.test(componentId)) {
+		RefreshArchetypes(entityId, Signature(entityComponentSignatures[entityId]).reset(componentId));
+	}
+	if (static_cast<size_t>(componentId) < componentsPools.size() && componentsPools[componentId]) {
+		componentsPools[componentId]->RemoveEntityFromPool(entityId);
+	}
 	entityComponentSignatures[entityId].set(componentId, false);
 }
 
@@ -334,7 +877,8 @@ bool Registry::HasComponent(Entity entity) const
 {
 	const int componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
-	if (entityId < 0 || entityId >= entityComponentSignatures.size()) {
+	if (entityId < 0 || static_cast<size_t>(entityId) >= entityVersions.size() ||
+		entityVersions[entityId] != entity.GetVersion()) {
 		return false;
 	}
 	return entityComponentSignatures[entityId].test(componentId);
@@ -343,17 +887,56 @@ bool Registry::HasComponent(Entity entity) const
 template<typename TComponent, typename ...TArgs>
 TComponent& Registry::GetComponent(Entity entity) const
 {
-	const int componentId = Component<TComponent>::GetId();
-	const int entityId = entity.GetId();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentsPools[componentId]);
-	return componentPool->Get(entityId);
+	assert(HasComponent<TComponent>(entity) && "GetComponent on an entity without the component");
+	return GetComponentPool<TComponent>()->Get(entity.GetId());
+}
+
+template<typename TComponent>
+Pool<TComponent>* Registry::GetComponentPool() const
+{
+	const size_t componentId = Component<TComponent>::GetId();
+	if (componentId >= componentsPools.size()) {
+		return nullptr;
+	}
+	return static_cast<Pool<TComponent>*>(componentsPools[componentId].get());
+}
+
+template<typename ...TComponents>
+View<TComponents...> Registry::GetView()
+{
+	return View<TComponents...>(this, GetComponentPool<TComponents>()...);
+}
+
+template<typename ...TComponents>
+void Registry::RegisterArchetype()
+{
+	const std::type_index key(typeid(Archetype<TComponents...>));
+	if (archetypes.find(key) != archetypes.end()) {
+		return;
+	}
+	auto archetype = std::make_unique<Archetype<TComponents...>>(this);
+	assert((archetype->GetSignature() & archetypeComponents).none() && "A component can only belong to one archetype");
+	archetypeComponents |= archetype->GetSignature();
+	for (unsigned int i = 0; i < numEntity; i++) {
+		archetype->Refresh(i, entityComponentSignatures[i]);
+	}
+	archetypes.emplace(key, std::move(archetype));
+}
+
+template<typename ...TComponents>
+Archetype<TComponents...>& Registry::GetArchetype() const
+{
+	auto archetype = archetypes.find(std::type_index(typeid(Archetype<TComponents...>)));
+	return *static_cast<Archetype<TComponents...>*>(archetype->second.get());
 }
 
 template<typename TSystem, typename ...TArgs>
 void Registry::AddSystem(TArgs && ...args)
 {
 	std::shared_ptr<TSystem> newSystem = std::make_shared<TSystem>(std::forward<TArgs>(args)...);
+	newSystem->registry = this;
 	systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem));
+	systemsBySignature.clear();
 }
 
 template<typename TSystem>
@@ -361,6 +944,7 @@ void Registry::RemoveSystem()
 {
 	auto system = systems.find(std::type_index(typeid(TSystem)));
 	systems.erase(system); 
+	systemsBySignature.clear();
 }
 
 template<typename TSystem>
@@ -373,7 +957,7 @@ template<typename TSystem>
 TSystem& Registry::GetSystem() const
 {
 	auto system = systems.find(std::type_index(typeid(TSystem)));
-	return *(std::static_pointer_cast<TSystem>(system->second));
+	return *static_cast<TSystem*>(system->second.get());
 }
 
 template<typename TComponent, typename ...TArgs>
@@ -391,7 +975,7 @@ void Entity::RemoveComponent()
 template<typename TComponent, typename ...TArgs>
 bool Entity::HasComponent() const
 {
-	return registry->HasComponent<TComponent>(*this);
+	return registry && registry->HasComponent<TComponent>(*this);
 }
 
 template<typename TComponent, typename ...TArgs>
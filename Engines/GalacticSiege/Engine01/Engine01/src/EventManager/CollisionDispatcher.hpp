@@ -0,0 +1,112 @@
+#ifndef COLLISIONDISPATCHER_HPP
+#define COLLISIONDISPATCHER_HPP
+
+#include <utility>
+#include <vector>
+
+#include "EventManager.hpp"
+#include "../Events/CollisionEvent.hpp"
+
+/// Number of collision layers, one per bit of a collider layer mask.
+const int COLLISION_LAYER_COUNT = 32;
+
+/**
+ * @class CollisionDispatcher
+ * @brief Routes collisions to the handlers registered for the layers of both colliders.
+ *
+ * Handlers subscribe for a pair of layer masks and only receive collisions between a collider on
+ * the first mask and one on the second, with the entities ordered to match. The handlers of every
+ * pair of layers are precomputed in a table, so dispatching a collision is a single lookup.
+ *
+ * Subscriptions are kept until Reset is called, so systems subscribe once at setup.
+ */
+class CollisionDispatcher {
+public:
+	/**
+	 * @brief Subscribes a method to the collisions between two groups of layers.
+	 *
+	 * @tparam TOwner The type of the object subscribing.
+	 * @param layersA Layers of the entity passed as CollisionEvent::a.
+	 * @param layersB Layers of the entity passed as CollisionEvent::b.
+	 * @param ownerInstance Pointer to the subscriber instance.
+	 * @param callbackFunction Pointer to the subscriber's callback method.
+	 */
+	template <typename TOwner>
+	void Subscribe(unsigned int layersA, unsigned int layersB, TOwner* ownerInstance,
+		void (TOwner::*callbackFunction)(CollisionEvent&)) {
+		const int handler = static_cast<int>(handlers.size());
+		handlers.push_back(EventDelegate(ownerInstance, callbackFunction));
+		for (int i = 0; i < COLLISION_LAYER_COUNT; ++i) {
+			for (int j = 0; j < COLLISION_LAYER_COUNT; ++j) {
+				if ((layersA & (1u << i)) && (layersB & (1u << j))) {
+					table[i][j].push_back({ handler, false });
+				}
+				else if ((layersA & (1u << j)) && (layersB & (1u << i))) {
+					table[i][j].push_back({ handler, true });
+				}
+			}
+		}
+	}
+	/**
+	 * @brief Calls the handlers registered for the layers of two colliding entities.
+	 *
+	 * A collider with several layer bits is dispatched as its lowest layer.
+	 *
+	 * @param a The first colliding entity.
+	 * @param aLayer Layer bits of the first collider.
+	 * @param b The second colliding entity.
+	 * @param bLayer Layer bits of the second collider.
+	 * @param timeOfImpact Fraction of the frame at which the collision happened.
+	 */
+	void Dispatch(Entity a, unsigned int aLayer, Entity b, unsigned int bLayer, float timeOfImpact = 1.0f) {
+		if (aLayer == 0 || bLayer == 0) {
+			return;
+		}
+		for (const Route& route : table[LowestLayer(aLayer)][LowestLayer(bLayer)]) {
+			CollisionEvent event = route.swap ? CollisionEvent(b, a, timeOfImpact) : CollisionEvent(a, b, timeOfImpact);
+			handlers[route.handler].Execute(event);
+		}
+	}
+	/**
+	 * @brief Checks if any handler is registered for the layers of two colliders.
+	 *
+	 * @param aLayer Layer bits of the first collider.
+	 * @param bLayer Layer bits of the second collider.
+	 * @return True if Dispatch would call at least one handler.
+	 */
+	bool HasHandlers(unsigned int aLayer, unsigned int bLayer) const {
+		return aLayer != 0 && bLayer != 0 && !table[LowestLayer(aLayer)][LowestLayer(bLayer)].empty();
+	}
+	/**
+	 * @brief Removes every subscription.
+	 */
+	void Reset() {
+		handlers.clear();
+		for (auto& row : table) {
+			for (auto& routes : row) {
+				routes.clear();
+			}
+		}
+	}
+private:
+	/// Handler to call for a pair of layers and whether the entities are passed swapped.
+	struct Route {
+		int handler;
+		bool swap;
+	};
+	/// Registered handlers, in subscription order.
+	std::vector<EventDelegate> handlers;
+	/// Routes for each pair of layer indices.
+	std::vector<Route> table[COLLISION_LAYER_COUNT][COLLISION_LAYER_COUNT];
+
+	static int LowestLayer(unsigned int layer) {
+		int index = 0;
+		while (!(layer & 1u)) {
+			layer >>= 1;
+			++index;
+		}
+		return index;
+	}
+};
+
+#endif // !COLLISIONDISPATCHER_HPP
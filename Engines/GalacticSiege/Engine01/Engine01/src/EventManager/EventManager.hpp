@@ -1,79 +1,83 @@
 #ifndef EVENTMANAGER_HPP
 #define EVENTMANAGER_HPP
 
-#include <functional>
-#include <list>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <typeindex>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "Event.hpp"
+#include "EventChannel.hpp"
 
 /**
- * @class IEventCallback
- * @brief Base interface for all event callbacks.
+ * @class EventDelegate
+ * @brief Callback to a member function, stored by value.
  *
- * Provides a polymorphic interface to execute event callback functions.
+ * Holds the owner instance, a copy of the member function pointer in a small inline buffer and a
+ * trampoline instantiated for the owner and event types that calls it. Calling a delegate is one
+ * indirect call with no virtual dispatch, and building one allocates nothing, so handlers are
+ * kept by value in contiguous arrays.
  */
-class IEventCallback {
+class EventDelegate {
 public:
-	virtual ~IEventCallback() = default;
 	/**
-	 * @brief Executes the callback using the provided event.
-	 * @param e Reference to the event.
+	 * @brief Constructs the delegate.
+	 *
+	 * @tparam TOwner The class type of the callback owner.
+	 * @tparam TEvent The specific event type the callback handles.
+	 * @param ownerInstance Pointer to the owner of the callback.
+	 * @param callbackFunction Member function to be called when the event is emitted.
 	 */
-	void Execute(Event& e) {
-		Call(e);
+	template <typename TOwner, typename TEvent>
+	EventDelegate(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
+		static_assert(sizeof(callbackFunction) <= FUNCTION_SIZE, "member function pointer does not fit the delegate");
+		this->ownerInstance = ownerInstance;
+		std::memcpy(function, &callbackFunction, sizeof(callbackFunction));
+		trampoline = &Call<TOwner, TEvent>;
 	}
-private:
 	/**
-	 * @brief Internal method to invoke the callback.
-	 * @param e Reference to the event.
+	 * @brief Executes the callback using the provided event.
+	 * @param e Reference to the event, of the type the delegate was built for.
 	 */
-	virtual void Call(Event& e) = 0;
-};
-
-/**
- * @class EventCallback
- * @brief Concrete implementation of IEventCallback for member function callbacks.
- *
- * Stores a pointer to an owner instance and its member function to be executed
- * when the associated event is emitted.
- *
- * @tparam TOwner The class type of the callback owner.
- * @tparam TEvent The specific event type this callback handles.
- */
-template <typename TOwner, typename TEvent>
-class EventCallback : public IEventCallback {
+	void Execute(Event& e) const {
+		trampoline(ownerInstance, function, e);
+	}
 private:
-	typedef void (TOwner::*CallbackFunction)(TEvent&);
+	/// Bytes kept for the member function pointer, which takes up to three words with MSVC.
+	static constexpr size_t FUNCTION_SIZE = 4 * sizeof(void*);
+	typedef void (*Trampoline)(void* ownerInstance, const unsigned char* function, Event& e);
 
-	TOwner* ownerInstance;                ///< Pointer to the callback owner instance.
-	CallbackFunction callbackFunction;    ///< Pointer to the owner's member function.
-	/**
-	 * @brief Invokes the owner's callback function using the given event.
-	 * @param e Reference to the base Event, cast to TEvent.
-	 */
-	virtual void Call(Event& e) override {
-		std::invoke(callbackFunction, ownerInstance, static_cast<TEvent&>(e));
-	}
+	void* ownerInstance;                                   ///< Pointer to the callback owner instance.
+	Trampoline trampoline;                                 ///< Calls the member function for its types.
+	alignas(void*) unsigned char function[FUNCTION_SIZE]; ///< Copy of the member function pointer.
 
-public:
-	/**
-	 * @brief Constructs the callback.
-	 * @param ownerInstance Pointer to the owner of the callback.
-	 * @param callbackFunction Member function to be called when the event is emitted.
-	 */
-	EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction) {
-		this->callbackFunction = callbackFunction;
-		this->ownerInstance = ownerInstance;
+	/// Casts the owner and the event back to their types and calls the member function.
+	template <typename TOwner, typename TEvent>
+	static void Call(void* ownerInstance, const unsigned char* function, Event& e) {
+		void (TOwner::*callbackFunction)(TEvent&);
+		std::memcpy(&callbackFunction, function, sizeof(callbackFunction));
+		(static_cast<TOwner*>(ownerInstance)->*callbackFunction)(static_cast<TEvent&>(e));
 	}
 };
 /**
- * @brief List of unique pointers to event callback handlers.
+ * @brief How long a subscription lasts if it is not removed with Unsubscribe.
  */
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+enum class SubscriptionScope {
+	Game, ///< Kept until the game ends, for systems that subscribe once at setup.
+	Scene ///< Removed by ClearSceneSubscriptions when the scene changes.
+};
+/**
+ * @brief Handle returned when subscribing, used to unsubscribe.
+ */
+struct EventSubscription {
+	std::type_index type = typeid(void); ///< Event type of the subscription.
+	unsigned int id = 0;                 ///< Id of the handler, 0 if not subscribed.
+};
 
 /**
  * @class EventManager
@@ -81,6 +85,18 @@ typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
  *
  * Allows game systems or objects to subscribe to specific event types and
  * be notified when those events are emitted.
+ *
+ * Subscriptions persist across frames and are removed with the handle returned when subscribing,
+ * or all together when the scene changes for the ones made with SubscriptionScope::Scene.
+ * Handlers removed while an event is being emitted are not called again and are freed once the
+ * emission ends.
+ *
+ * Events can also be queued with QueueEvent and delivered later by DispatchEvents. They are stored
+ * by value in one vector per event type, found through a slot given to the type the first time it
+ * is queued, so queueing a burst of events is a few appends with no map lookup or handler call.
+ *
+ * The EventManager is not thread safe. Worker threads post events through the lock-free channels
+ * opened with OpenChannel, whose events are moved to the queues by DispatchEvents.
  */
 class EventManager {
 public:
@@ -100,7 +116,17 @@ public:
 	 * @brief Clears all event subscribers.
 	 */
 	void Reset() {
-		subscribers.clear();
+		for (auto& entry : subscribers) {
+			RemoveIf(entry.second, [](const Handler&) { return true; });
+		}
+	}
+	/**
+	 * @brief Removes the subscriptions made with SubscriptionScope::Scene.
+	 */
+	void ClearSceneSubscriptions() {
+		for (auto& entry : subscribers) {
+			RemoveIf(entry.second, [](const Handler& handler) { return handler.scope == SubscriptionScope::Scene; });
+		}
 	}
 	/**
 	 * @brief Subscribes a method of an object to a specific event type.
@@ -109,39 +135,256 @@ public:
 	 * @tparam TOwner The type of the object subscribing to the event.
 	 * @param ownerInstance Pointer to the subscriber instance.
 	 * @param callbackFunction Pointer to the subscriber's callback method.
+	 * @param scope Whether the subscription lasts for the game or only for the current scene.
+	 * @return EventSubscription Handle that can be passed to Unsubscribe.
 	 */
 	template <typename TEvent, typename TOwner>
-	void SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
-		if (!subscribers[typeid(TEvent)].get()) {
-			subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
+	EventSubscription SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&),
+		SubscriptionScope scope = SubscriptionScope::Game) {
+		EventSubscription subscription;
+		subscription.type = typeid(TEvent);
+		subscription.id = ++lastId;
+		subscribers[subscription.type].handlers.push_back({ EventDelegate(ownerInstance, callbackFunction), subscription.id, scope });
+		return subscription;
+	}
+	/**
+	 * @brief Removes a subscription, if it was not removed already.
+	 *
+	 * @param subscription Handle returned by SubscribeToEvent; it is cleared.
+	 */
+	void Unsubscribe(EventSubscription& subscription) {
+		auto found = subscribers.find(subscription.type);
+		if (subscription.id != 0 && found != subscribers.end()) {
+			const unsigned int id = subscription.id;
+			RemoveIf(found->second, [id](const Handler& handler) { return handler.id == id; });
 		}
-		auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
-		subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
+		subscription.id = 0;
 	}
 	/**
 	 * @brief Emits an event of type TEvent and notifies all subscribers.
 	 *
+	 * The event is built once and every handler gets the same object, as with DispatchEvents.
+	 * Handlers subscribed while the event is emitted are not called for it.
+	 *
 	 * @tparam TEvent The type of the event being emitted.
 	 * @tparam TArgs Variadic arguments used to construct the event.
-	 * @param args Arguments forwarded to the TEvent constructor.
+	 * @param args Arguments forwarded to the constructor of the TEvent.
 	 */
 	template <typename TEvent, typename... TArgs>
 	void EmitEvent(TArgs&&... args) {
-		auto handlers = subscribers[typeid(TEvent)].get();
-		if (handlers) {
-			for (auto it = handlers->begin(); it != handlers->end(); it++) {
-				auto handler = it->get();
-				TEvent event(std::forward<TArgs>(args)...);
-				handler->Execute(event);
+		auto found = subscribers.find(typeid(TEvent));
+		if (found == subscribers.end()) {
+			return;
+		}
+		HandlerList& list = found->second;
+		TEvent event(std::forward<TArgs>(args)...);
+		list.emitting++;
+		const size_t count = list.handlers.size();
+		for (size_t i = 0; i < count; i++) {
+			// Handlers may subscribe while running, so the vector is indexed again each time.
+			if (!list.handlers[i].removed) {
+				list.handlers[i].callback.Execute(event);
+			}
+		}
+		list.emitting--;
+		if (list.emitting == 0 && list.hasRemoved) {
+			Compact(list);
+		}
+	}
+	/**
+	 * @brief Queues an event of type TEvent to be delivered by the next DispatchEvents.
+	 *
+	 * The event is built once and stored, so its arguments must still be valid when it is
+	 * dispatched. Events must be queued from one thread at a time.
+	 *
+	 * @tparam TEvent The type of the event being queued.
+	 * @tparam TArgs Variadic arguments used to construct the event.
+	 * @param args Arguments used to construct the TEvent.
+	 */
+	template <typename TEvent, typename... TArgs>
+	void QueueEvent(TArgs&&... args) {
+		GetQueue<TEvent>().pending.emplace_back(std::forward<TArgs>(args)...);
+	}
+	/**
+	 * @brief Opens the channel through which other threads post events of type TEvent.
+	 *
+	 * Must be called from the main thread before the producers start. If the channel of the type
+	 * is already open it is returned as is.
+	 *
+	 * @tparam TEvent The type of the events carried by the channel.
+	 * @param capacity Minimum number of events held between two calls to DispatchEvents; events
+	 * posted beyond it are dropped and counted in the stats of the channel.
+	 * @return EventChannel<TEvent>& The channel, which lives as long as the EventManager.
+	 */
+	template <typename TEvent>
+	EventChannel<TEvent>& OpenChannel(size_t capacity) {
+		EventQueue<TEvent>& queue = GetQueue<TEvent>();
+		if (!queue.channel) {
+			queue.channel = std::make_unique<EventChannel<TEvent>>(capacity);
+		}
+		return *queue.channel;
+	}
+	/**
+	 * @brief Delivers the events queued since the last call.
+	 *
+	 * The events posted to the channels are moved to the queues first. Event types are delivered one after another. Within a type, each handler gets every event in
+	 * the order they were queued before the next handler runs, so all handlers see the same event
+	 * object. Events queued by the handlers are delivered later in the same call if their type was
+	 * not delivered yet, including a type queued for the first time, and by the next call otherwise.
+	 * Both buffers of each type are swapped and kept, so their storage is reused every frame. Calls
+	 * made from inside a handler do nothing.
+	 */
+	void DispatchEvents() {
+		if (dispatching) {
+			return;
+		}
+		dispatching = true;
+		for (auto& queue : queues) {
+			if (queue) {
+				queue->Receive();
+			}
+		}
+		// Handlers may queue a new event type, which grows the queues, so they are indexed again each time.
+		for (size_t i = 0; i < queues.size(); i++) {
+			if (queues[i]) {
+				queues[i]->Dispatch();
+			}
+		}
+		dispatching = false;
+	}
+	/**
+	 * @brief Drops the queued events that were not dispatched yet, including the ones in the channels.
+	 */
+	void ClearQueuedEvents() {
+		for (auto& queue : queues) {
+			if (queue) {
+				queue->Clear();
 			}
 		}
 	}
 private:
+	/// A subscribed callback.
+	struct Handler {
+		EventDelegate callback;
+		unsigned int id;
+		SubscriptionScope scope;
+		bool removed = false; ///< Unsubscribed while its list was being emitted.
+	};
+	/// Handlers of one event type, in subscription order.
+	struct HandlerList {
+		std::vector<Handler> handlers;
+		int emitting = 0;        ///< Number of emissions of this type running.
+		bool hasRemoved = false; ///< Whether some handler waits to be freed.
+	};
 	/**
 	 * @brief Map of event type to its list of subscribed handlers.
+	 *
+	 * Lists are kept when they become empty, so subscribing again does not rebuild the map.
 	 */
-	std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+	std::map<std::type_index, HandlerList> subscribers;
+	/// Id of the last subscription made.
+	unsigned int lastId = 0;
+
+	/// Base interface of the queues of events of one type.
+	class IEventQueue {
+	public:
+		virtual ~IEventQueue() = default;
+		/// Moves the events posted to the channel of the type to the pending ones.
+		virtual void Receive() = 0;
+		/// Delivers the pending events to the handlers of the type.
+		virtual void Dispatch() = 0;
+		/// Drops the pending events.
+		virtual void Clear() = 0;
+	};
+	/// Events of one type waiting for DispatchEvents.
+	template <typename TEvent>
+	class EventQueue : public IEventQueue {
+	public:
+		std::vector<TEvent> pending;                   ///< Events queued since the last dispatch.
+		std::unique_ptr<EventChannel<TEvent>> channel; ///< Channel of the type, if it was opened.
+
+		explicit EventQueue(HandlerList& list) : list(list) {}
+		virtual void Receive() override {
+			if (channel) {
+				channel->Receive([this](TEvent& event) { pending.push_back(std::move(event)); });
+			}
+		}
+		virtual void Dispatch() override {
+			if (pending.empty()) {
+				return;
+			}
+			// Events queued by the handlers are appended to the other buffer.
+			std::swap(pending, delivering);
+			list.emitting++;
+			const size_t count = list.handlers.size();
+			for (size_t i = 0; i < count; i++) {
+				for (size_t j = 0; j < delivering.size() && !list.handlers[i].removed; j++) {
+					list.handlers[i].callback.Execute(delivering[j]);
+				}
+			}
+			list.emitting--;
+			if (list.emitting == 0 && list.hasRemoved) {
+				Compact(list);
+			}
+			delivering.clear();
+		}
+		virtual void Clear() override {
+			pending.clear();
+			if (channel) {
+				channel->Receive([](TEvent&) {});
+			}
+		}
+	private:
+		HandlerList& list;
+		std::vector<TEvent> delivering;
+	};
+	/// Queues of events indexed by the slot of their type.
+	std::vector<std::unique_ptr<IEventQueue>> queues;
+	/// Whether DispatchEvents is running.
+	bool dispatching = false;
 
+	/// Gets the queue of an event type, creating it the first time.
+	template <typename TEvent>
+	EventQueue<TEvent>& GetQueue() {
+		const size_t slot = GetEventSlot<TEvent>();
+		if (slot >= queues.size()) {
+			queues.resize(slot + 1);
+		}
+		if (!queues[slot]) {
+			// Lists are never erased from the map, so the queue can keep a reference to its own.
+			queues[slot] = std::make_unique<EventQueue<TEvent>>(subscribers[typeid(TEvent)]);
+		}
+		return static_cast<EventQueue<TEvent>&>(*queues[slot]);
+	}
+	/// Gets the slot of an event type in the queues, given in order of first use like component ids.
+	template <typename TEvent>
+	static size_t GetEventSlot() {
+		static size_t slot = NextEventSlot()++;
+		return slot;
+	}
+	static size_t& NextEventSlot() {
+		static size_t next = 0;
+		return next;
+	}
+
+	/// Removes the handlers that match a condition, or only marks them while the list is emitted.
+	template <typename TFunc>
+	static void RemoveIf(HandlerList& list, TFunc&& condition) {
+		for (Handler& handler : list.handlers) {
+			if (!handler.removed && condition(handler)) {
+				handler.removed = true;
+				list.hasRemoved = true;
+			}
+		}
+		if (list.emitting == 0 && list.hasRemoved) {
+			Compact(list);
+		}
+	}
+	static void Compact(HandlerList& list) {
+		list.handlers.erase(std::remove_if(list.handlers.begin(), list.handlers.end(),
+			[](const Handler& handler) { return handler.removed; }), list.handlers.end());
+		list.hasRemoved = false;
+	}
 };
 
 #endif // !EVENTMANAGER_HPP
\ No newline at end of file
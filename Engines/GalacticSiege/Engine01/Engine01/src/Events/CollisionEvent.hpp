@@ -9,7 +9,8 @@
  * @brief Event triggered when two entities collide.
  *
  * This event is dispatched when a collision is detected between two entities
- * within the ECS framework. It provides references to both entities involved.
+ * within the ECS framework. It provides references to both entities involved
+ * and the moment of the frame when they started touching.
  */
 class CollisionEvent : public Event {
 public:
@@ -23,13 +24,22 @@ public:
      */
     Entity b;
 
+    /**
+     * @brief Fraction of the frame's movement at which the colliders first touched.
+     *
+     * 0 if they were already touching at the start of the frame. Collisions between bodies
+     * that are not fast are only tested at the end of the frame and report 1.
+     */
+    float timeOfImpact;
+
     /**
      * @brief Constructs a CollisionEvent with two colliding entities.
      *
      * @param a The first entity involved in the collision.
      * @param b The second entity involved in the collision.
+     * @param timeOfImpact Fraction of the frame at which the collision happened.
      */
-    CollisionEvent(Entity a, Entity b) : a(a), b(b) {}
+    CollisionEvent(Entity a, Entity b, float timeOfImpact = 1.0f) : a(a), b(b), timeOfImpact(timeOfImpact) {}
 };
 
 #endif // !COLLISIONEVENT_HPP
@@ -4,6 +4,12 @@
 
 #include "../Events/ClickEvent.hpp"
 
+#include "../Components/CircleColliderComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
+#include "../Components/SpriteComponent.hpp"
+#include "../Components/TransformComponent.hpp"
+#include "../Components/EntityTypeComponent.hpp"
+
 #include "../Systems/RenderSystem.hpp"
 #include "../Systems/MovementSystem.hpp"
 #include "../Systems/CollisionSystem.hpp"
@@ -27,8 +33,10 @@ Game::Game()
 	this->registry = std::make_unique<Registry>();
 	assetManager = std::make_unique<AssetManager>();
 	eventManager = std::make_unique<EventManager>();
+	collisionDispatcher = std::make_unique<CollisionDispatcher>();
 	controllerManager = std::make_unique<ControllerManager>();
 	sceneManager = std::make_unique<SceneManager>();
+	jobSystem = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount());
 }
 
 Game& Game::GetInstance()
@@ -89,6 +97,27 @@ void Game::Setup()
 	registry->AddSystem<GameManagerSystem>();
 	registry->AddSystem<IsEntityInsideTheScreenSystem>();
 
+	// Bullets are created in bulk with these components; keep them packed. Sprites stay
+	// out so packing never reorders the sprite pool under the background and the HUD
+	registry->RegisterArchetype<CircleColliderComponent, RigidBodyComponent,
+		TransformComponent, EntityTypeComponent>();
+
+	// Subscriptions persist across frames and scenes
+	registry->GetSystem<DamageSystem>().SubscribeToCollisions(collisionDispatcher);
+	registry->GetSystem<UISystem>().SubscribeToClickEvent(eventManager);
+
+	// Layer bits for the circle_collider layer and mask fields of the scene scripts
+	lua["collision_layer"] = lua.create_table_with(
+		"default", LAYER_DEFAULT,
+		"player", LAYER_PLAYER,
+		"player_bullet", LAYER_PLAYER_BULLET,
+		"enemy", LAYER_ENEMY,
+		"enemy_bullet", LAYER_ENEMY_BULLET,
+		"boss_bullet", LAYER_BOSS_BULLET,
+		"power_up", LAYER_POWER_UP,
+		"all", LAYER_ALL
+	);
+
 	sceneManager->LoadSceneFromScript("./assets/scripts/scenes.lua", lua);
 
 	lua.open_libraries(sol::lib::base, sol::lib::math);
@@ -150,16 +179,15 @@ void Game::Update()
 	}
 	double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
 	millisecsPreviousFrame = SDL_GetTicks();
-	eventManager->Reset();
-	registry->GetSystem<UISystem>().SubscribeToClickEvent(eventManager);
-	registry->GetSystem<DamageSystem>().SubscribeToCollisionEvent(eventManager);
 	registry->Update();
 	registry->GetSystem<GameManagerSystem>().Update(deltaTime, sceneManager->GetCurrentSceneType(), lua);
 	registry->GetSystem<ScriptSystem>().Update(lua, deltaTime, window_height, window_width);
-	registry->GetSystem<MovementSystem>().Update(deltaTime, window_height, window_width, registry->GetSystem<GameManagerSystem>().GetPlayer());
-	registry->GetSystem<IsEntityInsideTheScreenSystem>().Update(window_width, window_height);
-	registry->GetSystem<CollisionSystem>().Update(eventManager);
-	registry->GetSystem<AnimationSystem>().Update();
+	registry->GetSystem<MovementSystem>().Update(deltaTime, window_height, window_width, registry->GetSystem<GameManagerSystem>().GetPlayer(), *jobSystem);
+	registry->GetSystem<IsEntityInsideTheScreenSystem>().Update(window_width, window_height, *jobSystem);
+	registry->GetSystem<CollisionSystem>().Update(eventManager, collisionDispatcher, *jobSystem);
+	registry->GetSystem<AnimationSystem>().Update(*jobSystem);
+	// Events queued by the systems, such as collisions, and the ones posted from other threads are delivered once they are all done.
+	eventManager->DispatchEvents();
 }
 
 void Game::Render()
@@ -182,6 +210,8 @@ void Game::RunScene()
 		}
 		Render();
 	}
+	eventManager->ClearQueuedEvents();
+	eventManager->ClearSceneSubscriptions();
 	assetManager->ClearAssets();
 	registry->ClearAllEntities();
 }
@@ -212,6 +242,7 @@ Game::~Game()
 	this->renderer = nullptr;
 	this->registry.reset();
 	this->eventManager.reset();
+	this->collisionDispatcher.reset();
 	this->assetManager.reset();
 	this->controllerManager.reset();
 	this->sceneManager.reset();
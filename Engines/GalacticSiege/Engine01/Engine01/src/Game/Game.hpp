@@ -13,8 +13,10 @@
 #include "../ECS/ECS.hpp"
 #include "../AssetManager/AssetManager.hpp"
 #include "../EventManager/EventManager.hpp"
+#include "../EventManager/CollisionDispatcher.hpp"
 #include "../ControllerManager/ControllerManager.hpp"
 #include "../SceneManager/SceneManager.hpp"
+#include "../JobSystem/JobSystem.hpp"
 
 /**
  * @brief The target frames per second for the game loop.
@@ -104,9 +106,11 @@ public:
     sol::state lua;                            ///< The Lua state for scripting.
     std::unique_ptr<AssetManager> assetManager; ///< Manages game assets like textures and sounds.
     std::unique_ptr<EventManager> eventManager; ///< Manages game events and notifications.
+    std::unique_ptr<CollisionDispatcher> collisionDispatcher; ///< Routes collisions to handlers by collision layer.
     std::unique_ptr<ControllerManager> controllerManager; ///< Manages user input and controls.
     std::unique_ptr<Registry> registry;        ///< The ECS Registry for managing entities and components.
     std::unique_ptr<SceneManager> sceneManager; ///< Manages game scenes and transitions.
+    std::unique_ptr<JobSystem> jobSystem;       ///< Worker threads for the parallel system loops.
 
     /**
      * @brief Gets the singleton instance of the Game class.
@@ -0,0 +1,123 @@
+#include "JobSystem.hpp"
+
+#include <iostream>
+
+namespace {
+	// Job system and worker index of the calling thread, if it is a worker
+	thread_local const JobSystem* currentJobSystem = nullptr;
+	thread_local int currentWorkerIndex = -1;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	std::cout << "[JobSystem] Se ejecuta constructor con " << workerCount << " hilos" << std::endl;
+	for (unsigned int i = 0; i <= workerCount; i++) {
+		queues.push_back(std::make_unique<JobQueue>());
+	}
+	workers.reserve(workerCount);
+	for (unsigned int i = 0; i < workerCount; i++) {
+		workers.emplace_back(&JobSystem::WorkerLoop, this, static_cast<int>(i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	condition.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	std::cout << "[JobSystem] Se ejecuta destructor" << std::endl;
+}
+
+void JobSystem::Submit(std::function<void()> job)
+{
+	if (workers.empty()) {
+		job();
+		return;
+	}
+	const int workerIndex = CurrentWorker();
+	JobQueue& queue = workerIndex >= 0 ? *queues[workerIndex] : *queues.back();
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		queuedJobs++;
+	}
+	condition.notify_one();
+}
+
+unsigned int JobSystem::GetWorkerCount() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+unsigned int JobSystem::DefaultWorkerCount()
+{
+	const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+int JobSystem::CurrentWorker() const
+{
+	return currentJobSystem == this ? currentWorkerIndex : -1;
+}
+
+bool JobSystem::TryRunJob(int workerIndex)
+{
+	std::function<void()> job;
+	if (workerIndex >= 0) {
+		JobQueue& own = *queues[workerIndex];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+		}
+	}
+	const int queueCount = static_cast<int>(queues.size());
+	for (int i = 1; !job && i <= queueCount; i++) {
+		JobQueue& victim = *queues[(workerIndex + i + queueCount) % queueCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+		}
+	}
+	if (!job) {
+		return false;
+	}
+	queuedJobs--;
+	job();
+	return true;
+}
+
+void JobSystem::WaitFor(const std::atomic<int>& remaining)
+{
+	const int workerIndex = CurrentWorker();
+	while (remaining.load(std::memory_order_acquire) > 0) {
+		if (!TryRunJob(workerIndex)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WorkerLoop(int workerIndex)
+{
+	currentJobSystem = this;
+	currentWorkerIndex = workerIndex;
+	while (true) {
+		if (TryRunJob(workerIndex)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		condition.wait(lock, [this] { return stopping || queuedJobs > 0; });
+		if (stopping && queuedJobs == 0) {
+			return;
+		}
+	}
+}
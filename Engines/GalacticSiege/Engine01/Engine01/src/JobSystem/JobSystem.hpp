@@ -0,0 +1,131 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing pool of worker threads.
+ *
+ * Every worker owns a queue that it drains newest first; jobs submitted from other
+ * threads go to a shared queue. Idle workers steal the oldest job of another queue.
+ * With no workers, jobs run inline on the calling thread.
+ */
+class JobSystem {
+public:
+	/// Default number of items per chunk in ParallelFor.
+	static constexpr int DEFAULT_CHUNK_SIZE = 512;
+	/**
+	 * @brief Starts the worker threads.
+	 * @param workerCount Number of workers; 0 runs every job inline.
+	 */
+	explicit JobSystem(unsigned int workerCount);
+	/**
+	 * @brief Finishes the queued jobs and joins the workers.
+	 */
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+	/**
+	 * @brief Queues a job to run on a worker.
+	 * @param job Callable to run.
+	 */
+	void Submit(std::function<void()> job);
+	/**
+	 * @brief Runs func(begin, end) over [0, count) in chunks and waits for all of them.
+	 *
+	 * The calling thread runs the first chunk and then helps with queued jobs, so it
+	 * may be called from inside a job. Chunks must not depend on each other.
+	 *
+	 * @tparam TFunc Callable as func(int begin, int end).
+	 * @param count Number of items.
+	 * @param chunkSize Number of items per job.
+	 * @param func Function to call for each chunk.
+	 */
+	template <typename TFunc>
+	void ParallelFor(int count, int chunkSize, TFunc func);
+	/**
+	 * @brief Gets the number of worker threads.
+	 * @return unsigned int Number of workers, 0 if jobs run inline.
+	 */
+	unsigned int GetWorkerCount() const;
+	/**
+	 * @brief Picks a worker count that leaves one core for the main thread.
+	 * @return unsigned int Hardware threads minus one, or 0 if unknown.
+	 */
+	static unsigned int DefaultWorkerCount();
+
+private:
+	/// Queue of jobs that other threads may steal from.
+	struct JobQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> jobs;
+	};
+	/**
+	 * @brief Gets the index of the calling worker.
+	 * @return int Worker index, or -1 if called from another thread.
+	 */
+	int CurrentWorker() const;
+	/**
+	 * @brief Runs one job from the own queue or stolen from another one.
+	 * @param workerIndex Index of the calling worker, or -1.
+	 * @return true If a job was run.
+	 */
+	bool TryRunJob(int workerIndex);
+	/**
+	 * @brief Runs queued jobs until a counter reaches zero.
+	 * @param remaining Counter to wait for.
+	 */
+	void WaitFor(const std::atomic<int>& remaining);
+	/**
+	 * @brief Body of each worker thread.
+	 * @param workerIndex Index of the worker and of its queue.
+	 */
+	void WorkerLoop(int workerIndex);
+
+	/// Worker threads.
+	std::vector<std::thread> workers;
+	/// One queue per worker, plus a last one for other threads.
+	std::vector<std::unique_ptr<JobQueue>> queues;
+	/// Number of jobs in all the queues.
+	std::atomic<int> queuedJobs{ 0 };
+	/// Guards sleeping and the stopping flag.
+	std::mutex sleepMutex;
+	/// Wakes workers when a job is queued or the system stops.
+	std::condition_variable condition;
+	/// Set by the destructor to make the workers exit.
+	bool stopping = false;
+};
+
+template <typename TFunc>
+void JobSystem::ParallelFor(int count, int chunkSize, TFunc func)
+{
+	if (count <= 0) {
+		return;
+	}
+	const int chunkCount = (count + chunkSize - 1) / chunkSize;
+	if (workers.empty() || chunkCount == 1) {
+		func(0, count);
+		return;
+	}
+	std::atomic<int> remaining(chunkCount - 1);
+	for (int chunk = 1; chunk < chunkCount; chunk++) {
+		const int begin = chunk * chunkSize;
+		const int end = std::min(count, begin + chunkSize);
+		Submit([&func, &remaining, begin, end] {
+			func(begin, end);
+			remaining.fetch_sub(1, std::memory_order_acq_rel);
+		});
+	}
+	func(0, chunkSize);
+	WaitFor(remaining);
+}
+
+#endif // !JOBSYSTEM_HPP
@@ -111,10 +111,14 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 			// CircleColliderComponent
 			sol::optional<sol::table> hasCircleCollider = components["circle_collider"];
 			if (hasCircleCollider != sol::nullopt) {
+				sol::optional<unsigned int> layer = (*hasCircleCollider)["layer"];
+				sol::optional<unsigned int> mask = (*hasCircleCollider)["mask"];
 				newEntity.AddComponent<CircleColliderComponent>(
 					components["circle_collider"]["radius"],
 					components["circle_collider"]["width"],
-					components["circle_collider"]["heigth"]
+					components["circle_collider"]["heigth"],
+					layer ? *layer : static_cast<unsigned int>(LAYER_DEFAULT),
+					mask ? *mask : static_cast<unsigned int>(LAYER_ALL)
 				);
 			}
 			// ClickableComponent
@@ -125,11 +129,13 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 			// RigidBodyComponent
 			sol::optional<sol::table> hasRigidBody = components["rigid_body"];
 			if (hasRigidBody != sol::nullopt) {
+				sol::optional<bool> isFast = (*hasRigidBody)["is_fast"];
 				newEntity.AddComponent<RigidBodyComponent>(
 					glm::vec2(
 						components["rigid_body"]["velocity"]["x"],
 						components["rigid_body"]["velocity"]["y"]
-					)
+					),
+					isFast ? *isFast : false
 				);
 			}
 			// ScriptComponent
@@ -204,8 +210,9 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 				if (hasCreateNuke != sol::nullopt) {
 					createNuke = lua["createNuke"];
 				}
-				newEntity.AddComponent<ScriptComponent>(update, onClick, updateBullets, updateEnemy1Position,
-					createEnemy1, createEnemy2, createEnemy3, createExtraLife, updateEnemy3Position, bossMechanics, createNuke);
+				newEntity.AddComponent<ScriptComponent>(std::move(update), std::move(onClick), std::move(updateBullets),
+					std::move(updateEnemy1Position), std::move(createEnemy1), std::move(createEnemy2), std::move(createEnemy3),
+					std::move(createExtraLife), std::move(updateEnemy3Position), std::move(bossMechanics), std::move(createNuke));
 			}
 			// SpriteComponent
 			sol::optional<sol::table> hasSprite = components["sprite"];
@@ -31,20 +31,20 @@ public:
      *
      * Iterates through entities, calculates the current animation frame based on elapsed time, and updates
      * the sprite's source rectangle. Marks entities of type 12 (e.g., explosions) for deletion when their
-     * animation completes.
+     * animation completes. Entities are split in chunks across the job system.
+     *
+     * @param jobSystem Workers that run the chunks.
      */
-    void Update() {
-        for (auto entity : GetSystemEntiities()) {
-            auto& animation = entity.GetComponent<AnimationComponent>();
-            auto& sprite = entity.GetComponent<SpriteComponent>();
-
-            int elapsedFrames = ((SDL_GetTicks() - animation.startTime) * animation.frameSpeedRate / 1000);
+    void Update(JobSystem& jobSystem) {
+        const Uint32 currentTime = SDL_GetTicks();
+        registry->GetView<AnimationComponent, SpriteComponent>().ParallelEach(jobSystem,
+            [currentTime](Entity entity, AnimationComponent& animation, SpriteComponent& sprite) {
+            int elapsedFrames = ((currentTime - animation.startTime) * animation.frameSpeedRate / 1000);
             if (elapsedFrames >= animation.numFrames) {
                 if (entity.HasComponent<EntityTypeComponent>()) {
                     int type = entity.GetComponent<EntityTypeComponent>().entityType;
                     if (type == 12) {
                         entity.Kill();
-                        continue;
                     }
                 }
             }
@@ -52,7 +52,7 @@ public:
                 animation.currentFrame = elapsedFrames;
                 sprite.srcRect.x = animation.currentFrame * sprite.width;
             }
-        }
+        });
     }
 
 };
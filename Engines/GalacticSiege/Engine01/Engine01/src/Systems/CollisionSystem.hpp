@@ -2,19 +2,37 @@
 #define COLLISIONSYSTEM_HPP
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "../ECS/ECS.hpp"
 #include "../Components/CircleColliderComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../EventManager/EventManager.hpp"
+#include "../EventManager/CollisionDispatcher.hpp"
 #include "../Events/CollisionEvent.hpp"
+#include "../JobSystem/JobSystem.hpp"
+#include "../Utils/ContactBuffers.hpp"
+#include "../Utils/NarrowPhase.hpp"
+#include "../Utils/SweepAndPrune.hpp"
 
 /**
  * @class CollisionSystem
  * @brief A system for detecting collisions between entities in an Entity-Component-System (ECS) architecture.
  *
  * This system manages entities with CircleColliderComponent and TransformComponent, checking for circular
- * collisions between pairs of entities and emitting CollisionEvent notifications when collisions occur.
+ * collisions between pairs of entities and queueing CollisionEvent notifications when collisions occur.
+ * A sweep-and-prune broadphase on the x axis selects the pairs whose bounding boxes overlap and
+ * whose collision layers match, and each collision is also routed to the CollisionDispatcher
+ * handlers registered for the layers of the pair. The circles are copied into arrays each frame
+ * so the candidate pairs are tested in batches by the SIMD kernels of NarrowPhase. The sweep and
+ * the tests run on the worker threads, and the events are queued afterwards from the calling thread.
+ *
+ * Colliders of fast rigid bodies are also tested along their movement, so a bullet that crosses
+ * an enemy between two frames still hits it: the broadphase gets the box swept from the previous
+ * center to the current one, and the pairs with a fast body are tested with a swept circle test
+ * that gives the time of impact.
  */
 class CollisionSystem : public System {
 public:
@@ -31,56 +49,88 @@ public:
 	/**
 	 * @brief Updates the system by checking for collisions between entities.
 	 *
-	 * Iterates through all pairs of managed entities, calculates their collision boundaries based on
-	 * their positions and collider radii, and emits a CollisionEvent if a collision is detected.
+	 * Computes the world-space centre and radius of every collider once, feeds their bounding boxes
+	 * to the broadphase and runs the circle test only on the pairs it reports, several pairs at a
+	 * time with the same rounding as CheckCircularCollision, queueing a
+	 * CollisionEvent for each collision and dispatching it by layer. Pairs are handled in order of
+	 * entity id.
+	 *
+	 * The sorted proxies are swept in chunks on the workers, each chunk testing its own candidates
+	 * into its own buffer. Events are only sent once every chunk is done and the collisions are
+	 * merged, so handlers run on the calling thread.
 	 *
-	 * @param eventManager A unique pointer to the EventManager for emitting collision events.
+	 * A fast body moves in a straight line from its center in the previous frame, and the others
+	 * are taken as still at their current center. Pairs with a fast body collide if the circles
+	 * touch at any point of that movement, and the event carries the fraction of the frame when
+	 * they first touched.
+	 *
+	 * @param eventManager A unique pointer to the EventManager queueing the collision events.
+	 * @param collisionDispatcher Routes each collision to the handlers of its pair of layers.
+	 * @param jobSystem Workers that run the chunks.
 	 */
-	void Update(std::unique_ptr<EventManager>& eventManager) {
-		auto entities = GetSystemEntiities();
-		for (auto i = entities.begin(); i != entities.end(); ++i) {
-			Entity a = *i;
-			if (!a.IsAlive() || !a.HasComponent<CircleColliderComponent>() || !a.HasComponent<TransformComponent>()) {
-				continue;
+	void Update(std::unique_ptr<EventManager>& eventManager, std::unique_ptr<CollisionDispatcher>& collisionDispatcher,
+		JobSystem& jobSystem) {
+		auto view = registry->GetView<CircleColliderComponent, TransformComponent>();
+		view.Each([this](Entity entity, CircleColliderComponent& collider, TransformComponent& transform) {
+			const int id = entity.GetId();
+			if (static_cast<size_t>(id) >= bodies.size()) {
+				bodies.resize(id + 100);
 			}
-			auto& aCollider = a.GetComponent<CircleColliderComponent>();
-			auto& aTransform = a.GetComponent<TransformComponent>();
-
-			for (auto j = std::next(i); j != entities.end(); ++j) {
-				Entity b = *j;
-				if (!b.IsAlive() || !b.HasComponent<CircleColliderComponent>() || !b.HasComponent<TransformComponent>()) {
-					continue;
-				}
-				auto& bCollider = b.GetComponent<CircleColliderComponent>();
-				auto& bTransform = b.GetComponent<TransformComponent>();
-
-				glm::vec2 aCenterPos = glm::vec2(
-					aTransform.position.x + (aCollider.width / 2.0f) * aTransform.scale.x,
-					aTransform.position.y + (aCollider.height / 2.0f) * aTransform.scale.y
-				);
-
-				glm::vec2 bCenterPos = glm::vec2(
-					bTransform.position.x + (bCollider.width / 2.0f) * bTransform.scale.x,
-					bTransform.position.y + (bCollider.height / 2.0f) * bTransform.scale.y
-				);
-
-
-				int aRadius = aCollider.radius * glm::max(aTransform.scale.x, aTransform.scale.y);
-				int bRadius = bCollider.radius * glm::max(bTransform.scale.x, bTransform.scale.y);
-
-				bool collision = CheckCircularCollision(aRadius, bRadius, aCenterPos, bCenterPos);
-
-				if (collision) {
-					eventManager->EmitEvent<CollisionEvent>(a, b);
+			Body& body = bodies[id];
+			// The center of the last frame is only known if this collider was set in it.
+			const bool wasSet = body.entity == entity && broadphase.Has(id);
+			const glm::vec2 previousCenter = body.center;
+			body.entity = entity;
+			body.center = glm::vec2(
+				transform.position.x + (collider.width / 2.0f) * transform.scale.x,
+				transform.position.y + (collider.height / 2.0f) * transform.scale.y
+			);
+			body.radius = static_cast<int>(collider.radius * glm::max(transform.scale.x, transform.scale.y));
+			body.layer = collider.layer;
+			body.isFast = entity.HasComponent<RigidBodyComponent>() && entity.GetComponent<RigidBodyComponent>().isFast;
+			body.start = body.isFast && wasSet ? previousCenter : body.center;
+			hasFastBodies = hasFastBodies || body.isFast;
+			broadphase.Set(id, glm::min(body.start.x, body.center.x) - body.radius, glm::min(body.start.y, body.center.y) - body.radius,
+				glm::max(body.start.x, body.center.x) + body.radius, glm::max(body.start.y, body.center.y) + body.radius,
+				collider.layer, collider.mask);
+			circles.Set(id, body.center.x, body.center.y, static_cast<float>(body.radius));
+		});
+		broadphase.RemoveStale();
+		broadphase.Sort();
+		contactBuffers.Run(jobSystem, broadphase.GetProxyCount(), [this](int begin, int end, ContactBuffers::Buffer& buffer) {
+			buffer.pairs.clear();
+			broadphase.QueryPairs(begin, end, buffer.pairs);
+			NarrowPhase::TestCircles(circles, buffer.pairs, buffer.hits);
+			buffer.timesOfImpact.assign(buffer.pairs.size(), 1.0f);
+			if (!hasFastBodies) {
+				return;
+			}
+			for (size_t i = 0; i < buffer.pairs.size(); ++i) {
+				const Body& a = bodies[buffer.pairs[i].first];
+				const Body& b = bodies[buffer.pairs[i].second];
+				if ((a.isFast || b.isFast) && SweepCircles(a, b, buffer.timesOfImpact[i])) {
+					buffer.hits[i] = 1;
 				}
 			}
+		});
+		hasFastBodies = false;
+		contactBuffers.Merge(contacts);
+		for (const ContactBuffers::Contact& contact : contacts) {
+			const Body& a = bodies[contact.a];
+			const Body& b = bodies[contact.b];
+			// Handlers may kill entities of later pairs.
+			if (!a.entity.IsAlive() || !b.entity.IsAlive()) {
+				continue;
+			}
+			eventManager->QueueEvent<CollisionEvent>(a.entity, b.entity, contact.timeOfImpact);
+			collisionDispatcher->Dispatch(a.entity, a.layer, b.entity, b.layer, contact.timeOfImpact);
 		}
 	}
 	/**
 	 * @brief Checks for circular collision between two entities.
 	 *
-	 * Determines if two entities collide by comparing the distance between their centers to the sum
-	 * of their radii.
+	 * Determines if two entities collide by comparing the squared distance between their centers to
+	 * the squared sum of their radii, which avoids a square root per pair.
 	 *
 	 * @param aRadius The collision radius of the first entity.
 	 * @param bRadius The collision radius of the second entity.
@@ -90,10 +140,73 @@ public:
 	 */
 	bool CheckCircularCollision(int aRadius, int bRadius, glm::vec2 aPos, glm::vec2 bPos) {
 		glm::vec2 dif = aPos - bPos;
-		double length = glm::sqrt((dif.x * dif.x) + (dif.y * dif.y));
+		double lengthSquared = (dif.x * dif.x) + (dif.y * dif.y);
+		double radii = aRadius + bRadius;
 		// Hay colisin si la suma de los radios es mayor a la distancia entre centros
-		return (aRadius + bRadius) >= length;
+		return radii >= 0 && radii * radii >= lengthSquared;
+	}
+private:
+	/// World-space circle of a collider for the current frame.
+	struct Body {
+		Entity entity;
+		glm::vec2 center;
+		glm::vec2 start;     ///< Center at the start of the frame's movement.
+		int radius = 0;
+		unsigned int layer = 0;
+		bool isFast = false; ///< Whether the collider is swept from start to center.
+	};
+	/**
+	 * @brief Finds when two circles moving in a straight line during the frame first touch.
+	 *
+	 * Solves |s + t * d| = ra + rb for the earliest t in [0, 1], where s is the distance between
+	 * the starting centers and d the movement of a relative to b.
+	 *
+	 * @param a The first circle.
+	 * @param b The second circle.
+	 * @param timeOfImpact Receives the fraction of the frame when they first touch.
+	 * @return True if the circles touch during the frame.
+	 */
+	static bool SweepCircles(const Body& a, const Body& b, float& timeOfImpact) {
+		const glm::dvec2 s = glm::dvec2(a.start) - glm::dvec2(b.start);
+		const glm::dvec2 d = (glm::dvec2(a.center) - glm::dvec2(a.start)) - (glm::dvec2(b.center) - glm::dvec2(b.start));
+		const double radii = a.radius + b.radius;
+		if (radii < 0) {
+			return false;
+		}
+		const double c = glm::dot(s, s) - radii * radii;
+		if (c <= 0) {
+			timeOfImpact = 0.0f;
+			return true;
+		}
+		const double dd = glm::dot(d, d);
+		const double sd = glm::dot(s, d);
+		// Not getting closer
+		if (sd >= 0) {
+			return false;
+		}
+		const double discriminant = sd * sd - dd * c;
+		if (discriminant < 0) {
+			return false;
+		}
+		const double t = (-sd - glm::sqrt(discriminant)) / dd;
+		if (t > 1) {
+			return false;
+		}
+		timeOfImpact = static_cast<float>(t);
+		return true;
 	}
+	/// Circles of this frame indexed by entity id, kept to reuse the storage.
+	std::vector<Body> bodies;
+	/// Broadphase holding the bounding box of every circle.
+	SweepAndPrune broadphase;
+	/// Candidate pairs and circle test results of each chunk of proxies.
+	ContactBuffers contactBuffers;
+	/// Colliding pairs of this frame, merged from the chunks.
+	std::vector<ContactBuffers::Contact> contacts;
+	/// Whether some collider of this frame is swept.
+	bool hasFastBodies = false;
+	/// Circles of this frame as arrays, for the batched test.
+	CircleBatch circles;
 };
 
 #endif // !COLLISIONSYSTEM_HPP
@@ -12,6 +12,7 @@
 
 #include "../ECS/ECS.hpp"
 #include "../EventManager/EventManager.hpp"
+#include "../EventManager/CollisionDispatcher.hpp"
 #include "../Events/CollisionEvent.hpp"
 
 /**
@@ -19,8 +20,9 @@
  * @brief A system for handling damage and collision events in an Entity-Component-System (ECS) architecture.
  *
  * This system manages entities with HealthComponent, CircleColliderComponent, and EntityTypeComponent.
- * It processes collision events to apply damage, handle entity deaths, trigger power-ups, and create visual
- * and audio effects such as explosions and sound effects.
+ * It handles the collisions of each pair of collision layers it subscribes to, applying damage, handling
+ * entity deaths, triggering power-ups, and creating visual and audio effects such as explosions and sound
+ * effects.
  */
 class DamageSystem : public System {
 public:
@@ -36,57 +38,69 @@ public:
         RequiredComponent<EntityTypeComponent>();
     }
     /**
-     * @brief Subscribes the system to collision events.
+     * @brief Subscribes the system to the collisions it handles.
      *
-     * Registers the system to handle CollisionEvent notifications via the event manager.
+     * Each interaction is registered for its pair of collision layers, so every handler only receives the
+     * pairs it acts on, with the entity on the first layer as CollisionEvent::a.
      *
-     * @param eventManager A unique pointer to the EventManager instance.
+     * @param collisionDispatcher The dispatcher routing collisions by layer.
      */
-    void SubscribeToCollisionEvent(std::unique_ptr<EventManager>& eventManager) {
-        eventManager->SubscribeToEvent<CollisionEvent, DamageSystem>(this, &DamageSystem::OnCollision);
+    void SubscribeToCollisions(std::unique_ptr<CollisionDispatcher>& collisionDispatcher) {
+        collisionDispatcher->Subscribe(LAYER_PLAYER, LAYER_ENEMY_BULLET | LAYER_BOSS_BULLET, this, &DamageSystem::OnHitByBullet);
+        collisionDispatcher->Subscribe(LAYER_ENEMY, LAYER_PLAYER_BULLET, this, &DamageSystem::OnHitByBullet);
+        collisionDispatcher->Subscribe(LAYER_PLAYER, LAYER_ENEMY, this, &DamageSystem::OnEnemyAttack);
+        collisionDispatcher->Subscribe(LAYER_PLAYER, LAYER_POWER_UP, this, &DamageSystem::OnPowerUp);
+        collisionDispatcher->Subscribe(LAYER_BOSS_BULLET, LAYER_PLAYER_BULLET, this, &DamageSystem::OnProjectilesCollision);
     }
     /**
-     * @brief Handles collision events between entities.
+     * @brief Handles the player or an enemy being hit by a bullet.
      *
-     * Processes collisions to determine interactions such as player hit by enemy bullets, enemy hit by player
-     * bullets, player attacked by enemies, power-up collection, or projectile collisions. Applies damage,
-     * updates scores, and triggers appropriate effects.
+     * Deals one point of damage to the target, handles its death and destroys the bullet.
      *
-     * @param e The CollisionEvent containing the two colliding entities.
+     * @param e The collision, with the target as a and the bullet as b.
      */
-    void OnCollision(CollisionEvent& e) {
-        if (!e.a.IsAlive() || !e.b.IsAlive()) return;
-        if (!e.a.HasComponent<EntityTypeComponent>() || !e.b.HasComponent<EntityTypeComponent>()) return;
-        int aType = e.a.GetComponent<EntityTypeComponent>().entityType;
-        int bType = e.b.GetComponent<EntityTypeComponent>().entityType;
-        bool isPlayerHitByEnemyBullet = (aType == 1 && bType == 4) || (aType == 1 && bType == 13);
-        bool isEnemyHitByPlayerBullet = (aType == 3 && bType == 2) || (aType == 5 && bType == 2) ||
-            (aType == 6 && bType == 2) || (aType == 7 && bType == 2);
-        bool isPlayerAttackedByEnemy = (aType == 1 && bType == 5);
-        bool playerGatheredPowerUp = (aType == 1 && bType == 10) || (aType == 1 && bType == 11);
-        bool projectilesCollision = (aType == 13 && bType == 2);
-        if (isPlayerHitByEnemyBullet || isEnemyHitByPlayerBullet) {
-            DealDamage(e.a, 1);
-            if (GetHealth(e.a) <= 0 && e.a.IsAlive()) {
-                HandleEntityDeath(e.a, bType);
-            }
-            e.b.Kill();
-        }
-        else if (isPlayerAttackedByEnemy ) {
-            EnemyAttack(e.a, e.b);
+    void OnHitByBullet(CollisionEvent& e) {
+        if (!IsValidPair(e)) return;
+        int bulletType = e.b.GetComponent<EntityTypeComponent>().entityType;
+        DealDamage(e.a, 1);
+        if (GetHealth(e.a) <= 0 && e.a.IsAlive()) {
+            HandleEntityDeath(e.a, bulletType);
         }
-        else if (playerGatheredPowerUp) {
-            if (bType == 10) {
-                GainLife(e.a, e.b);
-            }
-            else if (bType == 11) {
-                Nuke(e.b);
-            }
+        e.b.Kill();
+    }
+    /**
+     * @brief Handles the player touching an enemy.
+     *
+     * @param e The collision, with the player as a and the enemy as b.
+     */
+    void OnEnemyAttack(CollisionEvent& e) {
+        if (!IsValidPair(e)) return;
+        EnemyAttack(e.a, e.b);
+    }
+    /**
+     * @brief Handles the player picking up a power-up.
+     *
+     * @param e The collision, with the player as a and the power-up as b.
+     */
+    void OnPowerUp(CollisionEvent& e) {
+        if (!IsValidPair(e)) return;
+        int powerUpType = e.b.GetComponent<EntityTypeComponent>().entityType;
+        if (powerUpType == 10) {
+            GainLife(e.a, e.b);
         }
-        else if (projectilesCollision) {
-            e.b.Kill();
+        else if (powerUpType == 11) {
+            Nuke(e.b);
         }
     }
+    /**
+     * @brief Handles a player bullet hitting a boss bullet, which destroys the player bullet.
+     *
+     * @param e The collision, with the boss bullet as a and the player bullet as b.
+     */
+    void OnProjectilesCollision(CollisionEvent& e) {
+        if (!IsValidPair(e)) return;
+        e.b.Kill();
+    }
     /**
      * @brief Plays a sound effect using the asset manager.
      *
@@ -103,6 +117,18 @@ public:
     }
 
 private:
+    /**
+     * @brief Checks that both entities of a collision are alive and typed.
+     *
+     * An earlier handler in the same frame may have killed one of them.
+     *
+     * @param e The collision event.
+     * @return True if the collision should be handled.
+     */
+    bool IsValidPair(const CollisionEvent& e) const {
+        return e.a.IsAlive() && e.b.IsAlive()
+            && e.a.HasComponent<EntityTypeComponent>() && e.b.HasComponent<EntityTypeComponent>();
+    }
     /**
      * @brief Applies damage to an entity.
      *
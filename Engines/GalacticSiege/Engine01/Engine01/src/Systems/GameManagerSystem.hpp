@@ -27,6 +27,7 @@ public:
      */
     GameManagerSystem() {
         this->playerHealth = 0;
+        this->playerScore = 0;
         this->gameTimer = 0.0f;
         this->gameOver = false;
         this->nextScene = "";
@@ -53,8 +54,13 @@ public:
         if (sceneType == "notGame") {
             return;
         }
-        playerHealth = player.GetComponent<HealthComponent>().health;
-        playerScore = player.GetComponent<ScoreComponent>().score;
+        playerHealth = 0;
+        if (player.HasComponent<HealthComponent>()) {
+            playerHealth = player.GetComponent<HealthComponent>().health;
+        }
+        if (player.HasComponent<ScoreComponent>()) {
+            playerScore = player.GetComponent<ScoreComponent>().score;
+        }
         gameTimer -= dt;
         UpdatePlayerScore(std::to_string(playerScore));
         UpdatePlayerHealth(std::to_string(playerHealth));
@@ -124,7 +130,7 @@ public:
      * @param gameTimer The game timer value as a string.
      */
     void UpdateBossHealth() {
-        if (!bossHealthEnt.HasComponent<TextComponent>()) {
+        if (!bossHealthEnt.HasComponent<TextComponent>() || !boss.HasComponent<HealthComponent>()) {
             return;
         }
         std::string bossHealth = std::to_string(boss.GetComponent<HealthComponent>().health);
@@ -32,13 +32,15 @@ public:
      *
      * Iterates through entities, calculates their bounding box based on position and sprite dimensions,
      * and determines if they are fully within the screen boundaries. Updates the
-     * IsEntityInsideTheScreenComponent's flag accordingly.
+     * IsEntityInsideTheScreenComponent's flag accordingly. Entities are split in chunks across
+     * the job system.
      *
      * @param windowWidth The width of the game window.
      * @param windowHeight The height of the game window.
+     * @param jobSystem Workers that run the chunks.
      */
-    void Update(int windowWidth, int windowHeight) {
-        for (auto entity : GetSystemEntiities()) {
+    void Update(int windowWidth, int windowHeight, JobSystem& jobSystem) {
+        ParallelForEach(jobSystem, [&](Entity entity) {
             auto& transform = entity.GetComponent<TransformComponent>();
             auto& insideComponent = entity.GetComponent<IsEntityInsideTheScreenComponent>();
             auto& sprite = entity.GetComponent<SpriteComponent>();
@@ -50,7 +52,7 @@ public:
             if (fullyInside) {
                 insideComponent.isEntityInsideTheScreen = true;
             }
-        }
+        });
     }
 
 };
@@ -5,6 +5,7 @@
 #include "../Components/TransformComponent.hpp"
 #include "../Components/SpriteComponent.hpp"
 #include "../Components/EntityTypeComponent.hpp"
+#include "../Components/IsEntityInsideTheScreenComponent.hpp"
 #include "../ECS/ECS.hpp"
 
 /**
@@ -82,14 +83,12 @@ private:
      *
      * Adjusts the entity's velocity to move toward the player based on their relative positions.
      *
-     * @param player The player entity to follow.
+     * @param playerPosition The position of the player at the start of the frame.
      * @param transform The TransformComponent of the enemy, containing its position.
      * @param rigidBody The RigidBodyComponent of the enemy, containing its velocity.
      */
-    void Enemy2FollowUp(Entity player, TransformComponent& transform, RigidBodyComponent& rigidBody) {
-        if (!player.HasComponent<TransformComponent>()) return;
-        auto& playerPosition = player.GetComponent<TransformComponent>();
-        glm::vec2 toPlayer = playerPosition.position - transform.position;
+    void Enemy2FollowUp(const glm::vec2& playerPosition, TransformComponent& transform, RigidBodyComponent& rigidBody) {
+        glm::vec2 toPlayer = playerPosition - transform.position;
         float distance = glm::length(toPlayer);
         if (distance > 1.0f) {
             glm::vec2 direction = glm::normalize(toPlayer);
@@ -155,48 +154,54 @@ public:
      * specific movement behaviors (e.g., bouncing off borders, following the player, or random movement)
      * depending on the entity type.
      *
+     * Entities are split in chunks across the job system. Enemies follow the player position
+     * from the start of the frame, so no chunk reads a transform another chunk writes. Enemy3
+     * movement draws from rand(), so it runs afterwards on this thread, in pool order, to keep
+     * the random sequence deterministic.
+     *
      * @param dt Delta time since the last update, used for time-based movement calculations.
      * @param windowHeight The height of the game window.
      * @param windowWidth The width of the game window.
      * @param player The player entity, used for specific interactions like enemy follow-up.
+     * @param jobSystem Workers that run the chunks.
      */
-    void Update(double dt, int windowHeight, int windowWidth, const Entity player) {
-        for (auto entity : GetSystemEntiities()) {
-            if (!entity.HasComponent<RigidBodyComponent>() ||
-                !entity.HasComponent<TransformComponent>() ||
-                !entity.HasComponent<EntityTypeComponent>()) {
-                continue;
-            }
-            auto& rigidBody = entity.GetComponent<RigidBodyComponent>();
-            auto& transform = entity.GetComponent<TransformComponent>();
-            auto& sprite = entity.GetComponent<SpriteComponent>();
-            int type = entity.GetComponent<EntityTypeComponent>().entityType;
+    void Update(double dt, int windowHeight, int windowWidth, const Entity player, JobSystem& jobSystem) {
+        const bool hasPlayer = player.HasComponent<TransformComponent>();
+        const glm::vec2 playerPosition = hasPlayer ? player.GetComponent<TransformComponent>().position : glm::vec2(0.0f);
+        const double width = static_cast<double>(windowWidth);
+        const double height = static_cast<double>(windowHeight);
+        registry->GetView<RigidBodyComponent, TransformComponent, SpriteComponent, EntityTypeComponent>().ParallelEach(jobSystem,
+            [&](Entity entity, RigidBodyComponent& rigidBody, TransformComponent& transform,
+                SpriteComponent& sprite, EntityTypeComponent& entityType) {
+            int type = entityType.entityType;
             transform.position.x += rigidBody.velocity.x * dt;
             transform.position.y += rigidBody.velocity.y * dt;
-            double width = static_cast<double>(windowWidth);
-            double height = static_cast<double>(windowHeight);
-            if (type == 3 || type == 6) {
+            if (type == 3) {
                 if (entity.HasComponent<IsEntityInsideTheScreenComponent>() &&
                     entity.GetComponent<IsEntityInsideTheScreenComponent>().isEntityInsideTheScreen) {
-                    if (type == 3) {
-                        BounceInBorders(width, height, transform, rigidBody, sprite, type);
-                    }
-                    else {
-                        Enemy3Movement(rigidBody);
-                        BounceInBorders(width, height, transform, rigidBody, sprite, type);
-                    }
+                    BounceInBorders(width, height, transform, rigidBody, sprite, type);
                 }
             }
             else if (type == 2 || type == 4 || type == 13) {
                 CheckProjectilesPosition(transform.position.x, transform.position.y, width, height, entity);
             }
             else if (type == 5) {
-                Enemy2FollowUp(player, transform, rigidBody);
+                if (hasPlayer) {
+                    Enemy2FollowUp(playerPosition, transform, rigidBody);
+                }
             }
             else if (type == 1) {
                 CheckPlayerPosition(entity, windowWidth, windowHeight);
             }
-        }
+        });
+        registry->GetView<IsEntityInsideTheScreenComponent, RigidBodyComponent, TransformComponent, SpriteComponent, EntityTypeComponent>().Each(
+            [&](Entity, IsEntityInsideTheScreenComponent& inside, RigidBodyComponent& rigidBody, TransformComponent& transform,
+                SpriteComponent& sprite, EntityTypeComponent& entityType) {
+            if (entityType.entityType == 6 && inside.isEntityInsideTheScreen) {
+                Enemy3Movement(rigidBody);
+                BounceInBorders(width, height, transform, rigidBody, sprite, entityType.entityType);
+            }
+        });
     }
 };
 
@@ -3,10 +3,16 @@
 
 #include <SDL.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "../AssetManager/AssetManager.hpp"
 #include "../Components/SpriteComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Utils/SpriteBatch.hpp"
 
 /**
  * @class RenderSystem
@@ -33,33 +39,65 @@ public:
 	 *
 	 * Iterates through entities, retrieves their sprite and transform components, and renders the sprites
 	 * to the provided SDL renderer using the specified texture and transformations from the AssetManager.
+	 * Sprites are drawn in the order their entities were created, so later entities are drawn on top.
+	 * The view walks the pools, whose order changes when components are removed or packed, so the sprites
+	 * are sorted by creation order first. Consecutive sprites sharing a texture are then submitted
+	 * together through the sprite batch, and the texture is only looked up when the texture id changes.
 	 *
 	 * @param renderer The SDL renderer used to draw the sprites.
 	 * @param assetManager A unique pointer to the AssetManager for accessing textures.
 	 */
 	void Update(SDL_Renderer* renderer, const std::unique_ptr<AssetManager>& AssetManager) {
-		for (auto entity : GetSystemEntiities()) {
-			const auto sprite = entity.GetComponent<SpriteComponent>();
-			const auto transform = entity.GetComponent<TransformComponent>();
+		drawItems.clear();
+		registry->GetView<SpriteComponent, TransformComponent>().Each(
+			[&](Entity entity, const SpriteComponent& sprite, const TransformComponent& transform) {
+			drawItems.push_back({ registry->GetCreationOrder(entity), &sprite, &transform });
+		});
+		std::sort(drawItems.begin(), drawItems.end(), [](const DrawItem& a, const DrawItem& b) {
+			return a.order < b.order;
+		});
 
-			SDL_Rect srcRect = sprite.srcRect;
+		batch.Begin(renderer);
+		const std::string* textureId = nullptr;
+		SDL_Texture* texture = nullptr;
+		for (const DrawItem& item : drawItems) {
+			const SpriteComponent& sprite = *item.sprite;
+			const TransformComponent& transform = *item.transform;
+			if (textureId == nullptr || sprite.textureId != *textureId) {
+				textureId = &sprite.textureId;
+				texture = AssetManager->GetTexture(sprite.textureId);
+			}
 			SDL_Rect dstRect = {
 				static_cast<int>(transform.position.x),
 				static_cast<int>(transform.position.y),
 				static_cast<int>(sprite.width * transform.scale.x),
 				static_cast<int>(sprite.height * transform.scale.y),
 			};
-			SDL_RenderCopyEx(
-				renderer,
-				AssetManager->GetTexture(sprite.textureId),
-				&srcRect,
-				&dstRect,
-				transform.rotation,
-				NULL,
-				SDL_FLIP_NONE
-			);
+			batch.Draw(texture, sprite.srcRect, dstRect, transform.rotation);
 		}
+		batch.End();
+	}
+	/**
+	 * @brief Gets the number of render calls made by the last Update, at most one per change of texture.
+	 */
+	int GetDrawCallCount() const {
+		return batch.GetDrawCallCount();
+	}
+	/**
+	 * @brief Gets the number of sprites drawn by the last Update.
+	 */
+	int GetSpriteCount() const {
+		return batch.GetSpriteCount();
 	}
+private:
+	/// Sprite of an entity waiting to be drawn.
+	struct DrawItem {
+		std::uint64_t order;                 ///< Creation order of the entity.
+		const SpriteComponent* sprite;       ///< Sprite to draw.
+		const TransformComponent* transform; ///< Placement of the sprite.
+	};
+	std::vector<DrawItem> drawItems; ///< Sprites of the frame sorted by creation order, kept to reuse the storage.
+	SpriteBatch batch;               ///< Batch collecting the sprites of a frame.
 };
 
 #endif RENDERSYSTEM_HPP
\ No newline at end of file
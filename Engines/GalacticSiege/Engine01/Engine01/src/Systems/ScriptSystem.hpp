@@ -101,6 +101,9 @@ public:
 			}
 			else if (script.bossMechanics != sol::lua_nil) {
 				Entity player = Game::GetInstance().registry->GetSystem<GameManagerSystem>().GetPlayer();
+				if (!player.HasComponent<TransformComponent>()) {
+					continue;
+				}
 				TransformComponent transformPlayer = player.GetComponent<TransformComponent>();
 				double playerX = transformPlayer.position.x;
 				double playerY = transformPlayer.position.y;
@@ -0,0 +1,83 @@
+#ifndef CONTACTBUFFERS_HPP
+#define CONTACTBUFFERS_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../JobSystem/JobSystem.hpp"
+
+/**
+ * @class ContactBuffers
+ * @brief Splits the search for colliding pairs in chunks of proxies that run on the workers.
+ *
+ * Every chunk writes its candidate pairs, narrowphase results and times of impact to its own
+ * buffer, so the jobs share no memory. The colliding pairs are then merged and sorted by entity
+ * id on the calling thread, which gives the same order no matter how the jobs were scheduled.
+ * The buffers are kept between frames to reuse their storage.
+ */
+class ContactBuffers {
+public:
+	/// Number of proxies searched by each job.
+	static constexpr int CHUNK_SIZE = 256;
+	/// Pairs found by one chunk.
+	struct Buffer {
+		std::vector<std::pair<int, int>> pairs; ///< Candidate pairs of entity ids.
+		std::vector<unsigned char> hits;        ///< 1 for each candidate pair that collides.
+		std::vector<float> timesOfImpact;       ///< Time of impact of each candidate pair.
+	};
+	/// Colliding pair merged from the buffers.
+	struct Contact {
+		int a;              ///< Lower entity id of the pair.
+		int b;              ///< Higher entity id of the pair.
+		float timeOfImpact; ///< Fraction of the frame at which the pair started touching.
+
+		bool operator<(const Contact& other) const {
+			return a < other.a || (a == other.a && b < other.b);
+		}
+	};
+	/**
+	 * @brief Runs a search over every chunk of proxies and waits for all of them.
+	 *
+	 * @tparam TFunc Callable as func(int begin, int end, Buffer& buffer), which fills the buffer
+	 * with the candidates of proxies [begin, end) and the narrowphase result and time of impact
+	 * of each one.
+	 * @param jobSystem Workers that run the chunks.
+	 * @param count Number of proxies.
+	 * @param func Function called once per chunk.
+	 */
+	template <typename TFunc>
+	void Run(JobSystem& jobSystem, int count, TFunc&& func) {
+		chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		if (buffers.size() < static_cast<size_t>(chunkCount)) {
+			buffers.resize(chunkCount);
+		}
+		jobSystem.ParallelFor(count, CHUNK_SIZE, [&](int begin, int end) {
+			func(begin, end, buffers[begin / CHUNK_SIZE]);
+		});
+	}
+	/**
+	 * @brief Collects the colliding pairs from the buffers of the last Run.
+	 *
+	 * @param contacts Receives the pairs sorted by entity ids; it is cleared first.
+	 */
+	void Merge(std::vector<Contact>& contacts) const {
+		contacts.clear();
+		for (int chunk = 0; chunk < chunkCount; ++chunk) {
+			const Buffer& buffer = buffers[chunk];
+			for (size_t i = 0; i < buffer.pairs.size(); ++i) {
+				if (buffer.hits[i]) {
+					contacts.push_back({ buffer.pairs[i].first, buffer.pairs[i].second, buffer.timesOfImpact[i] });
+				}
+			}
+		}
+		std::sort(contacts.begin(), contacts.end());
+	}
+private:
+	/// One buffer per chunk of the last Run, and maybe unused ones after them.
+	std::vector<Buffer> buffers;
+	/// Number of chunks of the last Run.
+	int chunkCount = 0;
+};
+
+#endif // !CONTACTBUFFERS_HPP
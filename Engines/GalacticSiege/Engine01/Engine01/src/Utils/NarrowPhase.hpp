@@ -0,0 +1,227 @@
+#ifndef NARROWPHASE_HPP
+#define NARROWPHASE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NARROWPHASE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need the wider instruction set enabled per function.
+#if defined(NARROWPHASE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NARROWPHASE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NARROWPHASE_TARGET(isa)
+#endif
+
+/**
+ * @brief Instruction sets the narrowphase kernels can use, from narrowest to widest.
+ */
+enum class SimdLevel {
+	Scalar, ///< One pair at a time.
+	SSE2,   ///< Four pairs at a time.
+	AVX2    ///< Eight pairs at a time, loading the circles with gathers.
+};
+
+/**
+ * @brief Circles of the colliders of a frame, one array per field, indexed by entity id.
+ */
+struct CircleBatch {
+	std::vector<float> x;      ///< X coordinate of each center.
+	std::vector<float> y;      ///< Y coordinate of each center.
+	std::vector<float> radius; ///< Radius of each circle.
+
+	/**
+	 * @brief Stores a circle, growing the arrays if needed.
+	 *
+	 * @param id The entity id of the collider.
+	 * @param centerX X coordinate of the center.
+	 * @param centerY Y coordinate of the center.
+	 * @param r Radius of the circle.
+	 */
+	void Set(int id, float centerX, float centerY, float r) {
+		if (static_cast<size_t>(id) >= x.size()) {
+			const size_t size = id + 100;
+			x.resize(size);
+			y.resize(size);
+			radius.resize(size);
+		}
+		x[id] = centerX;
+		y[id] = centerY;
+		radius[id] = r;
+	}
+};
+
+/**
+ * @class NarrowPhase
+ * @brief Tests the candidate pairs of the broadphase in batches.
+ *
+ * The kernels test eight pairs per instruction with AVX2 and four with SSE2. The widest set the
+ * CPU supports is detected on first use; the scalar kernel covers other CPUs and the pairs left
+ * at the end of a batch. All kernels round the same way, so they report the same pairs.
+ */
+class NarrowPhase {
+public:
+	/**
+	 * @brief Gets the instruction set used by the kernels.
+	 */
+	static SimdLevel GetSimdLevel() {
+		return ActiveLevel();
+	}
+	/**
+	 * @brief Selects the instruction set used by the kernels, lowered to what the CPU supports.
+	 *
+	 * @param level The requested instruction set.
+	 */
+	static void SetSimdLevel(SimdLevel level) {
+		ActiveLevel() = std::min(level, DetectSimdLevel());
+	}
+	/**
+	 * @brief Tests which pairs of circles overlap or touch.
+	 *
+	 * @param circles Circles of the colliders, indexed by entity id.
+	 * @param pairs Pairs of entity ids to test.
+	 * @param hits Receives 1 for each pair that collides and 0 otherwise.
+	 */
+	static void TestCircles(const CircleBatch& circles, const std::vector<std::pair<int, int>>& pairs,
+		std::vector<unsigned char>& hits) {
+		hits.resize(pairs.size());
+		size_t done = 0;
+#if defined(NARROWPHASE_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			done = TestCirclesAVX2(circles, pairs.data(), pairs.size(), hits.data());
+		}
+		else if (GetSimdLevel() == SimdLevel::SSE2) {
+			done = TestCirclesSSE2(circles, pairs.data(), pairs.size(), hits.data());
+		}
+#endif
+		TestCirclesScalar(circles, pairs.data(), done, pairs.size(), hits.data());
+	}
+	/**
+	 * @brief Checks which instruction sets the CPU and the operating system support.
+	 *
+	 * @return The widest instruction set the kernels can use.
+	 */
+	static SimdLevel DetectSimdLevel() {
+#if defined(NARROWPHASE_X86) && (defined(__GNUC__) || defined(__clang__))
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			return SimdLevel::AVX2;
+		}
+		if (__builtin_cpu_supports("sse2")) {
+			return SimdLevel::SSE2;
+		}
+#elif defined(NARROWPHASE_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+		__cpuid(info, 1);
+		const bool sse2 = (info[3] & (1 << 26)) != 0;
+		const bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		// AVX registers are only usable if the operating system saves them.
+		if (maxLeaf >= 7 && osUsesXSave && avx && (_xgetbv(0) & 6) == 6) {
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5)) {
+				return SimdLevel::AVX2;
+			}
+		}
+		if (sse2) {
+			return SimdLevel::SSE2;
+		}
+#endif
+		return SimdLevel::Scalar;
+	}
+private:
+	static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int), "pairs are loaded as consecutive ints");
+
+	static SimdLevel& ActiveLevel() {
+		static SimdLevel level = DetectSimdLevel();
+		return level;
+	}
+	static void TestCirclesScalar(const CircleBatch& circles, const std::pair<int, int>* pairs,
+		size_t begin, size_t end, unsigned char* hits) {
+		for (size_t i = begin; i < end; ++i) {
+			const int a = pairs[i].first;
+			const int b = pairs[i].second;
+			const float dx = circles.x[a] - circles.x[b];
+			const float dy = circles.y[a] - circles.y[b];
+			const float dx2 = dx * dx;
+			const float dy2 = dy * dy;
+			const float lengthSquared = dx2 + dy2;
+			const float radii = circles.radius[a] + circles.radius[b];
+			hits[i] = radii >= 0.0f && radii * radii >= lengthSquared;
+		}
+	}
+#if defined(NARROWPHASE_X86)
+	NARROWPHASE_TARGET("sse2")
+	static size_t TestCirclesSSE2(const CircleBatch& circles, const std::pair<int, int>* pairs,
+		size_t count, unsigned char* hits) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const int a0 = pairs[i].first, a1 = pairs[i + 1].first, a2 = pairs[i + 2].first, a3 = pairs[i + 3].first;
+			const int b0 = pairs[i].second, b1 = pairs[i + 1].second, b2 = pairs[i + 2].second, b3 = pairs[i + 3].second;
+			const __m128 dx = _mm_sub_ps(
+				_mm_setr_ps(circles.x[a0], circles.x[a1], circles.x[a2], circles.x[a3]),
+				_mm_setr_ps(circles.x[b0], circles.x[b1], circles.x[b2], circles.x[b3]));
+			const __m128 dy = _mm_sub_ps(
+				_mm_setr_ps(circles.y[a0], circles.y[a1], circles.y[a2], circles.y[a3]),
+				_mm_setr_ps(circles.y[b0], circles.y[b1], circles.y[b2], circles.y[b3]));
+			const __m128 radii = _mm_add_ps(
+				_mm_setr_ps(circles.radius[a0], circles.radius[a1], circles.radius[a2], circles.radius[a3]),
+				_mm_setr_ps(circles.radius[b0], circles.radius[b1], circles.radius[b2], circles.radius[b3]));
+			const __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+			const __m128 collide = _mm_and_ps(_mm_cmpge_ps(radii, _mm_setzero_ps()),
+				_mm_cmpge_ps(_mm_mul_ps(radii, radii), lengthSquared));
+			StoreHits(_mm_movemask_ps(collide), 4, hits + i);
+		}
+		return i;
+	}
+	/// Loads the entity ids of eight pairs, first ids and second ids in separate registers.
+	NARROWPHASE_TARGET("avx2")
+	static void LoadPairsAVX2(const std::pair<int, int>* pairs, __m256i& first, __m256i& second) {
+		const __m256 low = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs)));
+		const __m256 high = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 4)));
+		// Shuffles stay inside each 128-bit half (a0 a1 a4 a5 a2 a3 a6 a7), so the halves are reordered after.
+		const __m256i evens = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m256i odds = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+		first = _mm256_permute4x64_epi64(evens, _MM_SHUFFLE(3, 1, 2, 0));
+		second = _mm256_permute4x64_epi64(odds, _MM_SHUFFLE(3, 1, 2, 0));
+	}
+	NARROWPHASE_TARGET("avx2")
+	static size_t TestCirclesAVX2(const CircleBatch& circles, const std::pair<int, int>* pairs,
+		size_t count, unsigned char* hits) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i a, b;
+			LoadPairsAVX2(pairs + i, a, b);
+			const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(circles.x.data(), a, 4),
+				_mm256_i32gather_ps(circles.x.data(), b, 4));
+			const __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(circles.y.data(), a, 4),
+				_mm256_i32gather_ps(circles.y.data(), b, 4));
+			const __m256 radii = _mm256_add_ps(_mm256_i32gather_ps(circles.radius.data(), a, 4),
+				_mm256_i32gather_ps(circles.radius.data(), b, 4));
+			// Multiply and add without FMA so the rounding matches the scalar kernel.
+			const __m256 lengthSquared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+			const __m256 collide = _mm256_and_ps(_mm256_cmp_ps(radii, _mm256_setzero_ps(), _CMP_GE_OQ),
+				_mm256_cmp_ps(_mm256_mul_ps(radii, radii), lengthSquared, _CMP_GE_OQ));
+			StoreHits(_mm256_movemask_ps(collide), 8, hits + i);
+		}
+		return i;
+	}
+#endif
+	static void StoreHits(int mask, int lanes, unsigned char* hits) {
+		for (int lane = 0; lane < lanes; ++lane) {
+			hits[lane] = (mask >> lane) & 1;
+		}
+	}
+};
+
+#endif // !NARROWPHASE_HPP
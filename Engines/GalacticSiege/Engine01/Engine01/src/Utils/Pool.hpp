@@ -2,6 +2,8 @@
 #define POOL_HPP
 
 #include <vector>
+#include <cassert>
+#include <utility>
 
 /**
  * @brief A global vector to store IPool objects (commented out).
@@ -22,14 +24,21 @@ public:
 	 * @brief Virtual destructor to ensure proper cleanup of derived classes.
 	 */
 	virtual ~IPool() = default;
+	/**
+	 * @brief Removes the component owned by an entity, if any.
+	 *
+	 * @param entityId The id of the entity.
+	 */
+	virtual void RemoveEntityFromPool(int entityId) = 0;
 };
 
 /**
  * @class Pool
- * @brief A template class for managing a pool of components of type TComponent.
+ * @brief A sparse-set pool of components of type TComponent.
  *
- * This class implements the IPool interface and provides functionality to store,
- * access, and manipulate a collection of components in a vector.
+ * Components are packed in a dense vector and a sparse vector maps each entity id
+ * to its slot, so the pool only holds components that actually exist. Removing a
+ * component moves the last one into the freed slot.
  *
  * @tparam TComponent The type of component to be stored in the pool.
  */
@@ -37,12 +46,13 @@ template <typename TComponent>
 class Pool : public IPool {
 public:
 	/**
-	 * @brief Constructs a pool with a specified initial size.
+	 * @brief Constructs a pool reserving space for some components.
 	 *
-	 * @param size The initial size of the pool (default is 1000).
+	 * @param capacity The number of components to reserve (default is 100).
 	 */
-	Pool(int size = 1000) {
-		data.resize(size);
+	Pool(int capacity = 100) {
+		data.reserve(capacity);
+		indexToEntityId.reserve(capacity);
 	}
 	/**
 	 * @brief Virtual destructor to ensure proper cleanup.
@@ -57,67 +67,180 @@ public:
 		return data.empty();
 	}
 	/**
-	 * @brief Gets the current size of the pool.
+	 * @brief Gets the number of components stored in the pool.
 	 *
 	 * @return The number of components in the pool.
 	 */
 	int GetSize() const {
 		return static_cast<int>(data.size());
 	}
-	/**
-	 * @brief Resizes the pool to a new size.
-	 *
-	 * @param n The new size of the pool.
-	 */
-	void Resize(int n) {
-		data.resize(n);
-	}
 	/**
 	 * @brief Clears all components from the pool.
 	 */
 	void Clear() {
 		data.clear();
+		indexToEntityId.clear();
+		entityIdToIndex.clear();
 	}
 	/**
-	 * @brief Adds a component to the end of the pool.
+	 * @brief Checks if an entity has a component in the pool.
 	 *
-	 * @param object The component to add.
+	 * @param entityId The id of the entity.
+	 * @return True if the entity has a component stored, false otherwise.
 	 */
-	void Add(TComponent object) {
-		data.push_back(object);
+	bool Has(int entityId) const {
+		return entityId >= 0
+			&& static_cast<size_t>(entityId) < entityIdToIndex.size()
+			&& entityIdToIndex[entityId] != INVALID_INDEX;
 	}
 	/**
-	 * @brief Sets a component at the specified index.
+	 * @brief Sets the component of an entity, adding it if the entity has none.
 	 *
-	 * @param index The index where the component will be set.
+	 * @param entityId The id of the entity.
 	 * @param object The component to set.
 	 */
-	void Set(unsigned int index, TComponent object) {
-		data[index] = object;
+	void Set(int entityId, TComponent object) {
+		if (Has(entityId)) {
+			data[entityIdToIndex[entityId]] = std::move(object);
+			return;
+		}
+		if (static_cast<size_t>(entityId) >= entityIdToIndex.size()) {
+			entityIdToIndex.resize(entityId + 100, INVALID_INDEX);
+		}
+		entityIdToIndex[entityId] = static_cast<int>(data.size());
+		indexToEntityId.push_back(entityId);
+		data.push_back(std::move(object));
+	}
+	/**
+	 * @brief Constructs the component of an entity in place, replacing any previous one.
+	 *
+	 * Arguments are forwarded to the component constructor, so no temporary is copied
+	 * and move-only components are supported.
+	 *
+	 * @tparam TArgs Constructor argument types.
+	 * @param entityId The id of the entity.
+	 * @param args Arguments forwarded to the component constructor.
+	 * @return A reference to the stored component.
+	 */
+	template <typename... TArgs>
+	TComponent& Emplace(int entityId, TArgs&&... args) {
+		if (Has(entityId)) {
+			TComponent& component = data[entityIdToIndex[entityId]];
+			component = TComponent(std::forward<TArgs>(args)...);
+			return component;
+		}
+		if (static_cast<size_t>(entityId) >= entityIdToIndex.size()) {
+			entityIdToIndex.resize(entityId + 100, INVALID_INDEX);
+		}
+		entityIdToIndex[entityId] = static_cast<int>(data.size());
+		indexToEntityId.push_back(entityId);
+		return data.emplace_back(std::forward<TArgs>(args)...);
 	}
 	/**
-	 * @brief Gets a reference to the component at the specified index.
+	 * @brief Removes the component of an entity by swapping the last one into its slot.
 	 *
-	 * @param index The index of the component to retrieve.
-	 * @return A reference to the component at the specified index.
+	 * @param entityId The id of the entity.
 	 */
-	TComponent& Get(unsigned int index) {
-		return static_cast<TComponent&>(data[index]);
+	void Remove(int entityId) {
+		if (!Has(entityId)) {
+			return;
+		}
+		const int index = entityIdToIndex[entityId];
+		const int lastIndex = static_cast<int>(data.size()) - 1;
+		if (index != lastIndex) {
+			const int lastEntityId = indexToEntityId[lastIndex];
+			data[index] = std::move(data[lastIndex]);
+			indexToEntityId[index] = lastEntityId;
+			entityIdToIndex[lastEntityId] = index;
+		}
+		data.pop_back();
+		indexToEntityId.pop_back();
+		entityIdToIndex[entityId] = INVALID_INDEX;
 	}
 	/**
-	 * @brief Accesses a component at the specified index using the subscript operator.
+	 * @brief Removes the component of an entity through the IPool interface.
 	 *
-	 * @param index The index of the component to access.
-	 * @return A reference to the component at the specified index.
+	 * @param entityId The id of the entity.
 	 */
-	TComponent& operator[](unsigned int index) {
-		return static_cast<TComponent&>(data[index]);
+	void RemoveEntityFromPool(int entityId) override {
+		Remove(entityId);
+	}
+	/**
+	 * @brief Gets a reference to the component of an entity.
+	 *
+	 * @param entityId The id of the entity, which must have a component in the pool.
+	 * @return A reference to the component of the entity.
+	 */
+	TComponent& Get(int entityId) {
+		assert(Has(entityId) && "Pool::Get on an entity without a component");
+		return data[entityIdToIndex[entityId]];
+	}
+	/**
+	 * @brief Accesses the component of an entity using the subscript operator.
+	 *
+	 * @param entityId The id of the entity, which must have a component in the pool.
+	 * @return A reference to the component of the entity.
+	 */
+	TComponent& operator[](int entityId) {
+		return Get(entityId);
+	}
+	/**
+	 * @brief Gets the id of the entity that owns the component at a dense slot.
+	 *
+	 * @param index The slot, between 0 and GetSize() - 1.
+	 * @return The id of the owning entity.
+	 */
+	int GetEntityId(int index) const {
+		return indexToEntityId[index];
+	}
+	/**
+	 * @brief Gets the dense slot of the component of an entity.
+	 *
+	 * @param entityId The id of the entity, which must have a component in the pool.
+	 * @return The slot, between 0 and GetSize() - 1.
+	 */
+	int GetIndex(int entityId) const {
+		assert(Has(entityId) && "Pool::GetIndex on an entity without a component");
+		return entityIdToIndex[entityId];
+	}
+	/**
+	 * @brief Swaps two dense slots, keeping the entity mappings in sync.
+	 *
+	 * @param first The first slot.
+	 * @param second The second slot.
+	 */
+	void SwapSlots(int first, int second) {
+		if (first == second) {
+			return;
+		}
+		std::swap(data[first], data[second]);
+		std::swap(indexToEntityId[first], indexToEntityId[second]);
+		entityIdToIndex[indexToEntityId[first]] = first;
+		entityIdToIndex[indexToEntityId[second]] = second;
+	}
+	/// Pointer to the packed components, valid until the pool grows.
+	TComponent* GetData() {
+		return data.data();
+	}
+	/// Iterator to the first stored component.
+	typename std::vector<TComponent>::iterator begin() {
+		return data.begin();
+	}
+	/// Iterator past the last stored component.
+	typename std::vector<TComponent>::iterator end() {
+		return data.end();
 	}
 private:
+	/// Value of the sparse vector for entities without a component.
+	static constexpr int INVALID_INDEX = -1;
 	/**
-	 * @brief The underlying vector that stores the components.
+	 * @brief The dense vector that stores the components.
 	 */
 	std::vector<TComponent> data;
+	/// Id of the entity owning each slot of the dense vector.
+	std::vector<int> indexToEntityId;
+	/// Slot of each entity id in the dense vector, or INVALID_INDEX.
+	std::vector<int> entityIdToIndex;
 };
 
 #endif // !POOL_HPP
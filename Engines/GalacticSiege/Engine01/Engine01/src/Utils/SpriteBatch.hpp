@@ -0,0 +1,136 @@
+#ifndef SPRITEBATCH_HPP
+#define SPRITEBATCH_HPP
+
+#include <SDL.h>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/**
+ * @class SpriteBatch
+ * @brief Collects sprites into vertex and index arrays drawn one texture at a time.
+ *
+ * Each sprite becomes a quad appended to the batch of the current texture. When a sprite uses
+ * another texture the batch is submitted with a single SDL_RenderGeometry call and a new one
+ * starts, so sprites keep the order of the Draw calls while consecutive sprites of the same
+ * texture cost one call in total. The batch never reorders sprites; callers sort them first, as
+ * RenderSystem does by creation order. Quads are rotated as SDL_RenderCopyEx does, around the
+ * center of the destination rectangle. The arrays are kept between frames to reuse their storage.
+ */
+class SpriteBatch {
+public:
+	/**
+	 * @brief Starts a frame of drawing.
+	 * @param renderer The SDL renderer the batches are submitted to.
+	 */
+	void Begin(SDL_Renderer* renderer) {
+		this->renderer = renderer;
+		texture = nullptr;
+		drawCalls = 0;
+		spriteCount = 0;
+	}
+	/**
+	 * @brief Adds a sprite to the batch. Sprites without a texture are skipped.
+	 *
+	 * @param spriteTexture Texture to sample.
+	 * @param srcRect Part of the texture to draw, in pixels.
+	 * @param dstRect Rectangle to draw to, in pixels.
+	 * @param angle Clockwise rotation in degrees around the center of dstRect.
+	 * @param flip Whether to mirror the sprite horizontally.
+	 */
+	void Draw(SDL_Texture* spriteTexture, const SDL_Rect& srcRect, const SDL_Rect& dstRect, double angle, bool flip = false) {
+		// Geometry without a texture would be drawn as a solid quad.
+		if (spriteTexture == nullptr) {
+			return;
+		}
+		if (spriteTexture != texture) {
+			Flush();
+			texture = spriteTexture;
+			int width = 0;
+			int height = 0;
+			SDL_QueryTexture(texture, NULL, NULL, &width, &height);
+			inverseWidth = width > 0 ? 1.0f / width : 0.0f;
+			inverseHeight = height > 0 ? 1.0f / height : 0.0f;
+		}
+		float u0 = srcRect.x * inverseWidth;
+		float u1 = (srcRect.x + srcRect.w) * inverseWidth;
+		const float v0 = srcRect.y * inverseHeight;
+		const float v1 = (srcRect.y + srcRect.h) * inverseHeight;
+		if (flip) {
+			std::swap(u0, u1);
+		}
+		// Corners relative to the center: top-left, top-right, bottom-right, bottom-left.
+		const float halfWidth = dstRect.w * 0.5f;
+		const float halfHeight = dstRect.h * 0.5f;
+		const float centerX = dstRect.x + halfWidth;
+		const float centerY = dstRect.y + halfHeight;
+		const float cornerX[4] = { -halfWidth, halfWidth, halfWidth, -halfWidth };
+		const float cornerY[4] = { -halfHeight, -halfHeight, halfHeight, halfHeight };
+		const float cornerU[4] = { u0, u1, u1, u0 };
+		const float cornerV[4] = { v0, v0, v1, v1 };
+		float cosine = 1.0f;
+		float sine = 0.0f;
+		if (angle != 0.0) {
+			const double radians = angle * M_PI / 180.0;
+			cosine = static_cast<float>(std::cos(radians));
+			sine = static_cast<float>(std::sin(radians));
+		}
+		const int first = static_cast<int>(vertices.size());
+		for (int i = 0; i < 4; ++i) {
+			SDL_Vertex vertex;
+			vertex.position.x = centerX + cornerX[i] * cosine - cornerY[i] * sine;
+			vertex.position.y = centerY + cornerX[i] * sine + cornerY[i] * cosine;
+			vertex.color = { 255, 255, 255, 255 };
+			vertex.tex_coord.x = cornerU[i];
+			vertex.tex_coord.y = cornerV[i];
+			vertices.push_back(vertex);
+		}
+		const int quad[6] = { 0, 1, 2, 2, 3, 0 };
+		for (int index : quad) {
+			indices.push_back(first + index);
+		}
+		++spriteCount;
+	}
+	/**
+	 * @brief Submits the last batch of the frame.
+	 */
+	void End() {
+		Flush();
+	}
+	/**
+	 * @brief Gets the number of render calls made in the last frame.
+	 */
+	int GetDrawCallCount() const {
+		return drawCalls;
+	}
+	/**
+	 * @brief Gets the number of sprites drawn in the last frame.
+	 */
+	int GetSpriteCount() const {
+		return spriteCount;
+	}
+private:
+	SDL_Renderer* renderer = nullptr;
+	SDL_Texture* texture = nullptr; ///< Texture of the batch being collected.
+	float inverseWidth = 0.0f;      ///< Inverse of the texture width, to get texture coordinates.
+	float inverseHeight = 0.0f;     ///< Inverse of the texture height, to get texture coordinates.
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+	int drawCalls = 0;
+	int spriteCount = 0;
+
+	/// Submits the batch being collected, if any, and empties it.
+	void Flush() {
+		if (vertices.empty()) {
+			return;
+		}
+		SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+			indices.data(), static_cast<int>(indices.size()));
+		++drawCalls;
+		vertices.clear();
+		indices.clear();
+	}
+};
+
+#endif // !SPRITEBATCH_HPP
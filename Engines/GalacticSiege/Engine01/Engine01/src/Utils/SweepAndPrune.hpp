@@ -0,0 +1,188 @@
+#ifndef SWEEPANDPRUNE_HPP
+#define SWEEPANDPRUNE_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * @class SweepAndPrune
+ * @brief Collision broadphase that keeps boxes sorted along the x axis.
+ *
+ * Each proxy is a box identified by a small non-negative id (the entity id). The
+ * proxies are kept sorted by their left side, so a sweep only pairs a proxy with
+ * the ones that start before it ends. The order persists between frames and is
+ * restored with insertion sort, which is close to linear since bodies move little
+ * from one frame to the next.
+ *
+ * Each proxy also has a layer and a mask, and a pair is only reported if both proxies have the
+ * layer of the other one in their mask.
+ */
+class SweepAndPrune {
+public:
+	/**
+	 * @brief Checks if a proxy is stored.
+	 *
+	 * @param id The id of the proxy.
+	 * @return True if the proxy was set and not removed.
+	 */
+	bool Has(int id) const {
+		return id >= 0
+			&& static_cast<size_t>(id) < proxies.size()
+			&& proxies[id].active;
+	}
+	/**
+	 * @brief Inserts a proxy or updates its box.
+	 *
+	 * @param id The id of the proxy.
+	 * @param minX Left side of the box.
+	 * @param minY Top side of the box.
+	 * @param maxX Right side of the box.
+	 * @param maxY Bottom side of the box.
+	 * @param layer Layer bits of the proxy.
+	 * @param mask Layers the proxy can pair with.
+	 */
+	void Set(int id, float minX, float minY, float maxX, float maxY,
+		unsigned int layer = 0xFFFFFFFFu, unsigned int mask = 0xFFFFFFFFu) {
+		if (static_cast<size_t>(id) >= proxies.size()) {
+			proxies.resize(id + 100);
+		}
+		Proxy& proxy = proxies[id];
+		if (!proxy.active) {
+			proxy.active = true;
+			endpoints.push_back({ minX, maxX, minY, maxY, layer, mask, id });
+		}
+		proxy.seen = true;
+		proxy.minX = minX;
+		proxy.minY = minY;
+		proxy.maxX = maxX;
+		proxy.maxY = maxY;
+		proxy.layer = layer;
+		proxy.mask = mask;
+	}
+	/**
+	 * @brief Removes the proxies that were not set since the last call.
+	 *
+	 * Drops killed entities and entities that lost their components, keeping the
+	 * order of the rest.
+	 */
+	void RemoveStale() {
+		size_t kept = 0;
+		for (const Endpoint& endpoint : endpoints) {
+			Proxy& proxy = proxies[endpoint.id];
+			if (proxy.seen) {
+				proxy.seen = false;
+				endpoints[kept++] = endpoint;
+			}
+			else {
+				proxy.active = false;
+			}
+		}
+		endpoints.resize(kept);
+	}
+	/**
+	 * @brief Removes every proxy.
+	 */
+	void Clear() {
+		proxies.clear();
+		endpoints.clear();
+	}
+	/**
+	 * @brief Gets the number of stored proxies.
+	 */
+	int GetProxyCount() const {
+		return static_cast<int>(endpoints.size());
+	}
+	/**
+	 * @brief Copies the boxes set this frame into the sorted list and restores its order.
+	 *
+	 * Must be called after the last Set and before QueryPairs over a range.
+	 */
+	void Sort() {
+		for (Endpoint& endpoint : endpoints) {
+			const Proxy& proxy = proxies[endpoint.id];
+			endpoint.minX = proxy.minX;
+			endpoint.maxX = proxy.maxX;
+			endpoint.minY = proxy.minY;
+			endpoint.maxY = proxy.maxY;
+			endpoint.layer = proxy.layer;
+			endpoint.mask = proxy.mask;
+		}
+		// Insertion sort, nearly linear on last frame's order.
+		for (size_t i = 1; i < endpoints.size(); ++i) {
+			const Endpoint endpoint = endpoints[i];
+			size_t j = i;
+			while (j > 0 && endpoints[j - 1].minX > endpoint.minX) {
+				endpoints[j] = endpoints[j - 1];
+				--j;
+			}
+			endpoints[j] = endpoint;
+		}
+	}
+	/**
+	 * @brief Collects the pairs of proxies whose boxes overlap and whose layers match.
+	 *
+	 * Each pair is reported once as (lower id, higher id), sorted so the dispatch
+	 * order is stable.
+	 *
+	 * @param pairs Receives the overlapping pairs; it is cleared first.
+	 */
+	void QueryPairs(std::vector<std::pair<int, int>>& pairs) {
+		Sort();
+		pairs.clear();
+		QueryPairs(0, GetProxyCount(), pairs);
+		std::sort(pairs.begin(), pairs.end());
+	}
+	/**
+	 * @brief Collects the pairs that start at a range of the sorted proxies.
+	 *
+	 * Each pair belongs to the proxy of the two that comes first in the sorted list, so
+	 * splitting [0, GetProxyCount()) in ranges finds every pair once and the ranges can be
+	 * swept on different threads. Sort must have been called first. Pairs are appended
+	 * unsorted.
+	 *
+	 * @param begin First proxy of the range, in sorted order.
+	 * @param end Proxy after the last one of the range.
+	 * @param pairs Receives the overlapping pairs.
+	 */
+	void QueryPairs(int begin, int end, std::vector<std::pair<int, int>>& pairs) const {
+		for (size_t i = begin; i < static_cast<size_t>(end); ++i) {
+			const Endpoint& a = endpoints[i];
+			for (size_t j = i + 1; j < endpoints.size() && endpoints[j].minX <= a.maxX; ++j) {
+				const Endpoint& b = endpoints[j];
+				if (a.minY <= b.maxY && b.minY <= a.maxY
+					&& (a.layer & b.mask) != 0 && (b.layer & a.mask) != 0) {
+					pairs.emplace_back(std::min(a.id, b.id), std::max(a.id, b.id));
+				}
+			}
+		}
+	}
+private:
+	/// Box of a proxy as last set.
+	struct Proxy {
+		float minX = 0.0f;
+		float minY = 0.0f;
+		float maxX = 0.0f;
+		float maxY = 0.0f;
+		unsigned int layer = 0;
+		unsigned int mask = 0;
+		bool active = false;
+		bool seen = false;
+	};
+	/// Entry of the sorted list, with a copy of the box for the sweep.
+	struct Endpoint {
+		float minX;
+		float maxX;
+		float minY;
+		float maxY;
+		unsigned int layer;
+		unsigned int mask;
+		int id;
+	};
+	/// Proxies indexed by id.
+	std::vector<Proxy> proxies;
+	/// Stored proxies sorted by the left side of their box.
+	std::vector<Endpoint> endpoints;
+};
+
+#endif // !SWEEPANDPRUNE_HPP
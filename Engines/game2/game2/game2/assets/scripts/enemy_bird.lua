@@ -22,7 +22,7 @@ function enemy_bird_update(dt)
     end
 end
 
-function on_collision(other)
+function on_collision_enter(other)
     local tag = get_tag(other)
     if tag == "player" and top_collision(this, other) then
 		enemy_bird_is_dying()
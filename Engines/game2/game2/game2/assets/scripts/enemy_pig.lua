@@ -22,7 +22,7 @@ function enemy_pig_update(dt)
 	update_pig_animation_state()
 end
 
-function on_collision(other)
+function on_collision_enter(other)
     local tag = get_tag(other)
     if tag == "player" and top_collision(this, other) then
 		enemy_pig_is_dying()
@@ -0,0 +1,135 @@
+/**
+ * @file ArchetypeIterationBench.cpp
+ * @brief Measures iteration over a view against a registered archetype
+ *
+ * Populates a registry the way a shooter does: most entities are bullets
+ * with a collider, a rigid body, a transform and a type, the rest are
+ * ships without the physics components. A third of the entities is then
+ * killed and respawned so the pools are no longer in creation order. The
+ * kernel integrates the transform by the rigid body and reads the rest.
+ *
+ * Three cases are timed, per matched entity:
+ *  - view: a registry without archetypes
+ *  - view, packed pools: the same view over a registry whose pools were
+ *    packed by the archetype
+ *  - archetype: Archetype::Each over the packed slots
+ *
+ * Usage: archetype_iteration_bench.out
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "ECS/ECS.hpp"
+
+struct BenchTransform {
+	float x = 0.0f;
+	float y = 0.0f;
+	float scaleX = 1.0f;
+	float scaleY = 1.0f;
+	double rotation = 0.0;
+	BenchTransform(float x = 0.0f, float y = 0.0f) : x(x), y(y) {}
+};
+
+struct BenchRigidBody {
+	float velocityX = 0.0f;
+	float velocityY = 0.0f;
+	BenchRigidBody(float velocityX = 0.0f, float velocityY = 0.0f) : velocityX(velocityX), velocityY(velocityY) {}
+};
+
+struct BenchCollider {
+	int radius = 0;
+	BenchCollider(int radius = 0) : radius(radius) {}
+};
+
+struct BenchType {
+	int type = 0;
+	BenchType(int type = 0) : type(type) {}
+};
+
+/**
+ * @brief Adds the bullet components, in a different order than the archetype lists them
+ */
+static Entity AddBullet(Registry& registry, float position) {
+	Entity entity = registry.CreateEntity();
+	registry.AddComponent<BenchType>(entity, 2);
+	registry.AddComponent<BenchTransform>(entity, position, position);
+	registry.AddComponent<BenchRigidBody>(entity, 1.0f, -4.0f);
+	registry.AddComponent<BenchCollider>(entity, 8);
+	return entity;
+}
+
+static void Populate(Registry& registry, int entityCount) {
+	std::mt19937 random(7);
+	std::vector<Entity> entities;
+	entities.reserve(entityCount);
+	for (int i = 0; i < entityCount; i++) {
+		if (random() % 4 == 0) {
+			Entity ship = registry.CreateEntity();
+			registry.AddComponent<BenchTransform>(ship, i, i);
+			registry.AddComponent<BenchType>(ship, 1);
+			entities.push_back(ship);
+		}
+		else {
+			entities.push_back(AddBullet(registry, i));
+		}
+	}
+	registry.Update();
+
+	// Distinct victims, so the respawns reuse their indices and stay under ENTITY_INDEX_MASK
+	std::shuffle(entities.begin(), entities.end(), random);
+	for (int i = 0; i < entityCount / 3; i++) {
+		registry.KillEntity(entities[i]);
+	}
+	registry.Update();
+	for (int i = 0; i < entityCount / 3; i++) {
+		AddBullet(registry, i);
+	}
+	registry.Update();
+}
+
+template <typename TFunc>
+static double TimeFrame(TFunc func, int frames) {
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++) {
+		func();
+	}
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+int main() {
+	std::printf("entities   matched   view (ns)   view, packed pools (ns)   archetype (ns)\n");
+	for (int entityCount : { 10000, 100000, 1000000 }) {
+		const int frames = entityCount >= 1000000 ? 20 : (entityCount >= 100000 ? 100 : 1000);
+
+		Registry plain;
+		Populate(plain, entityCount);
+		Registry packed;
+		packed.RegisterArchetype<BenchCollider, BenchRigidBody, BenchTransform, BenchType>();
+		Populate(packed, entityCount);
+
+		float sink = 0.0f;
+		auto kernel = [&sink](Entity, BenchCollider& collider, BenchRigidBody& rigidBody, BenchTransform& transform, BenchType& type) {
+			transform.x += rigidBody.velocityX * 0.016f;
+			transform.y += rigidBody.velocityY * 0.016f;
+			sink += collider.radius + type.type;
+		};
+		const double view = TimeFrame([&]() {
+			plain.GetView<BenchCollider, BenchRigidBody, BenchTransform, BenchType>().Each(kernel);
+		}, frames);
+		const double packedView = TimeFrame([&]() {
+			packed.GetView<BenchCollider, BenchRigidBody, BenchTransform, BenchType>().Each(kernel);
+		}, frames);
+		const double archetype = TimeFrame([&]() {
+			packed.GetArchetype<BenchCollider, BenchRigidBody, BenchTransform, BenchType>().Each(kernel);
+		}, frames);
+
+		const int matched = packed.GetArchetype<BenchCollider, BenchRigidBody, BenchTransform, BenchType>().GetSize();
+		std::printf("%8d  %8d   %9.2f   %23.2f   %14.2f   (sink %g)\n", entityCount, matched,
+			view / matched, packedView / matched, archetype / matched, sink);
+	}
+	return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file BroadphaseStressBench.cpp
+ * @brief Measures the box collider broadphase against testing every pair
+ *
+ * Builds a level-like scene: thousands of static tiles and strips, like the
+ * colliders SceneLoader::LoadColliders creates from a TMX object group,
+ * over a 6400x3200 map, plus 64 moving 32x32 boxes. Every frame the moving
+ * boxes are displaced and the overlapping pairs are found twice:
+ *  - all pairs: every pair of colliders is tested, as BoxCollisionSystem
+ *    did before it had a broadphase
+ *  - broadphase: AABBBroadphase, as BoxCollisionSystem feeds it, and only
+ *    the reported pairs are tested
+ *
+ * Pairs of static colliders are never reported by the broadphase, so they
+ * are left out of the all-pairs hits compared at the end.
+ *
+ * Usage: broadphase_stress_bench.out [frames]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Utils/AABBTree.hpp"
+
+/**
+ * @brief Same test as BoxCollisionSystem::CheckCollision
+ */
+static bool CheckCollision(const AABB& a, const AABB& b) {
+	return a.minX < b.maxX && a.maxX > b.minX && a.minY < b.maxY && a.maxY > b.minY;
+}
+
+/**
+ * @brief Moves the boxes after the static ones
+ */
+static void MoveBoxes(std::vector<AABB>& boxes, int staticCount, float dx, float dy) {
+	for (size_t i = staticCount; i < boxes.size(); i++) {
+		boxes[i].minX += dx;
+		boxes[i].maxX += dx;
+		boxes[i].minY += dy;
+		boxes[i].maxY += dy;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 20;
+	const int movingCount = 64;
+
+	std::printf("colliders   all pairs: tests/frame   ms/frame   broadphase: tests/frame   ms/frame   hits/frame\n");
+	for (int staticCount : { 5000, 10000 }) {
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<AABB> boxes;
+		for (int i = 0; i < staticCount; i++) {
+			const float x = static_cast<int>(unit(random) * 400) * 16.0f;
+			const float y = static_cast<int>(unit(random) * 200) * 16.0f;
+			const float width = 16.0f + 16.0f * static_cast<int>(unit(random) * 6);
+			const float height = 16.0f + 16.0f * static_cast<int>(unit(random) * 2);
+			boxes.push_back({ x, y, x + width, y + height });
+		}
+		for (int i = 0; i < movingCount; i++) {
+			const float x = unit(random) * 6400.0f;
+			const float y = unit(random) * 3200.0f;
+			boxes.push_back({ x, y, x + 32.0f, y + 32.0f });
+		}
+		const int count = static_cast<int>(boxes.size());
+
+		long long allPairsTests = 0;
+		long long allPairsHits = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			MoveBoxes(boxes, staticCount, 3.0f, 1.0f);
+			for (int i = 0; i < count; i++) {
+				for (int j = i + 1; j < count; j++) {
+					allPairsTests++;
+					if (CheckCollision(boxes[i], boxes[j]) && j >= staticCount) {
+						allPairsHits++;
+					}
+				}
+			}
+		}
+		const double allPairsTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		MoveBoxes(boxes, staticCount, -3.0f * frames, -1.0f * frames);
+
+		AABBBroadphase broadphase;
+		std::vector<std::pair<int, int>> pairs;
+		long long broadphaseTests = 0;
+		long long broadphaseHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			MoveBoxes(boxes, staticCount, 3.0f, 1.0f);
+			for (int i = 0; i < count; i++) {
+				broadphase.Set(i, boxes[i], i < staticCount);
+			}
+			broadphase.RemoveStale();
+			broadphase.QueryPairs(pairs);
+			for (const auto& pair : pairs) {
+				broadphaseTests++;
+				if (CheckCollision(boxes[pair.first], boxes[pair.second])) {
+					broadphaseHits++;
+				}
+			}
+		}
+		const double broadphaseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::printf("%9d   %21lld   %8.2f   %22lld   %8.3f   %lld%s\n", count,
+			allPairsTests / frames, allPairsTime / frames, broadphaseTests / frames, broadphaseTime / frames,
+			broadphaseHits / frames, allPairsHits == broadphaseHits ? "" : "  MISMATCH");
+		if (allPairsHits != broadphaseHits) {
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file EventDispatchBench.cpp
+ * @brief Measures calling event handlers stored as EventDelegate against the old heap callbacks
+ *
+ * The old EventManager kept each handler as a unique_ptr to an
+ * IEventCallback, a heap object called through its vtable. That class is
+ * reproduced here and called over the same subscribers as a vector of
+ * EventDelegate, with 1, 10 and 100 subscribers of two owner types. The
+ * callbacks are allocated between unrelated blocks, as they are in a game
+ * that subscribes during setup. EmitEvent is also timed, to show the cost
+ * of the whole emission through the EventManager.
+ *
+ * Every time is the best of five runs, per emitted event.
+ *
+ * Usage: event_dispatch_bench.out
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "EventManager/EventManager.hpp"
+
+/**
+ * @brief Handler interface of the old EventManager
+ */
+class OldEventCallback {
+public:
+	virtual ~OldEventCallback() = default;
+	void Execute(Event& e) {
+		Call(e);
+	}
+private:
+	virtual void Call(Event& e) = 0;
+};
+
+/**
+ * @brief Handler of the old EventManager, calling a member function
+ */
+template <typename TOwner, typename TEvent>
+class OldMemberCallback : public OldEventCallback {
+public:
+	typedef void (TOwner::*CallbackFunction)(TEvent&);
+	OldMemberCallback(TOwner* ownerInstance, CallbackFunction callbackFunction)
+		: ownerInstance(ownerInstance), callbackFunction(callbackFunction) {}
+private:
+	TOwner* ownerInstance;
+	CallbackFunction callbackFunction;
+	void Call(Event& e) override {
+		std::invoke(callbackFunction, ownerInstance, static_cast<TEvent&>(e));
+	}
+};
+
+struct PingEvent : public Event {
+	int value;
+	PingEvent(int value) : value(value) {}
+};
+
+struct AddingListener {
+	long total = 0;
+	void OnPing(PingEvent& e) { total += e.value; }
+};
+
+struct SubtractingListener {
+	long total = 0;
+	void OnPing(PingEvent& e) { total -= e.value; }
+};
+
+template <typename TFunc>
+static double BestTime(TFunc func, int events) {
+	double best = 1e30;
+	for (int run = 0; run < 5; run++) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / events);
+	}
+	return best;
+}
+
+int main() {
+	std::printf("subscribers   old callback (ns/event)   EventDelegate (ns/event)   EmitEvent (ns/event)\n");
+	for (int subscriberCount : { 1, 10, 100 }) {
+		const int events = 4000000 / subscriberCount;
+		std::vector<AddingListener> adding(subscriberCount);
+		std::vector<SubtractingListener> subtracting(subscriberCount);
+		std::vector<std::unique_ptr<OldEventCallback>> callbacks;
+		std::vector<EventDelegate> delegates;
+		std::vector<std::unique_ptr<char[]>> unrelated;
+		EventManager eventManager;
+		for (int i = 0; i < subscriberCount; i++) {
+			unrelated.emplace_back(new char[64]);
+			if (i % 2 == 1) {
+				callbacks.push_back(std::make_unique<OldMemberCallback<AddingListener, PingEvent>>(&adding[i], &AddingListener::OnPing));
+				delegates.push_back(EventDelegate(&adding[i], &AddingListener::OnPing));
+				eventManager.SubscribeToEvent<PingEvent>(&adding[i], &AddingListener::OnPing);
+			}
+			else {
+				callbacks.push_back(std::make_unique<OldMemberCallback<SubtractingListener, PingEvent>>(&subtracting[i], &SubtractingListener::OnPing));
+				delegates.push_back(EventDelegate(&subtracting[i], &SubtractingListener::OnPing));
+				eventManager.SubscribeToEvent<PingEvent>(&subtracting[i], &SubtractingListener::OnPing);
+			}
+		}
+
+		const double oldTime = BestTime([&]() {
+			for (int i = 0; i < events; i++) {
+				PingEvent event(i);
+				for (auto& callback : callbacks) {
+					callback->Execute(event);
+				}
+			}
+		}, events);
+		const double delegateTime = BestTime([&]() {
+			for (int i = 0; i < events; i++) {
+				PingEvent event(i);
+				for (const EventDelegate& delegate : delegates) {
+					delegate.Execute(event);
+				}
+			}
+		}, events);
+		const double emitTime = BestTime([&]() {
+			for (int i = 0; i < events; i++) {
+				eventManager.EmitEvent<PingEvent>(i);
+			}
+		}, events);
+
+		long total = 0;
+		for (int i = 0; i < subscriberCount; i++) {
+			total += adding[i].total + subtracting[i].total;
+		}
+		std::printf("%11d   %23.1f   %24.1f   %20.1f   (sink %ld)\n", subscriberCount, oldTime, delegateTime, emitTime, total);
+	}
+	return 0;
+}
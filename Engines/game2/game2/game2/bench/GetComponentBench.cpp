@@ -0,0 +1,83 @@
+/**
+ * @file GetComponentBench.cpp
+ * @brief Measures the cost of Registry::GetComponent against the old shared_ptr access
+ *
+ * The old registry kept its pools in shared_ptr<IPool> and cast a copy of
+ * the pointer with static_pointer_cast on every access, paying two atomic
+ * refcount updates. The same pools are reproduced here that way and read
+ * with the same access pattern as the registry.
+ *
+ * Usage: get_component_bench.out [entities] [frames]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "ECS/ECS.hpp"
+
+/**
+ * @brief Small component read and written on every access
+ */
+struct BenchPosition {
+	float x = 0.0f;
+	float y = 0.0f;
+};
+
+/**
+ * @brief Reads a component the way the old registry did
+ */
+static BenchPosition& GetComponentShared(const std::vector<std::shared_ptr<IPool>>& pools, int componentId, int entityId) {
+	auto componentPool = std::static_pointer_cast<Pool<BenchPosition>>(pools[componentId]);
+	return componentPool->Get(entityId);
+}
+
+int main(int argc, char* argv[]) {
+	const int entityCount = argc > 1 ? std::atoi(argv[1]) : 10000;
+	const int frames = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+	Registry registry;
+	std::vector<Entity> entities;
+	entities.reserve(entityCount);
+	for (int i = 0; i < entityCount; i++) {
+		Entity entity = registry.CreateEntity();
+		registry.AddComponent<BenchPosition>(entity);
+		entities.push_back(entity);
+	}
+	registry.Update();
+
+	const int componentId = Component<BenchPosition>::GetId();
+	std::vector<std::shared_ptr<IPool>> sharedPools(componentId + 1);
+	auto sharedPool = std::make_shared<Pool<BenchPosition>>(entityCount);
+	for (const Entity& entity : entities) {
+		sharedPool->Set(entity.GetId(), BenchPosition());
+	}
+	sharedPools[componentId] = sharedPool;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++) {
+		for (const Entity& entity : entities) {
+			GetComponentShared(sharedPools, componentId, entity.GetId()).x += 1.0f;
+		}
+	}
+	auto middle = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++) {
+		for (const Entity& entity : entities) {
+			registry.GetComponent<BenchPosition>(entity).x += 1.0f;
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	float checksum = 0.0f;
+	for (const Entity& entity : entities) {
+		checksum += registry.GetComponent<BenchPosition>(entity).x + sharedPool->Get(entity.GetId()).x;
+	}
+
+	const double accesses = static_cast<double>(entityCount) * frames;
+	std::printf("GetComponent, %d entities x %d frames\n", entityCount, frames);
+	std::printf("  shared_ptr pools: %.2f ns/access\n", std::chrono::duration<double, std::nano>(middle - start).count() / accesses);
+	std::printf("  registry:         %.2f ns/access\n", std::chrono::duration<double, std::nano>(end - middle).count() / accesses);
+	std::printf("  (checksum %g)\n", checksum);
+	return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file NarrowPhaseBench.cpp
+ * @brief Measures the narrowphase kernels at every instruction set against the per-pair tests
+ *
+ * Random boxes and circles, half with integer and half with fractional
+ * coordinates and a few with negative radii, are tested over random pairs.
+ * Each kernel is checked against the predicates the collision systems used
+ * before the batches, and timed against those predicates run pair by pair
+ * over an array of structures, as the systems did.
+ *
+ * Usage: narrowphase_bench.out [colliders] [pairs]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Utils/NarrowPhase.hpp"
+
+/**
+ * @brief Collider bounds as the systems read them from the components
+ */
+struct BenchBody {
+	float x;
+	float y;
+	float width;
+	float height;
+	int radius;
+};
+
+static bool CheckBoxes(const BenchBody& a, const BenchBody& b) {
+	return a.x < b.x + b.width && a.x + a.width > b.x && a.y < b.y + b.height && a.y + a.height > b.y;
+}
+
+static bool CheckCircles(const BenchBody& a, const BenchBody& b) {
+	const float dx = a.x - b.x;
+	const float dy = a.y - b.y;
+	const double lengthSquared = (dx * dx) + (dy * dy);
+	const double radiusSum = a.radius + b.radius;
+	return radiusSum >= 0 && radiusSum * radiusSum >= lengthSquared;
+}
+
+template <typename TFunc>
+static double TimeRuns(TFunc func, int runs) {
+	auto start = std::chrono::steady_clock::now();
+	for (int run = 0; run < runs; run++) {
+		func();
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+int main(int argc, char* argv[]) {
+	const int colliderCount = argc > 1 ? std::atoi(argv[1]) : 4000;
+	const int pairCount = argc > 2 ? std::atoi(argv[2]) : 200000;
+	const int runs = 50;
+
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int> position(0, 600);
+	std::uniform_int_distribution<int> size(1, 40);
+	std::uniform_int_distribution<int> id(0, colliderCount - 1);
+	std::uniform_real_distribution<float> fraction(0.0f, 600.0f);
+
+	std::vector<BenchBody> bodies(colliderCount);
+	BoxBatch boxes;
+	CircleBatch circles;
+	for (int i = 0; i < colliderCount; i++) {
+		BenchBody& body = bodies[i];
+		const bool integral = i % 2 == 1;
+		body.x = integral ? position(random) : fraction(random);
+		body.y = integral ? position(random) : fraction(random);
+		body.width = static_cast<float>(size(random));
+		body.height = static_cast<float>(size(random));
+		body.radius = size(random) - (i % 97 == 0 ? 60 : 0);
+		boxes.Set(i, body.x, body.y, body.x + body.width, body.y + body.height);
+		circles.Set(i, body.x, body.y, static_cast<float>(body.radius));
+	}
+	std::vector<std::pair<int, int>> pairs(pairCount);
+	for (auto& pair : pairs) {
+		pair.first = id(random);
+		pair.second = id(random);
+	}
+
+	std::printf("%d pairs over %d colliders, mean of %d runs\n", pairCount, colliderCount, runs);
+	long long sink = 0;
+	const double perPairBoxes = TimeRuns([&]() {
+		for (const auto& pair : pairs) {
+			sink += CheckBoxes(bodies[pair.first], bodies[pair.second]);
+		}
+	}, runs);
+	const double perPairCircles = TimeRuns([&]() {
+		for (const auto& pair : pairs) {
+			sink += CheckCircles(bodies[pair.first], bodies[pair.second]);
+		}
+	}, runs);
+	std::printf("  per pair    boxes %.3f ms   circles %.3f ms\n", perPairBoxes, perPairCircles);
+
+	const char* names[] = { "scalar", "SSE2", "AVX2" };
+	std::vector<unsigned char> hits;
+	int mismatches = 0;
+	// Before any level is forced, so the kernels run at the levels picked by default
+	const double defaultBoxes = TimeRuns([&]() { NarrowPhase::TestBoxes(boxes, pairs, hits); }, runs);
+	const double defaultCircles = TimeRuns([&]() { NarrowPhase::TestCircles(circles, pairs, hits); }, runs);
+	std::printf("  default     boxes %.3f ms (%s)   circles %.3f ms (%s)\n",
+		defaultBoxes, names[static_cast<int>(NarrowPhase::GetBoxSimdLevel())],
+		defaultCircles, names[static_cast<int>(NarrowPhase::GetSimdLevel())]);
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 }) {
+		if (level > NarrowPhase::DetectSimdLevel()) {
+			std::printf("  %-10s  not supported\n", names[static_cast<int>(level)]);
+			continue;
+		}
+		NarrowPhase::SetSimdLevel(level);
+		NarrowPhase::TestBoxes(boxes, pairs, hits);
+		for (int i = 0; i < pairCount; i++) {
+			mismatches += hits[i] != CheckBoxes(bodies[pairs[i].first], bodies[pairs[i].second]);
+		}
+		NarrowPhase::TestCircles(circles, pairs, hits);
+		for (int i = 0; i < pairCount; i++) {
+			mismatches += hits[i] != CheckCircles(bodies[pairs[i].first], bodies[pairs[i].second]);
+		}
+		const double boxTime = TimeRuns([&]() { NarrowPhase::TestBoxes(boxes, pairs, hits); }, runs);
+		const double circleTime = TimeRuns([&]() { NarrowPhase::TestCircles(circles, pairs, hits); }, runs);
+		std::printf("  %-10s  boxes %.3f ms   circles %.3f ms\n", names[static_cast<int>(level)], boxTime, circleTime);
+	}
+	std::printf("  mismatches against the per-pair tests: %d   (sink %lld)\n", mismatches, sink);
+	return mismatches == 0 ? 0 : 1;
+}
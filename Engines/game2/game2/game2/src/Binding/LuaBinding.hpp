@@ -8,7 +8,9 @@
 
 #include <string>
 #include <tuple>
+#include <vector>
 #include <SDL2/SDL.h>
+#include <sol/sol.hpp>
 
 #include "../Components/RigidBodyComponent.hpp"
 #include "../Components/TagComponent.hpp"
@@ -16,7 +18,9 @@
 #include "../Components/SpriteComponent.hpp"
 #include "../AnimationManager/AnimationManager.hpp"
 #include "../Components/AnimationComponent.hpp"
+#include "../Components/CollisionLayer.hpp"
 #include "../Game/Game.hpp"
+#include "../Systems/BoxCollisionSystem.hpp"
 #include "../ECS/ECS.hpp"
 
 // Controles
@@ -69,12 +73,31 @@ void GoToScene(const std::string& sceneName) {
 /**
  * @brief Gets the tag of an entity
  * @param entity The entity to query
- * @return The tag string of the entity
+ * @return The tag string of the entity, or an empty string if it has no tag
  */
 std::string GetTag(Entity entity) {
+	if (!entity.HasComponent<TagComponent>()) {
+		return "";
+	}
 	return entity.GetComponent<TagComponent>().tag;
 }
 
+/**
+ * @brief Gets the box of an entity's collider at its previous position
+ * @param entity The entity to query
+ * @return The box of the collider before the last movement
+ */
+AABB GetPreviousBox(Entity entity) {
+	const auto& collider = entity.GetComponent<BoxColliderComponent>();
+	const auto& transform = entity.GetComponent<TransformComponent>();
+	AABB box;
+	box.minX = transform.previousPosition.x;
+	box.minY = transform.previousPosition.y;
+	box.maxX = box.minX + static_cast<float>(collider.width);
+	box.maxY = box.minY + static_cast<float>(collider.heigth);
+	return box;
+}
+
 /**
  * @brief Checks if a collision occurred on the left side of an entity
  * @param e The primary entity
@@ -82,22 +105,9 @@ std::string GetTag(Entity entity) {
  * @return true if the collision is on the left side, false otherwise
  */
 bool LeftCollision(Entity e, Entity other) {
-	const auto& eCollider = e.GetComponent<BoxColliderComponent>();
-	const auto& eTransform = e.GetComponent<TransformComponent>();
-	const auto& otherCollider = other.GetComponent<BoxColliderComponent>();
-	const auto& otherTransform = other.GetComponent<TransformComponent>();
-	float eX = eTransform.previousPosition.x;
-	float eY = eTransform.previousPosition.y;
-	float eH = static_cast<float>(eCollider.heigth);
-	float oX = otherTransform.previousPosition.x;
-	float oY = otherTransform.previousPosition.y;
-	float oH = static_cast<float>(otherCollider.heigth);
-	return (
-		oY < eY + eH &&
-		oY + oH > eY &&
-		oX < eX
-	);
-
+	const AABB eBox = GetPreviousBox(e);
+	const AABB oBox = GetPreviousBox(other);
+	return oBox.minY < eBox.maxY && oBox.maxY > eBox.minY && oBox.minX < eBox.minX;
 }
 
 /**
@@ -107,21 +117,9 @@ bool LeftCollision(Entity e, Entity other) {
  * @return true if the collision is on the right side, false otherwise
  */
 bool RightCollision(Entity e, Entity other) {
-	const auto& eCollider = e.GetComponent<BoxColliderComponent>();
-	const auto& eTransform = e.GetComponent<TransformComponent>();
-	const auto& otherCollider = other.GetComponent<BoxColliderComponent>();
-	const auto& otherTransform = other.GetComponent<TransformComponent>();
-	float eX = eTransform.previousPosition.x;
-	float eY = eTransform.previousPosition.y;
-	float eH = static_cast<float>(eCollider.heigth);
-	float oX = otherTransform.previousPosition.x;
-	float oY = otherTransform.previousPosition.y;
-	float oH = static_cast<float>(otherCollider.heigth);
-	return (
-		oY < eY + eH &&
-		oY + oH > eY &&
-		oX > eX
-		);
+	const AABB eBox = GetPreviousBox(e);
+	const AABB oBox = GetPreviousBox(other);
+	return oBox.minY < eBox.maxY && oBox.maxY > eBox.minY && oBox.minX > eBox.minX;
 }
 
 /**
@@ -131,24 +129,9 @@ bool RightCollision(Entity e, Entity other) {
  * @return true if the collision is on the bottom side, false otherwise
  */
 bool BottomCollision(Entity e, Entity other) {
-	const auto& eCollider = e.GetComponent<BoxColliderComponent>();
-	const auto& eTransform = e.GetComponent<TransformComponent>();
-	const auto& otherCollider = other.GetComponent<BoxColliderComponent>();
-	const auto& otherTransform = other.GetComponent<TransformComponent>();
-
-	float eX = eTransform.previousPosition.x;
-	float eY = eTransform.previousPosition.y;
-	float eW = static_cast<float>(eCollider.width);
-
-	float oX = otherTransform.previousPosition.x;
-	float oY = otherTransform.previousPosition.y;
-	float oW = static_cast<float>(otherCollider.width);
-
-	return (
-		oX < eX + eW &&
-		oX + oW > eX &&
-		oY > eY
-		);
+	const AABB eBox = GetPreviousBox(e);
+	const AABB oBox = GetPreviousBox(other);
+	return oBox.minX < eBox.maxX && oBox.maxX > eBox.minX && oBox.minY > eBox.minY;
 }
 
 /**
@@ -158,25 +141,83 @@ bool BottomCollision(Entity e, Entity other) {
  * @return true if the collision is on the top side, false otherwise
  */
 bool TopCollision(Entity e, Entity other) {
-	const auto& eCollider = e.GetComponent<BoxColliderComponent>();
-	const auto& eTransform = e.GetComponent<TransformComponent>();
-	const auto& otherCollider = other.GetComponent<BoxColliderComponent>();
-	const auto& otherTransform = other.GetComponent<TransformComponent>();
+	const AABB eBox = GetPreviousBox(e);
+	const AABB oBox = GetPreviousBox(other);
+	return oBox.minX < eBox.maxX && oBox.maxX > eBox.minX && oBox.maxY < eBox.minY;
+}
+
+// Consultas espaciales
+
+/**
+ * @brief Finds the colliders that overlap or touch a rectangle
+ * @param x The x-coordinate of the top-left corner
+ * @param y The y-coordinate of the top-left corner
+ * @param w The width of the rectangle
+ * @param h The height of the rectangle
+ * @param mask The collision layers to search, all of them if omitted
+ * @return A table with the entities found
+ */
+sol::as_table_t<std::vector<Entity>> QueryAABB(float x, float y, float w, float h, sol::optional<unsigned int> mask) {
+	AABB box;
+	box.minX = x;
+	box.minY = y;
+	box.maxX = x + w;
+	box.maxY = y + h;
+	std::vector<Entity> result;
+	Game::GetInstance().registry->GetSystem<BoxCollisionSystem>().QueryBox(box, mask.value_or(LAYER_ALL), result);
+	return sol::as_table(std::move(result));
+}
 
-	float eX = eTransform.previousPosition.x;
-	float eY = eTransform.previousPosition.y;
-	float eW = static_cast<float>(eCollider.width);
+/**
+ * @brief Finds the colliders that overlap or touch a circle
+ * @param x The x-coordinate of the center
+ * @param y The y-coordinate of the center
+ * @param radius The radius of the circle
+ * @param mask The collision layers to search, all of them if omitted
+ * @return A table with the entities found
+ */
+sol::as_table_t<std::vector<Entity>> QueryRadius(float x, float y, float radius, sol::optional<unsigned int> mask) {
+	std::vector<Entity> result;
+	Game::GetInstance().registry->GetSystem<BoxCollisionSystem>().QueryRadius(x, y, radius, mask.value_or(LAYER_ALL), result);
+	return sol::as_table(std::move(result));
+}
 
-	float oX = otherTransform.previousPosition.x;
-	float oY = otherTransform.previousPosition.y;
-	float oW = static_cast<float>(otherCollider.width);
-	float oH = static_cast<float>(otherCollider.heigth);
+/**
+ * @brief Finds the first collider along a segment
+ * @param x0 The x-coordinate of the start of the segment
+ * @param y0 The y-coordinate of the start of the segment
+ * @param x1 The x-coordinate of the end of the segment
+ * @param y1 The y-coordinate of the end of the segment
+ * @param mask The collision layers the segment can hit, all of them if omitted
+ * @return The entity hit, or nil, and the point where the segment stops
+ */
+std::tuple<sol::object, float, float> Raycast(float x0, float y0, float x1, float y1, sol::optional<unsigned int> mask) {
+	Game& game = Game::GetInstance();
+	RaycastHit hit;
+	if (!game.registry->GetSystem<BoxCollisionSystem>().Raycast(x0, y0, x1, y1, mask.value_or(LAYER_ALL), hit)) {
+		return { sol::make_object(game.lua, sol::lua_nil), x1, y1 };
+	}
+	return { sol::make_object(game.lua, hit.entity), hit.x, hit.y };
+}
 
-	return (
-		oX < eX + eW &&
-		oX + oW > eX &&
-		oY + oH < eY
-		);
+/**
+ * @brief Finds the entity with a tag whose collider is closest to an entity
+ * @param entity The entity searching, measured from the center of its collider
+ * @param tag The tag to search for
+ * @return The closest entity other than the one searching, or nil
+ */
+sol::object Nearest(Entity entity, const std::string& tag) {
+	Game& game = Game::GetInstance();
+	glm::vec2 center = entity.GetComponent<TransformComponent>().position;
+	if (entity.HasComponent<BoxColliderComponent>()) {
+		const auto& collider = entity.GetComponent<BoxColliderComponent>();
+		center += glm::vec2(collider.width, collider.heigth) * 0.5f;
+	}
+	Entity nearest;
+	if (!game.registry->GetSystem<BoxCollisionSystem>().Nearest(center.x, center.y, tag, entity, nearest)) {
+		return sol::make_object(game.lua, sol::lua_nil);
+	}
+	return sol::make_object(game.lua, nearest);
 }
 
 /**
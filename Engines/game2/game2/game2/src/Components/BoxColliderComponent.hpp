@@ -6,6 +6,7 @@
 #ifndef BOXCOLLIDERCOMPONENT_HPP
 #define BOXCOLLIDERCOMPONENT_HPP
 #include <glm/glm.hpp>
+#include "CollisionLayer.hpp"
 
 /**
  * @struct BoxColliderComponent
@@ -13,27 +14,35 @@
  * 
  * This component provides rectangular collision detection capabilities by defining
  * a bounding box with customizable dimensions and offset from the entity's position.
- * It's used by the physics system to detect collisions between entities.
+ * It's used by the physics system to detect collisions between entities. The
+ * layer and mask select which other colliders it can collide with.
  */
 struct BoxColliderComponent {
     int width;           ///< Width of the collision box in pixels
     int heigth;          ///< Height of the collision box in pixels
     glm::vec2 offset;    ///< Offset from the entity's position to the collision box origin
+    unsigned int layer;  ///< Collision layer bit of the collider
+    unsigned int mask;   ///< Collision layers this collider collides with
     
     /**
      * @brief Constructor for BoxColliderComponent
      * @param width Width of the collision box in pixels (default: 0)
      * @param heigth Height of the collision box in pixels (default: 0)
      * @param offset Offset vector from entity position to collision box origin (default: (0,0))
+     * @param layer Collision layer bit of the collider (default: LAYER_DEFAULT)
+     * @param mask Collision layers the collider collides with (default: LAYER_ALL)
      * 
      * The offset allows the collision box to be positioned relative to the entity's
      * transform position, enabling fine-tuned collision detection that may not
      * align perfectly with the visual sprite.
      */
-    BoxColliderComponent(int width = 0, int heigth = 0, glm::vec2 offset = glm::vec2(0)) {
+    BoxColliderComponent(int width = 0, int heigth = 0, glm::vec2 offset = glm::vec2(0),
+                         unsigned int layer = LAYER_DEFAULT, unsigned int mask = LAYER_ALL) {
         this->width = width;
         this->heigth = heigth;
         this->offset = offset;
+        this->layer = layer;
+        this->mask = mask;
     }
 };
 
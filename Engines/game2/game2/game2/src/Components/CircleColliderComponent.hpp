@@ -5,6 +5,7 @@
 
 #ifndef CIRCLECOLLIDERCOMPONENT_HPP
 #define CIRCLECOLLIDERCOMPONENT_HPP
+#include "CollisionLayer.hpp"
 
 /**
  * @struct CircleColliderComponent
@@ -12,23 +13,31 @@
  * 
  * This component provides circular collision detection capabilities by defining
  * a collision circle with a specified radius. The width and height parameters
- * may be used for additional collision calculations or rendering purposes.
+ * may be used for additional collision calculations or rendering purposes. The
+ * layer and mask select which other colliders it can collide with.
  */
 struct CircleColliderComponent {
     int radius;    ///< Radius of the circular collision area in pixels
     int width;     ///< Width parameter for collision calculations
     int height;    ///< Height parameter for collision calculations
+    unsigned int layer;  ///< Collision layer bit of the collider
+    unsigned int mask;   ///< Collision layers this collider collides with
     
     /**
      * @brief Constructor for CircleColliderComponent
      * @param radius Radius of the circular collision area in pixels (default: 0)
      * @param width Width parameter for collision calculations (default: 0)
      * @param height Height parameter for collision calculations (default: 0)
+     * @param layer Collision layer bit of the collider (default: LAYER_DEFAULT)
+     * @param mask Collision layers the collider collides with (default: LAYER_ALL)
      */
-    CircleColliderComponent(int radius = 0, int width = 0, int height = 0) {
+    CircleColliderComponent(int radius = 0, int width = 0, int height = 0,
+                            unsigned int layer = LAYER_DEFAULT, unsigned int mask = LAYER_ALL) {
         this->radius = radius;
         this->width = width;
         this->height = height;
+        this->layer = layer;
+        this->mask = mask;
     }
 };
 
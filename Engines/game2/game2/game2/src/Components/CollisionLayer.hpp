@@ -0,0 +1,25 @@
+/**
+ * @file CollisionLayer.hpp
+ * @brief Collision layer bits shared by the collider components
+ */
+
+#ifndef COLLISIONLAYER_HPP
+#define COLLISIONLAYER_HPP
+
+/**
+ * @enum CollisionLayer
+ * @brief Collision layers of the game, one bit each
+ *
+ * Every collider belongs to one layer and has a mask with the layers it can
+ * collide with. A pair is only tested when each collider has the layer of the
+ * other one in its mask. Scene scripts use the same values through the
+ * collision_layer table.
+ */
+enum CollisionLayer : unsigned int {
+    LAYER_DEFAULT = 1u << 0,   ///< Colliders that do not set a layer
+    LAYER_WORLD = 1u << 1,     ///< Solid level colliders loaded from the map
+    LAYER_TRIGGER = 1u << 2,   ///< Level areas that do not block movement, like doors
+    LAYER_ALL = 0xFFFFFFFFu    ///< Mask that collides with every layer
+};
+
+#endif // !COLLISIONLAYER_HPP
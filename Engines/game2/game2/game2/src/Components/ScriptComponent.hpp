@@ -5,6 +5,7 @@
 
 #ifndef SCRIPTCOMPONENT_HPP
 #define SCRIPTCOMPONENT_HPP
+#include <utility>
 #include <sol/sol.hpp>
 
 /**
@@ -18,7 +19,10 @@
  */
 struct ScriptComponent {
     sol::function update;              ///< Lua function called every frame for general updates
-    sol::function onCollision;         ///< Lua function called when collision events occur
+    sol::function onCollision;         ///< Lua function called every frame while colliding
+    sol::function onCollisionEnter;    ///< Lua function called when a collision starts
+    sol::function onCollisionStay;     ///< Lua function called every frame after the first one while colliding
+    sol::function onCollisionExit;     ///< Lua function called when a collision ends
     sol::function onClick;             ///< Lua function called when entity is clicked
     sol::function enemy_pig_update;    ///< Lua function for pig enemy-specific update behavior
     sol::function enemy_turtle_update; ///< Lua function for turtle enemy-specific update behavior
@@ -32,19 +36,26 @@ struct ScriptComponent {
      * @param enemy_pig_update Lua function for pig enemy behavior (default: sol::lua_nil)
      * @param enemy_turtle_update Lua function for turtle enemy behavior (default: sol::lua_nil)
      * @param enemy_bird_update Lua function for bird enemy behavior (default: sol::lua_nil)
+     * @param onCollisionEnter Lua function called when a collision starts (default: sol::lua_nil)
+     * @param onCollisionStay Lua function called while a collision continues (default: sol::lua_nil)
+     * @param onCollisionExit Lua function called when a collision ends (default: sol::lua_nil)
      * 
      * All parameters default to sol::lua_nil, meaning no script function is assigned.
      * Functions can be set individually as needed for the specific entity's behavior.
      * The scripting system will only call functions that are not nil.
      */
     ScriptComponent(sol::function onCollision = sol::lua_nil, sol::function update = sol::lua_nil, sol::function onClick = sol::lua_nil,
-                    sol::function enemy_pig_update = sol::lua_nil, sol::function enemy_turtle_update = sol::lua_nil, sol::function enemy_bird_update = sol::lua_nil) {
-        this->update = update;
-        this->onClick = onClick;
-        this->onCollision = onCollision;
-        this->enemy_pig_update = enemy_pig_update;
-        this->enemy_turtle_update = enemy_turtle_update;
-        this->enemy_bird_update = enemy_bird_update;
+                    sol::function enemy_pig_update = sol::lua_nil, sol::function enemy_turtle_update = sol::lua_nil, sol::function enemy_bird_update = sol::lua_nil,
+                    sol::function onCollisionEnter = sol::lua_nil, sol::function onCollisionStay = sol::lua_nil, sol::function onCollisionExit = sol::lua_nil) {
+        this->update = std::move(update);
+        this->onClick = std::move(onClick);
+        this->onCollision = std::move(onCollision);
+        this->enemy_pig_update = std::move(enemy_pig_update);
+        this->enemy_turtle_update = std::move(enemy_turtle_update);
+        this->enemy_bird_update = std::move(enemy_bird_update);
+        this->onCollisionEnter = std::move(onCollisionEnter);
+        this->onCollisionStay = std::move(onCollisionStay);
+        this->onCollisionExit = std::move(onCollisionExit);
     }
 };
 
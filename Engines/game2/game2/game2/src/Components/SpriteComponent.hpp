@@ -7,6 +7,7 @@
 #define SPRITECOMPONENT_HPP
 #include <SDL2/SDL.h>
 #include <string>
+#include <utility>
 
 /**
  * @struct SpriteComponent
@@ -36,9 +37,9 @@ struct SpriteComponent {
      * dimensions and coordinates. This is useful for sprite sheets where only a
      * portion of the texture should be displayed.
      */
-    SpriteComponent(const std::string& textureId = "none", int width = 0,
+    SpriteComponent(std::string textureId = "none", int width = 0,
                     int height = 0, int srcRectX = 0, int srcRectY = 0) {
-        this->textureId = textureId;
+        this->textureId = std::move(textureId);
         this->width = width;
         this->height = height;
         this->srcRect = {srcRectX, srcRectY, width, height};
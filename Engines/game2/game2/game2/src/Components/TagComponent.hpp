@@ -1,6 +1,7 @@
 #ifndef TAGCOMPONENT_HPP
 #define TAGCOMPONENT_HPP
 #include <string>
+#include <utility>
 
 /**
  * @brief A component that holds a string tag for identification purposes.
@@ -19,8 +20,8 @@ struct TagComponent {
      * 
      * @param tag The tag string to assign to this component. Defaults to empty string.
      */
-    TagComponent(const std::string& tag = "") {
-        this->tag = tag;
+    TagComponent(std::string tag = "") {
+        this->tag = std::move(tag);
     }
 };
 #endif // !TAGCOMPONENT_HPP
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define TEXTCOMPONENT_HPP
 #include <SDL2/SDL.h>
 #include <string>
+#include <utility>
 
 /**
  * @brief A component that holds text rendering information.
@@ -46,9 +47,9 @@ struct TextComponent {
      * @param b The blue component of the text color (0-255). Defaults to 0.
      * @param a The alpha component of the text color (0-255). Defaults to 0.
      */
-    TextComponent(const std::string& text = "", const std::string& fontId = "", uint8_t r = 0, uint8_t g = 0, uint8_t b = 0, uint8_t a = 0) {
-        this->text = text;
-        this->fontId = fontId;
+    TextComponent(std::string text = "", std::string fontId = "", uint8_t r = 0, uint8_t g = 0, uint8_t b = 0, uint8_t a = 0) {
+        this->text = std::move(text);
+        this->fontId = std::move(fontId);
         this->textColor.r = r;
         this->textColor.g = g;
         this->textColor.b = b;
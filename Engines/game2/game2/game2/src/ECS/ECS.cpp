@@ -1,19 +1,29 @@
 #include <algorithm>
+#include <cstdlib>
 
 #include "ECS.hpp"
 
 int IComponent::nextId = 0;
 
-Entity::Entity(){}
+Entity::Entity()
+{
+	this->handle = ENTITY_INDEX_MASK;
+}
 
-Entity::Entity(int id)
+Entity::Entity(int id, std::uint32_t version)
 {
-	this->id = id;
+	this->handle = (static_cast<std::uint32_t>(id) & ENTITY_INDEX_MASK)
+		| ((version & ENTITY_VERSION_MASK) << ENTITY_INDEX_BITS);
 }
 
 int Entity::GetId() const
 {
-	return this->id;
+	return static_cast<int>(this->handle & ENTITY_INDEX_MASK);
+}
+
+std::uint32_t Entity::GetVersion() const
+{
+	return this->handle >> ENTITY_INDEX_BITS;
 }
 
 void Entity::Kill()
@@ -21,16 +31,36 @@ void Entity::Kill()
 	registry->KillEntity(*this);
 }
 
+bool Entity::IsAlive() const
+{
+	return registry && registry->CheckIfEntityIsAlive(*this);
+}
+
 void System::AddEntityToSystem(Entity entity)
 {
+	const int entityId = entity.GetId();
+	if (static_cast<size_t>(entityId) >= entityIdToIndex.size()) {
+		entityIdToIndex.resize(entityId + 100, -1);
+	}
+	entityIdToIndex[entityId] = static_cast<int>(entities.size());
 	entities.push_back(entity);
 }
 
 void System::RemoveEntityFromSystem(Entity entity)
 {
-	auto it = std::remove_if(entities.begin(), entities.end(),
-		[&entity](Entity other) { return entity == other; });
-	entities.erase(it, entities.end());
+	const int entityId = entity.GetId();
+	if (static_cast<size_t>(entityId) >= entityIdToIndex.size()) {
+		return;
+	}
+	const int index = entityIdToIndex[entityId];
+	if (index == -1 || entities[index] != entity) {
+		return;
+	}
+	const Entity last = entities.back();
+	entities[index] = last;
+	entityIdToIndex[last.GetId()] = index;
+	entities.pop_back();
+	entityIdToIndex[entityId] = -1;
 }
 
 std::vector<Entity> System::GetSystemEntiities() const
@@ -43,6 +73,26 @@ const Signature& System::GetComponentSignature() const
 	return componentSignature;
 }
 
+const Signature& System::GetReadSignature() const
+{
+	return readSignature;
+}
+
+const Signature& System::GetWriteSignature() const
+{
+	return writeSignature;
+}
+
+void System::SetExclusive(bool exclusive)
+{
+	this->exclusive = exclusive;
+}
+
+bool System::IsExclusive() const
+{
+	return exclusive;
+}
+
 Registry::Registry()
 {
 	std::cout << "REGISTRY se ejecuta constructor" << std::endl;
@@ -59,10 +109,22 @@ void Registry::Update()
 		AddEntityToSystems(entity);
 	}
 	entitiesToBeAdded.clear();
+	std::sort(entitiesToBeKilled.begin(), entitiesToBeKilled.end(), [](Entity a, Entity b) {
+		return a.GetId() < b.GetId();
+	});
 	for (auto entity : entitiesToBeKilled) {
+		const int entityId = entity.GetId();
 		RemoveEntityFromSystems(entity);
-		entityComponentSignatures[entity.GetId()].reset();
-		freeIds.push_back(entity.GetId());
+		RefreshArchetypes(entityId, Signature());
+		for (auto& pool : componentsPools) {
+			if (pool) {
+				pool->RemoveEntityFromPool(entityId);
+			}
+		}
+		entityComponentSignatures[entityId].reset();
+		entityVersions[entityId] = (entityVersions[entityId] + 1) & ENTITY_VERSION_MASK;
+		entityPendingKill[entityId].marked.store(false, std::memory_order_relaxed);
+		freeIds.push_back(entityId);
 	}
 	entitiesToBeKilled.clear();
 }
@@ -71,51 +133,109 @@ Entity Registry::CreateEntity()
 {
 	int entityId;
 	if (freeIds.empty()) {
+		// The last index is the null handle, and higher ones would alias lower ones through the mask
+		if (static_cast<std::uint32_t>(numEntity) >= ENTITY_INDEX_MASK) {
+			std::cerr << "[Registry] No quedan indices libres para crear entidades" << std::endl;
+			std::abort();
+		}
 		entityId = numEntity++;
 		if (static_cast<long unsigned int>(entityId) >= entityComponentSignatures.size()) {
 			entityComponentSignatures.resize(entityId + 100);
 		}
+		if (static_cast<long unsigned int>(entityId) >= entityVersions.size()) {
+			entityVersions.resize(entityId + 100, 0);
+			entityPendingKill.resize(entityId + 100);
+			entityCreationOrder.resize(entityId + 100, 0);
+		}
 	}
 	else {
 		entityId = freeIds.front();
 		freeIds.pop_front();
 	}
-	Entity entity(entityId);
+	entityCreationOrder[entityId] = nextCreationOrder++;
+	Entity entity(entityId, entityVersions[entityId]);
 	entity.registry = this;
-	entitiesToBeAdded.insert(entity);
+	entitiesToBeAdded.push_back(entity);
 	return entity;
 }
 
+std::uint64_t Registry::GetCreationOrder(Entity entity) const
+{
+	return entityCreationOrder[entity.GetId()];
+}
+
 void Registry::KillEntity(Entity entity)
 {
-	entitiesToBeKilled.insert(entity);
+	std::lock_guard<std::mutex> lock(killMutex);
+	if (!CheckIfEntityIsAlive(entity)) {
+		return;
+	}
+	entityPendingKill[entity.GetId()].marked.store(true, std::memory_order_relaxed);
+	entitiesToBeKilled.push_back(entity);
+}
+
+bool Registry::CheckIfEntityIsAlive(Entity entity) const
+{
+	const int entityId = entity.GetId();
+	return static_cast<size_t>(entityId) < entityVersions.size()
+		&& entityVersions[entityId] == entity.GetVersion()
+		&& !entityPendingKill[entityId].marked.load(std::memory_order_relaxed);
+}
+
+Entity Registry::GetEntity(int entityId)
+{
+	Entity entity(entityId, entityVersions[entityId]);
+	entity.registry = this;
+	return entity;
 }
 
 void Registry::AddEntityToSystems(Entity entity)
 {
 	const int entityId = entity.GetId();
 	const auto& entityComponentSignature = entityComponentSignatures[entityId];
-	for (auto& system : systems) {
-		const auto& systemComponentSignature = system.second->GetComponentSignature();
-		bool isInterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
-		if (isInterested) {
-			system.second->AddEntityToSystem(entity);
+	auto interestedSystems = systemsBySignature.find(entityComponentSignature);
+	if (interestedSystems == systemsBySignature.end()) {
+		std::vector<System*> matches;
+		for (auto& system : systems) {
+			const auto& systemComponentSignature = system.second->GetComponentSignature();
+			bool isInterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
+			if (isInterested) {
+				matches.push_back(system.second.get());
+			}
 		}
+		interestedSystems = systemsBySignature.emplace(entityComponentSignature, std::move(matches)).first;
+	}
+	for (System* system : interestedSystems->second) {
+		system->AddEntityToSystem(entity);
 	}
 }
 
 void Registry::RemoveEntityFromSystems(Entity entity)
 {
-	for (auto system : systems) {
+	for (auto& system : systems) {
 		system.second->RemoveEntityFromSystem(entity);
 	}
 }
 
+void Registry::RefreshArchetypes(int entityId, const Signature& entitySignature)
+{
+	for (auto& archetype : archetypes) {
+		archetype.second->Refresh(entityId, entitySignature);
+	}
+}
+
 void Registry::ClearAllEntities()
 {
 	for (int i = 0; i < numEntity; i++) {
-		RemoveEntityFromSystems(Entity(i));
+		RemoveEntityFromSystems(Entity(i, entityVersions[i]));
 		entityComponentSignatures[i].reset();
+		entityVersions[i] = (entityVersions[i] + 1) & ENTITY_VERSION_MASK;
+		entityPendingKill[i].marked.store(false, std::memory_order_relaxed);
+	}
+	entitiesToBeAdded.clear();
+	entitiesToBeKilled.clear();
+	for (auto& archetype : archetypes) {
+		archetype.second->Clear();
 	}
 	componentsPools.clear();
 	entityComponentSignatures.clear();
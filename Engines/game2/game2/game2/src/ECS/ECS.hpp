@@ -2,16 +2,22 @@
 #define ECS_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <atomic>
 #include <bitset>
+#include <cassert>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <set>
 #include <deque>
 #include <typeindex>
+#include <tuple>
 #include <iostream>
+#include <mutex>
 
 #include "../Utils/Pool.hpp"
+#include "../JobSystem/JobSystem.hpp"
 
 /**
  * @brief Maximum number of components that can be registered in the ECS.
@@ -23,6 +29,24 @@ const unsigned int MAX_COMPONENTS = 64;
  */
 typedef std::bitset<MAX_COMPONENTS> Signature;
 
+/**
+ * @brief Number of bits of an entity handle that hold the entity index.
+ * 
+ * The remaining high bits hold the version of the index, which is bumped
+ * every time an entity using it is destroyed.
+ */
+const unsigned int ENTITY_INDEX_BITS = 20;
+
+/**
+ * @brief Mask selecting the index bits of an entity handle.
+ */
+const std::uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+
+/**
+ * @brief Mask selecting the version once shifted out of an entity handle.
+ */
+const std::uint32_t ENTITY_VERSION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+
 /**
  * @brief Base interface for all components in the ECS.
  * 
@@ -62,8 +86,10 @@ public:
 /**
  * @brief Represents an entity in the ECS system.
  * 
- * An entity is a unique identifier that can have components attached to it.
- * It provides methods for managing its components through the registry.
+ * An entity is a 32-bit handle made of an index, used to look up its
+ * components, and the version of that index when the entity was created.
+ * Indices are recycled after an entity is destroyed, but the version is not,
+ * so an old copy of a destroyed entity never aliases the new one.
  */
 class Entity {
 public:
@@ -73,55 +99,70 @@ public:
 	Entity();
 	
 	/**
-	 * @brief Constructs an Entity with a specific ID.
+	 * @brief Constructs an Entity from an index and its version.
 	 * 
-	 * @param id The unique identifier for this entity.
+	 * @param id The index of this entity.
+	 * @param version The version of the index this entity was created with.
 	 */
-	Entity(int id);
+	Entity(int id, std::uint32_t version = 0);
 	
 	/**
-	 * @brief Gets the unique ID of this entity.
+	 * @brief Gets the index of this entity.
 	 * 
-	 * @return The entity's unique identifier.
+	 * @return The entity's index, used to look up its components.
 	 */
 	int GetId() const;
+
+	/**
+	 * @brief Gets the version of this entity's index.
+	 * 
+	 * @return The version the index had when this entity was created.
+	 */
+	std::uint32_t GetVersion() const;
 	
 	/**
 	 * @brief Marks this entity for destruction.
 	 */
 	void Kill();
+
+	/**
+	 * @brief Checks if this entity still exists and is not marked for destruction.
+	 * 
+	 * @return True if the entity is alive, false otherwise.
+	 */
+	bool IsAlive() const;
 	
 	/**
 	 * @brief Equality comparison operator.
 	 * 
 	 * @param other The entity to compare with.
-	 * @return True if entities have the same ID, false otherwise.
+	 * @return True if entities have the same handle, false otherwise.
 	 */
-	bool operator ==(const Entity& other) const { return id == other.id; };
+	bool operator ==(const Entity& other) const { return handle == other.handle; };
 	
 	/**
 	 * @brief Inequality comparison operator.
 	 * 
 	 * @param other The entity to compare with.
-	 * @return True if entities have different IDs, false otherwise.
+	 * @return True if entities have different handles, false otherwise.
 	 */
-	bool operator !=(const Entity& other) const { return id != other.id; };
+	bool operator !=(const Entity& other) const { return handle != other.handle; };
 	
 	/**
 	 * @brief Less than comparison operator.
 	 * 
 	 * @param other The entity to compare with.
-	 * @return True if this entity's ID is less than the other's.
+	 * @return True if this entity's handle is less than the other's.
 	 */
-	bool operator<(const Entity& other) const { return id < other.id; };
+	bool operator<(const Entity& other) const { return handle < other.handle; };
 	
 	/**
 	 * @brief Greater than comparison operator.
 	 * 
 	 * @param other The entity to compare with.
-	 * @return True if this entity's ID is greater than the other's.
+	 * @return True if this entity's handle is greater than the other's.
 	 */
-	bool operator>(const Entity& other) const { return id > other.id; };
+	bool operator>(const Entity& other) const { return handle > other.handle; };
 	
 	/**
 	 * @brief Adds a component to this entity.
@@ -165,12 +206,20 @@ public:
 	/**
 	 * @brief Pointer to the registry that manages this entity.
 	 */
-	class Registry* registry;
+	class Registry* registry = nullptr;
 private:
 	/**
-	 * @brief The unique identifier for this entity.
+	 * @brief Index in the low bits and version in the high bits.
 	 */
-	int id;
+	std::uint32_t handle;
+};
+
+/**
+ * @brief How a system accesses a component type.
+ */
+enum class ComponentAccess {
+	Read,
+	Write
 };
 
 /**
@@ -201,6 +250,9 @@ public:
 	/**
 	 * @brief Removes an entity from this system.
 	 * 
+	 * Runs in constant time by moving the last entity into the freed slot,
+	 * so the order of the remaining entities may change.
+	 * 
 	 * @param entity The entity to remove from the system.
 	 */
 	void RemoveEntityFromSystem(Entity entity);
@@ -211,6 +263,21 @@ public:
 	 * @return Vector of entities that belong to this system.
 	 */
 	std::vector<Entity> GetSystemEntiities() const;
+
+	/**
+	 * @brief Calls a function for every entity of this system, in chunks run in parallel.
+	 * 
+	 * Walks the entity list in place. The function may read and write the
+	 * components of the entity it gets and kill it, but must not create
+	 * entities or add or remove components.
+	 * 
+	 * @tparam TFunc Callable as func(Entity).
+	 * @param jobSystem The workers that run the chunks.
+	 * @param func The function to call for each entity.
+	 * @param chunkSize Number of entities per job.
+	 */
+	template <typename TFunc>
+	void ParallelForEach(JobSystem& jobSystem, TFunc func, int chunkSize = JobSystem::DEFAULT_CHUNK_SIZE) const;
 	
 	/**
 	 * @brief Gets the component signature for this system.
@@ -222,21 +289,308 @@ public:
 	/**
 	 * @brief Marks a component type as required for this system.
 	 * 
+	 * The component is also declared as accessed, for the scheduler. The
+	 * default is write access, which is always safe.
+	 * 
 	 * @tparam TComponent The component type to require.
+	 * @param access How the system accesses the component.
+	 */
+	template<typename TComponent>
+	void RequiredComponent(ComponentAccess access = ComponentAccess::Write);
+
+	/**
+	 * @brief Declares a component the system reads without requiring it.
+	 * 
+	 * @tparam TComponent The component type read by the system.
+	 */
+	template<typename TComponent>
+	void ReadComponent();
+
+	/**
+	 * @brief Declares a component the system writes without requiring it.
+	 * 
+	 * @tparam TComponent The component type written by the system.
 	 */
 	template<typename TComponent>
-	void RequiredComponent();
+	void WriteComponent();
+
+	/**
+	 * @brief Gets the components read by this system.
+	 * 
+	 * @return Signature of the components declared with read access.
+	 */
+	const Signature& GetReadSignature() const;
+
+	/**
+	 * @brief Gets the components written by this system.
+	 * 
+	 * @return Signature of the components declared with write access.
+	 */
+	const Signature& GetWriteSignature() const;
+
+	/**
+	 * @brief Sets whether the system must run alone on the main thread.
+	 * 
+	 * Systems are exclusive by default. A system may only clear the flag if
+	 * its declared components are everything it touches: no Lua, no events,
+	 * and no entity creation, killing or component addition.
+	 * 
+	 * @param exclusive True to run alone, false to allow running in parallel.
+	 */
+	void SetExclusive(bool exclusive);
+
+	/**
+	 * @brief Checks if the system must run alone on the main thread.
+	 * 
+	 * @return True if the system is exclusive, false otherwise.
+	 */
+	bool IsExclusive() const;
+
+	/**
+	 * @brief Pointer to the registry that owns this system.
+	 * 
+	 * Set by Registry::AddSystem so systems can build views over the
+	 * component pools.
+	 */
+	class Registry* registry = nullptr;
 private:
 	/**
 	 * @brief Bitset indicating which components are required by this system.
 	 */
 	Signature componentSignature;
+
+	/**
+	 * @brief Components the system reads.
+	 */
+	Signature readSignature;
+
+	/**
+	 * @brief Components the system writes.
+	 */
+	Signature writeSignature;
+
+	/**
+	 * @brief Whether the system must run alone on the main thread.
+	 */
+	bool exclusive = true;
 	
 	/**
 	 * @brief List of entities that belong to this system.
 	 */
 	std::vector<Entity> entities;
 
+	/**
+	 * @brief Position of each entity index in the entities list, or -1.
+	 */
+	std::vector<int> entityIdToIndex;
+
+};
+
+/**
+ * @brief Iterates the entities that own a given set of components.
+ * 
+ * A view reads the component pools directly: it walks the packed storage of
+ * the first component type and skips entities missing any of the others.
+ * Iterating allocates nothing and hands out references into the pools, so
+ * list the least common component first to visit the fewest entities.
+ * 
+ * Entities that gain the first component while iterating are not visited
+ * until the next pass.
+ * 
+ * @tparam TComponents The component types an entity must own.
+ */
+template <typename... TComponents>
+class View {
+public:
+	/**
+	 * @brief Constructs a view over the given pools.
+	 * 
+	 * @param registry The registry that owns the pools.
+	 * @param pools One pool per component type, or nullptr if it does not exist yet.
+	 */
+	View(class Registry* registry, Pool<TComponents>*... pools)
+		: registry(registry), pools(pools...) {}
+
+	/**
+	 * @brief Calls a function for every entity owning all the components.
+	 * 
+	 * @tparam TFunc Callable as func(Entity, TComponents&...).
+	 * @param func The function to call for each matching entity.
+	 */
+	template <typename TFunc>
+	void Each(TFunc func) const;
+
+	/**
+	 * @brief Same as Each, but splits the entities in chunks run in parallel.
+	 * 
+	 * The function may read and write the components it gets and kill the
+	 * entity, but must not create entities or add or remove components.
+	 * Each entity is visited once, so the result does not depend on the
+	 * number of workers as long as entities do not touch each other.
+	 * 
+	 * @tparam TFunc Callable as func(Entity, TComponents&...).
+	 * @param jobSystem The workers that run the chunks.
+	 * @param func The function to call for each matching entity.
+	 * @param chunkSize Number of pool slots per job.
+	 */
+	template <typename TFunc>
+	void ParallelEach(JobSystem& jobSystem, TFunc func, int chunkSize = JobSystem::DEFAULT_CHUNK_SIZE) const;
+
+	/**
+	 * @brief Gets a component of an entity matched by this view.
+	 * 
+	 * @tparam TComponent One of the view's component types.
+	 * @param entity An entity visited by this view.
+	 * @return Reference to the component inside its pool.
+	 */
+	template <typename TComponent>
+	TComponent& Get(Entity entity) const {
+		return std::get<Pool<TComponent>*>(pools)->Get(entity.GetId());
+	}
+
+private:
+	/**
+	 * @brief Registry assigned to the entities handed out by the view.
+	 */
+	class Registry* registry;
+
+	/**
+	 * @brief Typed pointers to the pools of each component type.
+	 */
+	std::tuple<Pool<TComponents>*...> pools;
+};
+
+/**
+ * @class IArchetype
+ * @brief Type-erased interface of an archetype.
+ * 
+ * Lets the registry keep every archetype packed without knowing its
+ * component types.
+ */
+class IArchetype {
+public:
+	/**
+	 * @brief Virtual destructor for proper cleanup of derived classes.
+	 */
+	virtual ~IArchetype() = default;
+
+	/**
+	 * @brief Packs or unpacks an entity after its components change.
+	 * 
+	 * @param entityId The index of the entity.
+	 * @param entitySignature The signature the entity has after the change.
+	 */
+	virtual void Refresh(int entityId, const Signature& entitySignature) = 0;
+
+	/**
+	 * @brief Forgets every packed entity.
+	 * 
+	 * Called when the registry destroys its pools.
+	 */
+	virtual void Clear() = 0;
+
+	/**
+	 * @brief Gets the components owned by the archetype.
+	 * 
+	 * @return The component signature of the archetype.
+	 */
+	const Signature& GetSignature() const { return signature; }
+
+protected:
+	/**
+	 * @brief Components owned by the archetype.
+	 */
+	Signature signature;
+};
+
+/**
+ * @class Archetype
+ * @brief Archetype storage for entities created with the same component set.
+ * 
+ * The archetype owns the pools of its component types and keeps every entity
+ * that has all of them packed at the front of each pool, in the same order.
+ * Those slots form one contiguous column per component, so Each walks them
+ * linearly without any sparse lookup.
+ * 
+ * Storage is still the regular Pool<T>: GetComponent, views and system
+ * signatures keep working on archetype entities. A component type can only
+ * be owned by one archetype.
+ * 
+ * @tparam TComponents The component types of the archetype.
+ */
+template <typename... TComponents>
+class Archetype : public IArchetype {
+public:
+	/**
+	 * @brief Constructs an empty archetype.
+	 * 
+	 * @param registry The registry that owns the pools.
+	 */
+	Archetype(class Registry* registry);
+
+	/**
+	 * @brief Packs the entity if it owns every component, unpacks it otherwise.
+	 * 
+	 * @param entityId The index of the entity.
+	 * @param entitySignature The signature the entity has after the change.
+	 */
+	void Refresh(int entityId, const Signature& entitySignature) override;
+
+	/**
+	 * @brief Forgets every packed entity.
+	 */
+	void Clear() override { size = 0; }
+
+	/**
+	 * @brief Calls a function for every entity of the archetype.
+	 * 
+	 * Killing entities is deferred and safe while iterating. Removing one of
+	 * the owned components reorders the packed slots and may skip an entity
+	 * until the next pass.
+	 * 
+	 * @tparam TFunc Callable as func(Entity, TComponents&...).
+	 * @param func The function to call for each entity.
+	 */
+	template <typename TFunc>
+	void Each(TFunc func) const;
+
+	/**
+	 * @brief Gets the number of packed entities.
+	 * 
+	 * @return The number of entities owning all the components.
+	 */
+	int GetSize() const { return size; }
+
+private:
+	/**
+	 * @brief Checks if an entity is inside the packed slots.
+	 * 
+	 * @param entityId The index of the entity.
+	 * @return True if the entity is packed, false otherwise.
+	 */
+	bool IsPacked(int entityId) const;
+
+	/**
+	 * @brief Moves the component of an entity to a slot of its pool.
+	 * 
+	 * @tparam TComponent The component type.
+	 * @param entityId The index of the entity.
+	 * @param slot The destination slot; its previous component takes the old slot.
+	 */
+	template <typename TComponent>
+	void MoveToSlot(int entityId, int slot) const;
+
+	/**
+	 * @brief Registry that owns the pools.
+	 */
+	class Registry* registry;
+
+	/**
+	 * @brief Number of packed entities.
+	 * 
+	 * Slots [0, size) of every owned pool belong to the archetype.
+	 */
+	int size = 0;
 };
 
 /**
@@ -265,6 +619,9 @@ public:
 	/**
 	 * @brief Creates a new entity in the registry.
 	 * 
+	 * At most ENTITY_INDEX_MASK entities can be alive at once, since the last
+	 * index is the null handle; creating one more aborts the program.
+	 * 
 	 * @return The newly created entity.
 	 */
 	Entity CreateEntity();
@@ -272,9 +629,44 @@ public:
 	/**
 	 * @brief Marks an entity for destruction.
 	 * 
+	 * Does nothing if the entity is already dead or marked. Safe to call
+	 * from parallel loops; the next Update destroys the marked entities in
+	 * index order, so the result does not depend on thread timing.
+	 * 
 	 * @param entity The entity to destroy.
 	 */
 	void KillEntity(Entity entity);
+
+	/**
+	 * @brief Checks if an entity exists and is not marked for destruction.
+	 * 
+	 * Compares the entity's version with the current version of its index,
+	 * so stale copies of destroyed entities are reported as dead.
+	 * 
+	 * @param entity The entity to check.
+	 * @return True if the entity is alive, false otherwise.
+	 */
+	bool CheckIfEntityIsAlive(Entity entity) const;
+
+	/**
+	 * @brief Gets when an entity was created relative to the others.
+	 * 
+	 * The value grows with every created entity and is never reused, not
+	 * even when the index of the entity is, so sorting by it gives the
+	 * creation order regardless of how the pools were reordered.
+	 * 
+	 * @param entity A live entity.
+	 * @return The creation order of the entity.
+	 */
+	std::uint64_t GetCreationOrder(Entity entity) const;
+
+	/**
+	 * @brief Gets the current entity using an index.
+	 * 
+	 * @param entityId The index of the entity.
+	 * @return The entity handle with the index's current version.
+	 */
+	Entity GetEntity(int entityId);
 	
 	/**
 	 * @brief Adds a component to an entity.
@@ -318,6 +710,35 @@ public:
 	 */
 	template < typename TComponent, typename... TArgs >
 	TComponent& GetComponent(Entity entity) const;
+
+	/**
+	 * @brief Creates a view over the entities owning all the given components.
+	 * 
+	 * @tparam TComponents The component types to iterate.
+	 * @return A view reading the component pools directly.
+	 */
+	template <typename... TComponents>
+	View<TComponents...> GetView();
+
+	/**
+	 * @brief Registers archetype storage for a set of components.
+	 * 
+	 * Entities that already own every component are packed right away.
+	 * Registering the same archetype twice does nothing.
+	 * 
+	 * @tparam TComponents The component types; none may belong to another archetype.
+	 */
+	template <typename... TComponents>
+	void RegisterArchetype();
+
+	/**
+	 * @brief Gets a registered archetype.
+	 * 
+	 * @tparam TComponents The component types, in the order used to register it.
+	 * @return Reference to the archetype.
+	 */
+	template <typename... TComponents>
+	Archetype<TComponents...>& GetArchetype() const;
 	
 	/**
 	 * @brief Adds a system to the registry.
@@ -375,15 +796,38 @@ public:
 	void ClearAllEntities();
 
 private:
+	template <typename... TComponents>
+	friend class Archetype;
+
+	/**
+	 * @brief Packs or unpacks an entity in every registered archetype.
+	 * 
+	 * @param entityId The index of the entity.
+	 * @param entitySignature The signature the entity has after the change.
+	 */
+	void RefreshArchetypes(int entityId, const Signature& entitySignature);
+
+	/**
+	 * @brief Gets the typed pool of a component type without touching its refcount.
+	 * 
+	 * @tparam TComponent The component type.
+	 * @return Pointer to the pool, or nullptr if no entity ever had the component.
+	 */
+	template <typename TComponent>
+	Pool<TComponent>* GetComponentPool() const;
+
 	/**
 	 * @brief Counter for the total number of entities created.
 	 */
 	int numEntity = 0;
 	
 	/**
-	 * @brief Storage pools for all component types.
+	 * @brief Storage pools for all component types, indexed by component ID.
+	 * 
+	 * The registry is the only owner, so pools are held by unique_ptr and
+	 * accessed through raw typed pointers without refcount traffic.
 	 */
-	std::vector<std::shared_ptr<IPool>> componentsPools;
+	std::vector<std::unique_ptr<IPool>> componentsPools;
 	
 	/**
 	 * @brief Component signatures for each entity.
@@ -396,26 +840,205 @@ private:
 	std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
 
 	/**
-	 * @brief Set of entities waiting to be added to systems.
+	 * @brief Systems interested in each entity signature seen so far.
+	 * 
+	 * Filled lazily by AddEntityToSystems and dropped whenever the set of
+	 * systems changes, so entities sharing a signature skip the matching.
 	 */
-	std::set<Entity> entitiesToBeAdded;
+	std::unordered_map<Signature, std::vector<System*>> systemsBySignature;
+
+	/**
+	 * @brief Registered archetypes indexed by their type.
+	 */
+	std::unordered_map<std::type_index, std::unique_ptr<IArchetype>> archetypes;
+
+	/**
+	 * @brief Components owned by any archetype.
+	 */
+	Signature archetypeComponents;
+
+	/**
+	 * @brief Entities waiting to be added to systems, in creation order.
+	 */
+	std::vector<Entity> entitiesToBeAdded;
 	
 	/**
-	 * @brief Set of entities waiting to be destroyed.
+	 * @brief Entities waiting to be destroyed.
+	 * 
+	 * KillEntity only queues live entities, so each appears once.
 	 */
-	std::set<Entity> entitiesToBeKilled;
+	std::vector<Entity> entitiesToBeKilled;
+
+	/**
+	 * @brief Guards the kill queue against kills from parallel loops.
+	 */
+	std::mutex killMutex;
 
 	/**
 	 * @brief Queue of entity IDs available for reuse.
 	 */
 	std::deque<int> freeIds;
+
+	/**
+	 * @brief Current version of each entity index.
+	 * 
+	 * Kept across ClearAllEntities so handles from a previous scene stay dead.
+	 */
+	std::vector<std::uint32_t> entityVersions;
+
+	/**
+	 * @brief Kill mark of an entity index.
+	 * 
+	 * KillEntity sets it from parallel loops while CheckIfEntityIsAlive reads
+	 * it without the kill lock, so each mark is its own atomic byte instead
+	 * of a bit shared with its neighbours. The copy constructor only lets the
+	 * vector grow, which CreateEntity does on the main thread.
+	 */
+	struct PendingKillFlag {
+		std::atomic<bool> marked{ false };
+		PendingKillFlag() = default;
+		PendingKillFlag(const PendingKillFlag& other) : marked(other.marked.load(std::memory_order_relaxed)) {}
+	};
+
+	/**
+	 * @brief Whether each entity index is marked for destruction.
+	 */
+	std::vector<PendingKillFlag> entityPendingKill;
+
+	/**
+	 * @brief Creation order of the entity at each index.
+	 */
+	std::vector<std::uint64_t> entityCreationOrder;
+
+	/**
+	 * @brief Creation order given to the next created entity.
+	 */
+	std::uint64_t nextCreationOrder = 0;
 };
 
+template<typename ...TComponents>
+template<typename TFunc>
+void View<TComponents...>::Each(TFunc func) const
+{
+	if (!(std::get<Pool<TComponents>*>(pools) && ...)) {
+		return;
+	}
+	auto* leadPool = std::get<0>(pools);
+	const int size = leadPool->GetSize();
+	for (int i = 0; i < size; i++) {
+		const int entityId = leadPool->GetEntityId(i);
+		if (!(std::get<Pool<TComponents>*>(pools)->Has(entityId) && ...)) {
+			continue;
+		}
+		func(registry->GetEntity(entityId), std::get<Pool<TComponents>*>(pools)->Get(entityId)...);
+	}
+}
+
+template<typename ...TComponents>
+Archetype<TComponents...>::Archetype(Registry* registry)
+	: registry(registry)
+{
+	(signature.set(Component<TComponents>::GetId()), ...);
+}
+
+template<typename ...TComponents>
+void Archetype<TComponents...>::Refresh(int entityId, const Signature& entitySignature)
+{
+	const bool matches = (entitySignature & signature) == signature;
+	if (matches == IsPacked(entityId)) {
+		return;
+	}
+	if (matches) {
+		(MoveToSlot<TComponents>(entityId, size), ...);
+		size++;
+	}
+	else {
+		size--;
+		(MoveToSlot<TComponents>(entityId, size), ...);
+	}
+}
+
+template<typename ...TComponents>
+template<typename TFunc>
+void Archetype<TComponents...>::Each(TFunc func) const
+{
+	if (size == 0) {
+		return;
+	}
+	std::tuple<Pool<TComponents>*...> pools(registry->GetComponentPool<TComponents>()...);
+	auto* leadPool = std::get<0>(pools);
+	for (int i = 0; i < size; i++) {
+		func(registry->GetEntity(leadPool->GetEntityId(i)), std::get<Pool<TComponents>*>(pools)->GetData()[i]...);
+	}
+}
+
+template<typename ...TComponents>
+bool Archetype<TComponents...>::IsPacked(int entityId) const
+{
+	auto* leadPool = registry->GetComponentPool<std::tuple_element_t<0, std::tuple<TComponents...>>>();
+	return leadPool && leadPool->Has(entityId) && leadPool->GetIndex(entityId) < size;
+}
+
+template<typename ...TComponents>
+template<typename TComponent>
+void Archetype<TComponents...>::MoveToSlot(int entityId, int slot) const
+{
+	auto* pool = registry->GetComponentPool<TComponent>();
+	pool->SwapSlots(pool->GetIndex(entityId), slot);
+}
+
+template<typename ...TComponents>
+template<typename TFunc>
+void View<TComponents...>::ParallelEach(JobSystem& jobSystem, TFunc func, int chunkSize) const
+{
+	if (!(std::get<Pool<TComponents>*>(pools) && ...)) {
+		return;
+	}
+	auto* leadPool = std::get<0>(pools);
+	jobSystem.ParallelFor(leadPool->GetSize(), chunkSize, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			const int entityId = leadPool->GetEntityId(i);
+			if (!(std::get<Pool<TComponents>*>(pools)->Has(entityId) && ...)) {
+				continue;
+			}
+			func(registry->GetEntity(entityId), std::get<Pool<TComponents>*>(pools)->Get(entityId)...);
+		}
+	});
+}
+
+template<typename TFunc>
+void System::ParallelForEach(JobSystem& jobSystem, TFunc func, int chunkSize) const
+{
+	jobSystem.ParallelFor(static_cast<int>(entities.size()), chunkSize, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			func(entities[i]);
+		}
+	});
+}
+
 template<typename TComponent>
-void System::RequiredComponent()
+void System::RequiredComponent(ComponentAccess access)
 {
 	const int componentId = Component<TComponent>::GetId();
 	componentSignature.set(componentId);
+	if (access == ComponentAccess::Write) {
+		WriteComponent<TComponent>();
+	}
+	else {
+		ReadComponent<TComponent>();
+	}
+}
+
+template<typename TComponent>
+void System::ReadComponent()
+{
+	readSignature.set(Component<TComponent>::GetId());
+}
+
+template<typename TComponent>
+void System::WriteComponent()
+{
+	writeSignature.set(Component<TComponent>::GetId());
 }
 
 template<typename TComponent, typename ...TArgs>
@@ -424,20 +1047,17 @@ void Registry::AddComponent(Entity entity, TArgs && ...args)
 	const size_t componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
 	if (static_cast<long unsigned int>(componentId) >= componentsPools.size()) {
-		componentsPools.resize(componentId + 10, nullptr);
+		componentsPools.resize(componentId + 10);
 	}
 	if (!componentsPools[componentId]) {
-		std::shared_ptr<Pool<TComponent>> newComponentPool = std::make_shared<Pool<TComponent>>();
-		componentsPools[componentId] = newComponentPool;
+		componentsPools[componentId] = std::make_unique<Pool<TComponent>>();
 	}
-	std::shared_ptr<Pool<TComponent>> componentPool = 
-		std::static_pointer_cast<Pool<TComponent>>(componentsPools[componentId]);
-	if (entityId >= componentPool->GetSize()) {
-		componentPool->Resize(numEntity + 100);
-	}
-	TComponent newComponent(std::forward<TArgs>(args)...);
-	componentPool->Set(entityId, newComponent);
+	Pool<TComponent>* componentPool = GetComponentPool<TComponent>();
+	componentPool->Emplace(entityId, std::forward<TArgs>(args)...);
 	entityComponentSignatures[entityId].set(componentId);
+	if (archetypeComponents.test(componentId)) {
+		RefreshArchetypes(entityId, entityComponentSignatures[entityId]);
+	}
 	//std::cout << "[Registry] Se agrega componente " << componentId << " a la entidad " << entityId << std::endl;
 }
 
@@ -446,6 +1066,12 @@ void Registry::RemoveComponent(Entity entity)
 {
 	const int componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
+	if (archetypeComponents.test(componentId)) {
+		RefreshArchetypes(entityId, Signature(entityComponentSignatures[entityId]).reset(componentId));
+	}
+	if (static_cast<size_t>(componentId) < componentsPools.size() && componentsPools[componentId]) {
+		componentsPools[componentId]->RemoveEntityFromPool(entityId);
+	}
 	entityComponentSignatures[entityId].set(componentId, false);
 }
 
@@ -454,23 +1080,66 @@ bool Registry::HasComponent(Entity entity) const
 {
 	const int componentId = Component<TComponent>::GetId();
 	const int entityId = entity.GetId();
+	if (static_cast<size_t>(entityId) >= entityVersions.size() ||
+		entityVersions[entityId] != entity.GetVersion()) {
+		return false;
+	}
 	return entityComponentSignatures[entityId].test(componentId);
 }
 
 template<typename TComponent, typename ...TArgs>
 TComponent& Registry::GetComponent(Entity entity) const
 {
-	const int componentId = Component<TComponent>::GetId();
-	const int entityId = entity.GetId();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentsPools[componentId]);
-	return componentPool->Get(entityId);
+	assert(HasComponent<TComponent>(entity) && "GetComponent on an entity without the component");
+	return GetComponentPool<TComponent>()->Get(entity.GetId());
+}
+
+template<typename TComponent>
+Pool<TComponent>* Registry::GetComponentPool() const
+{
+	const size_t componentId = Component<TComponent>::GetId();
+	if (componentId >= componentsPools.size()) {
+		return nullptr;
+	}
+	return static_cast<Pool<TComponent>*>(componentsPools[componentId].get());
+}
+
+template<typename ...TComponents>
+View<TComponents...> Registry::GetView()
+{
+	return View<TComponents...>(this, GetComponentPool<TComponents>()...);
+}
+
+template<typename ...TComponents>
+void Registry::RegisterArchetype()
+{
+	const std::type_index key(typeid(Archetype<TComponents...>));
+	if (archetypes.find(key) != archetypes.end()) {
+		return;
+	}
+	auto archetype = std::make_unique<Archetype<TComponents...>>(this);
+	assert((archetype->GetSignature() & archetypeComponents).none() && "A component can only belong to one archetype");
+	archetypeComponents |= archetype->GetSignature();
+	for (int i = 0; i < numEntity; i++) {
+		archetype->Refresh(i, entityComponentSignatures[i]);
+	}
+	archetypes.emplace(key, std::move(archetype));
+}
+
+template<typename ...TComponents>
+Archetype<TComponents...>& Registry::GetArchetype() const
+{
+	auto archetype = archetypes.find(std::type_index(typeid(Archetype<TComponents...>)));
+	return *static_cast<Archetype<TComponents...>*>(archetype->second.get());
 }
 
 template<typename TSystem, typename ...TArgs>
 void Registry::AddSystem(TArgs && ...args)
 {
 	std::shared_ptr<TSystem> newSystem = std::make_shared<TSystem>(std::forward<TArgs>(args)...);
+	newSystem->registry = this;
 	systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem));
+	systemsBySignature.clear();
 }
 
 template<typename TSystem>
@@ -478,6 +1147,7 @@ void Registry::RemoveSystem()
 {
 	auto system = systems.find(std::type_index(typeid(TSystem)));
 	systems.erase(system); 
+	systemsBySignature.clear();
 }
 
 template<typename TSystem>
@@ -490,7 +1160,7 @@ template<typename TSystem>
 TSystem& Registry::GetSystem() const
 {
 	auto system = systems.find(std::type_index(typeid(TSystem)));
-	return *(std::static_pointer_cast<TSystem>(system->second));
+	return *static_cast<TSystem*>(system->second.get());
 }
 
 template<typename TComponent, typename ...TArgs>
@@ -508,7 +1178,7 @@ void Entity::RemoveComponent()
 template<typename TComponent, typename ...TArgs>
 bool Entity::HasComponent() const
 {
-	return registry->HasComponent<TComponent>(*this);
+	return registry && registry->HasComponent<TComponent>(*this);
 }
 
 template<typename TComponent, typename ...TArgs>
@@ -0,0 +1,137 @@
+/**
+ * @file CollisionDispatcher.hpp
+ * @brief Dispatch table routing collisions to handlers by collision layer
+ */
+
+#ifndef COLLISIONDISPATCHER_HPP
+#define COLLISIONDISPATCHER_HPP
+#include <utility>
+#include <vector>
+#include "EventManager.hpp"
+#include "../Events/CollisionEvent.hpp"
+
+/**
+ * @brief Number of collision layers, one per bit of a layer mask
+ */
+const int COLLISION_LAYER_COUNT = 32;
+
+/**
+ * @class CollisionDispatcher
+ * @brief Routes each collision to the handlers registered for the layers of both colliders
+ *
+ * Handlers subscribe for a pair of layer masks and only receive collisions
+ * between a collider on the first mask and a collider on the second one, with
+ * the entities ordered to match. The handlers of every pair of layers are
+ * precomputed in a table when they subscribe, so dispatching a collision is a
+ * single lookup instead of a call to every collision subscriber.
+ *
+ * Unlike the EventManager, subscriptions are kept until Reset is called, so
+ * systems subscribe once when the game is set up.
+ */
+class CollisionDispatcher {
+public:
+    /**
+     * @brief Subscribes a method to the collisions between two groups of layers
+     *
+     * When a pair matches in both orders, as with the same mask on both sides,
+     * the handler is called once with the entities in collision order.
+     *
+     * @tparam TOwner The type of the object that owns the callback method
+     * @param layersA Layers of the entity passed as CollisionEvent::a
+     * @param layersB Layers of the entity passed as CollisionEvent::b
+     * @param ownerInstance Pointer to the object that owns the callback
+     * @param callbackFunction Pointer to the member function to be called
+     */
+    template <typename TOwner>
+    void Subscribe(unsigned int layersA, unsigned int layersB, TOwner* ownerInstance,
+                   void (TOwner::*callbackFunction)(CollisionEvent&)) {
+        const int handler = static_cast<int>(handlers.size());
+        handlers.push_back(EventDelegate(ownerInstance, callbackFunction));
+        for (int i = 0; i < COLLISION_LAYER_COUNT; i++) {
+            for (int j = 0; j < COLLISION_LAYER_COUNT; j++) {
+                if ((layersA & (1u << i)) && (layersB & (1u << j))) {
+                    table[i][j].push_back({ handler, false });
+                }
+                else if ((layersA & (1u << j)) && (layersB & (1u << i))) {
+                    table[i][j].push_back({ handler, true });
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Calls the handlers registered for the layers of two colliding entities
+     *
+     * A collider with several layer bits is dispatched as its lowest layer.
+     *
+     * @param a The first colliding entity
+     * @param aLayer Layer bits of the first collider
+     * @param b The second colliding entity
+     * @param bLayer Layer bits of the second collider
+     */
+    void Dispatch(Entity a, unsigned int aLayer, Entity b, unsigned int bLayer) {
+        if (aLayer == 0 || bLayer == 0) {
+            return;
+        }
+        for (const Route& route : table[LowestLayer(aLayer)][LowestLayer(bLayer)]) {
+            CollisionEvent event = route.swap ? CollisionEvent(b, a) : CollisionEvent(a, b);
+            handlers[route.handler].Execute(event);
+        }
+    }
+
+    /**
+     * @brief Checks if any handler is registered for the layers of two colliders
+     *
+     * @param aLayer Layer bits of the first collider
+     * @param bLayer Layer bits of the second collider
+     * @return true if Dispatch would call at least one handler
+     */
+    bool HasHandlers(unsigned int aLayer, unsigned int bLayer) const {
+        return aLayer != 0 && bLayer != 0 && !table[LowestLayer(aLayer)][LowestLayer(bLayer)].empty();
+    }
+
+    /**
+     * @brief Removes every subscription
+     */
+    void Reset() {
+        handlers.clear();
+        for (auto& row : table) {
+            for (auto& routes : row) {
+                routes.clear();
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Handler to call for a pair of layers
+     */
+    struct Route {
+        int handler;   ///< Index of the handler
+        bool swap;     ///< Whether the entities are passed in reverse order
+    };
+
+    /**
+     * @brief Registered handlers in subscription order
+     */
+    std::vector<EventDelegate> handlers;
+
+    /**
+     * @brief Routes for each pair of layer indices
+     */
+    std::vector<Route> table[COLLISION_LAYER_COUNT][COLLISION_LAYER_COUNT];
+
+    /**
+     * @brief Gets the index of the lowest bit set in a non-zero layer mask
+     */
+    static int LowestLayer(unsigned int layer) {
+        int index = 0;
+        while (!(layer & 1u)) {
+            layer >>= 1;
+            index++;
+        }
+        return index;
+    }
+};
+
+#endif // !COLLISIONDISPATCHER_HPP
@@ -0,0 +1,201 @@
+/**
+ * @file EventChannel.hpp
+ * @brief Bounded lock-free channel carrying events from worker threads to the main thread
+ */
+
+#ifndef EVENTCHANNEL_HPP
+#define EVENTCHANNEL_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @struct EventChannelStats
+ * @brief Counters of an event channel since it was opened
+ */
+struct EventChannelStats {
+    size_t capacity = 0;   ///< Number of events the channel holds before dropping
+    size_t posted = 0;     ///< Events accepted by Post
+    size_t dropped = 0;    ///< Events rejected by Post because the channel was full
+    size_t received = 0;   ///< Events taken out by Receive
+};
+
+/**
+ * @class EventChannel
+ * @brief Multi-producer, single-consumer ring of events of one type
+ * @tparam TEvent The type of the events carried
+ *
+ * Any number of threads post events and a single thread, the main one,
+ * receives them. The ring has a fixed capacity, rounded up to a power of
+ * two, and every slot carries a sequence number telling whether it is free
+ * for the producers or holds an event for the consumer. A producer claims a
+ * slot with one compare-and-swap on the write position and publishes the
+ * event by advancing the slot sequence, so producers never wait for a lock
+ * or for each other. When the ring is full the event is dropped and
+ * counted instead of blocking the producer.
+ *
+ * A producer stopped between claiming a slot and publishing it holds back
+ * the events after it until it finishes; they are received on a later call.
+ */
+template <typename TEvent>
+class EventChannel {
+public:
+    /**
+     * @brief Constructor for EventChannel
+     * @param capacity Minimum number of events the channel can hold
+     */
+    explicit EventChannel(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask = size - 1;
+        slots.reset(new Slot[size]);
+        for (size_t i = 0; i < size; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Destructor for EventChannel
+     *
+     * Destroys the events that were never received.
+     */
+    ~EventChannel() {
+        Receive([](TEvent&) {});
+    }
+
+    EventChannel(const EventChannel&) = delete;
+    EventChannel& operator=(const EventChannel&) = delete;
+
+    /**
+     * @brief Builds an event in the channel; safe to call from any thread
+     * @tparam TArgs Variadic template for event constructor arguments
+     * @param args Arguments to forward to the event constructor
+     * @return true if the event was posted, false if the channel was full
+     *         and the event was dropped
+     */
+    template <typename... TArgs>
+    bool Post(TArgs&&... args) {
+        size_t position = writePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[position & mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                // The slot is free for this position; claim it unless another producer did
+                if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (difference < 0) {
+                // The slot still holds the event of the previous lap, so the ring is full
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else {
+                position = writePosition.load(std::memory_order_relaxed);
+            }
+        }
+        new (slot->storage) TEvent(std::forward<TArgs>(args)...);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        posted.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Takes out the events posted so far, in the order they were claimed
+     * @tparam TFunc Callable as func(TEvent& event)
+     * @param func Function called with each event before it is destroyed
+     * @return Number of events received
+     *
+     * Must only be called from the consumer thread. At most one lap of the
+     * ring is received per call, so producers posting meanwhile cannot keep
+     * the consumer busy.
+     */
+    template <typename TFunc>
+    size_t Receive(TFunc&& func) {
+        size_t count = 0;
+        while (count <= mask) {
+            Slot& slot = slots[readPosition & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != readPosition + 1) {
+                break;
+            }
+            TEvent* event = std::launder(reinterpret_cast<TEvent*>(slot.storage));
+            func(*event);
+            event->~TEvent();
+            // Frees the slot for the producers of the next lap
+            slot.sequence.store(readPosition + mask + 1, std::memory_order_release);
+            readPosition++;
+            count++;
+        }
+        received += count;
+        return count;
+    }
+
+    /**
+     * @brief Gets the counters of the channel
+     *
+     * The counters are read without synchronizing with the producers, so
+     * they may be a little behind while events are being posted.
+     */
+    EventChannelStats GetStats() const {
+        EventChannelStats stats;
+        stats.capacity = mask + 1;
+        stats.posted = posted.load(std::memory_order_relaxed);
+        stats.dropped = dropped.load(std::memory_order_relaxed);
+        stats.received = received;
+        return stats;
+    }
+
+private:
+    /**
+     * @brief Size of a cache line, to keep positions written by different threads apart
+     */
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * @brief Slot of the ring holding an event
+     */
+    struct Slot {
+        std::atomic<size_t> sequence;                                   ///< Position the slot is ready for
+        alignas(TEvent) unsigned char storage[sizeof(TEvent)];          ///< Event built in place
+    };
+
+    /**
+     * @brief Slots of the ring
+     */
+    std::unique_ptr<Slot[]> slots;
+
+    /**
+     * @brief Number of slots minus one, to wrap positions
+     */
+    size_t mask = 0;
+
+    /**
+     * @brief Next position claimed by the producers
+     */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> writePosition{ 0 };
+
+    /**
+     * @brief Events accepted and dropped by Post
+     */
+    std::atomic<size_t> posted{ 0 };
+    std::atomic<size_t> dropped{ 0 };
+
+    /**
+     * @brief Next position read by the consumer
+     */
+    alignas(CACHE_LINE_SIZE) size_t readPosition = 0;
+
+    /**
+     * @brief Events taken out by the consumer
+     */
+    size_t received = 0;
+};
+
+#endif // !EVENTCHANNEL_HPP
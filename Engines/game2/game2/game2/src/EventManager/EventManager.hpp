@@ -5,99 +5,112 @@
 
 #ifndef EVENTMANAGER_HPP
 #define EVENTMANAGER_HPP
-#include <functional>
-#include <list>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <typeindex>
 #include <iostream>
+#include <utility>
+#include <vector>
 #include "Event.hpp"
+#include "EventChannel.hpp"
 
 /**
- * @class IEventCallback
- * @brief Abstract base class for event callback handlers
+ * @class EventDelegate
+ * @brief Callback to a member function, stored by value
  * 
- * Provides a common interface for all event callback implementations.
- * Uses the Template Method pattern to allow derived classes to implement
- * specific callback behavior.
+ * Holds the owner instance, a copy of the member function pointer in a small
+ * inline buffer and a trampoline function instantiated for the owner and
+ * event types, which restores the member function pointer and calls it.
+ * Calling a delegate is a single indirect call with no virtual dispatch, and
+ * building one allocates nothing, so handlers are kept by value in
+ * contiguous arrays.
  */
-class IEventCallback {
+class EventDelegate {
 public:
     /**
-     * @brief Virtual destructor for proper cleanup of derived classes
+     * @brief Constructor for EventDelegate
+     * @tparam TOwner The type of the object that owns the callback method
+     * @tparam TEvent The type of event the callback handles
+     * @param ownerInstance Pointer to the object that owns the callback method
+     * @param callbackFunction Pointer to the member function to be called
      */
-    virtual ~IEventCallback() = default;
+    template <typename TOwner, typename TEvent>
+    EventDelegate(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
+        static_assert(sizeof(callbackFunction) <= FUNCTION_SIZE, "member function pointer does not fit the delegate");
+        this->ownerInstance = ownerInstance;
+        std::memcpy(function, &callbackFunction, sizeof(callbackFunction));
+        trampoline = &Call<TOwner, TEvent>;
+    }
     
     /**
      * @brief Executes the callback with the provided event
-     * @param e Reference to the event to be processed
+     * @param e Reference to the event to be processed, of the type the
+     *          delegate was built for
      */
-    void Execute(Event& e) {
-        Call(e);
+    void Execute(Event& e) const {
+        trampoline(ownerInstance, function, e);
     }
     
 private:
     /**
-     * @brief Pure virtual method to be implemented by derived classes
-     * @param e Reference to the event to be processed
+     * @brief Bytes kept for the member function pointer
+     * 
+     * Member function pointers take one or two pointers with GCC and Clang,
+     * and up to three words with MSVC for classes with virtual bases.
      */
-    virtual void Call(Event& e) = 0;
-};
-
-/**
- * @class EventCallback
- * @brief Template class for type-safe event callbacks
- * @tparam TOwner The type of the object that owns the callback method
- * @tparam TEvent The type of event this callback handles
- * 
- * Implements the IEventCallback interface for specific owner and event types.
- * Stores a pointer to the owner instance and a member function pointer.
- */
-template <typename TOwner, typename TEvent>
-class EventCallback : public IEventCallback {
-private:
+    static constexpr size_t FUNCTION_SIZE = 4 * sizeof(void*);
+    
     /**
-     * @brief Type alias for the callback function pointer
+     * @brief Type of the functions that call the stored member function
      */
-    typedef void (TOwner::*CallbackFunction)(TEvent&);
+    typedef void (*Trampoline)(void* ownerInstance, const unsigned char* function, Event& e);
     
     /**
      * @brief Pointer to the instance that owns the callback method
      */
-    TOwner* ownerInstance;
+    void* ownerInstance;
     
     /**
-     * @brief Pointer to the member function to be called
+     * @brief Function calling the member function for the owner and event types
      */
-    CallbackFunction callbackFunction;
+    Trampoline trampoline;
     
     /**
-     * @brief Implementation of the pure virtual Call method
-     * @param e Reference to the event to be processed
-     * 
-     * Casts the generic Event reference to the specific event type
-     * and invokes the callback function on the owner instance.
+     * @brief Copy of the member function pointer
      */
-    virtual void Call(Event& e) override {
-        std::invoke(callbackFunction, ownerInstance, static_cast<TEvent&>(e));
-    }
+    alignas(void*) unsigned char function[FUNCTION_SIZE];
     
-public:
     /**
-     * @brief Constructor for EventCallback
-     * @param ownerInstance Pointer to the object that owns the callback method
-     * @param callbackFunction Pointer to the member function to be called
+     * @brief Casts the owner and the event back to their types and calls the member function
      */
-    EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction) {
-        this->callbackFunction = callbackFunction;
-        this->ownerInstance = ownerInstance;
+    template <typename TOwner, typename TEvent>
+    static void Call(void* ownerInstance, const unsigned char* function, Event& e) {
+        void (TOwner::*callbackFunction)(TEvent&);
+        std::memcpy(&callbackFunction, function, sizeof(callbackFunction));
+        (static_cast<TOwner*>(ownerInstance)->*callbackFunction)(static_cast<TEvent&>(e));
     }
 };
 
 /**
- * @brief Type alias for a list of event callback handlers
+ * @enum SubscriptionScope
+ * @brief How long a subscription lasts if it is not removed with Unsubscribe
+ */
+enum class SubscriptionScope {
+    Game,    ///< Kept until the game ends, for systems that subscribe once at setup
+    Scene    ///< Removed by ClearSceneSubscriptions when the scene changes
+};
+
+/**
+ * @struct EventSubscription
+ * @brief Handle returned when subscribing, used to unsubscribe
  */
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+struct EventSubscription {
+    std::type_index type = typeid(void);   ///< Event type of the subscription
+    unsigned int id = 0;                   ///< Id of the handler, 0 if not subscribed
+};
 
 /**
  * @class EventManager
@@ -106,6 +119,25 @@ typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
  * Manages event subscriptions and emissions. Provides type-safe event handling
  * by mapping event types to lists of callback handlers. Supports subscription
  * to events and emission of events with arbitrary arguments.
+ * 
+ * Subscriptions persist across frames, so systems subscribe once instead of
+ * every frame. Each one can be removed with the handle returned when
+ * subscribing, and the ones made with SubscriptionScope::Scene are removed
+ * together when the scene changes. Handlers may subscribe and unsubscribe
+ * while an event is being emitted: removed handlers are no longer called and
+ * are freed once the emission ends, and new handlers get the next event.
+ * 
+ * Events can also be queued with QueueEvent and delivered later by
+ * DispatchEvents. Queued events are stored by value in one vector per event
+ * type, found through a slot given to the type the first time it is queued,
+ * so queueing is a vector append with no map lookup and no handler call.
+ * This keeps bursts of events, like the collisions of a frame, from running
+ * their handlers in the middle of the system that produces them.
+ * 
+ * The EventManager is not thread safe. Worker threads post events through
+ * the lock-free channels opened with OpenChannel instead, and the events
+ * they carry are moved to the queues and delivered by DispatchEvents on the
+ * main thread.
  */
 class EventManager {
 public:
@@ -131,7 +163,18 @@ public:
      * @brief Resets the event manager by clearing all subscriptions
      */
     void Reset() {
-        subscribers.clear();
+        for (auto& entry : subscribers) {
+            RemoveIf(entry.second, [](const Handler&) { return true; });
+        }
+    }
+    
+    /**
+     * @brief Removes the subscriptions made with SubscriptionScope::Scene
+     */
+    void ClearSceneSubscriptions() {
+        for (auto& entry : subscribers) {
+            RemoveIf(entry.second, [](const Handler& handler) { return handler.scope == SubscriptionScope::Scene; });
+        }
     }
     
     /**
@@ -140,18 +183,36 @@ public:
      * @tparam TOwner The type of the object that owns the callback method
      * @param ownerInstance Pointer to the object instance
      * @param callbackFunction Pointer to the member function to be called when the event occurs
+     * @param scope Whether the subscription lasts for the game or only for the current scene
+     * @return Handle that can be passed to Unsubscribe
      * 
-     * Creates a new callback handler and adds it to the list of subscribers
-     * for the specified event type. If no handler list exists for the event type,
-     * a new one is created.
+     * Stores a delegate to the method at the end of the handlers of the
+     * event type. If no handler list exists for the event type, a new one is
+     * created.
      */
     template <typename TEvent, typename TOwner>
-    void SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
-        if (!subscribers[typeid(TEvent)].get()) {
-            subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
+    EventSubscription SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&),
+                                       SubscriptionScope scope = SubscriptionScope::Game) {
+        EventSubscription subscription;
+        subscription.type = typeid(TEvent);
+        subscription.id = ++lastId;
+        subscribers[subscription.type].handlers.push_back({ EventDelegate(ownerInstance, callbackFunction), subscription.id, scope });
+        return subscription;
+    }
+    
+    /**
+     * @brief Removes a subscription
+     * @param subscription Handle returned by SubscribeToEvent; it is cleared
+     * 
+     * Does nothing if the subscription was already removed.
+     */
+    void Unsubscribe(EventSubscription& subscription) {
+        auto found = subscribers.find(subscription.type);
+        if (subscription.id != 0 && found != subscribers.end()) {
+            const unsigned int id = subscription.id;
+            RemoveIf(found->second, [id](const Handler& handler) { return handler.id == id; });
         }
-        auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
-        subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
+        subscription.id = 0;
     }
     
     /**
@@ -160,30 +221,298 @@ public:
      * @tparam TArgs Variadic template for event constructor arguments
      * @param args Arguments to forward to the event constructor
      * 
-     * Creates an instance of the specified event type and calls all registered
-     * handlers for that event type. Uses perfect forwarding to pass arguments
-     * to the event constructor.
+     * Creates one instance of the specified event type and calls every
+     * registered handler with it, so all handlers see the same event object,
+     * as with DispatchEvents. Handlers subscribed while the event is emitted
+     * are not called for it.
      */
     template <typename TEvent, typename... TArgs>
     void EmitEvent(TArgs&&... args) {
-        auto handlers = subscribers[typeid(TEvent)].get();
-        if (handlers) {
-            for (auto it = handlers->begin(); it != handlers->end(); it++) {
-                auto handler = it->get();
-                TEvent event(std::forward<TArgs>(args)...);
-                handler->Execute(event);
+        auto found = subscribers.find(typeid(TEvent));
+        if (found == subscribers.end()) {
+            return;
+        }
+        HandlerList& list = found->second;
+        TEvent event(std::forward<TArgs>(args)...);
+        list.emitting++;
+        const size_t count = list.handlers.size();
+        for (size_t i = 0; i < count; i++) {
+            // Handlers may subscribe while running, so the vector is indexed again each time
+            if (!list.handlers[i].removed) {
+                list.handlers[i].callback.Execute(event);
+            }
+        }
+        list.emitting--;
+        if (list.emitting == 0 && list.hasRemoved) {
+            Compact(list);
+        }
+    }
+    
+    /**
+     * @brief Queues an event to be delivered by the next DispatchEvents
+     * @tparam TEvent The type of event to queue
+     * @tparam TArgs Variadic template for event constructor arguments
+     * @param args Arguments to forward to the event constructor
+     * 
+     * The event is built once and stored, so its arguments must still be
+     * valid when it is dispatched. Not thread safe: events must be queued
+     * from one thread at a time.
+     */
+    template <typename TEvent, typename... TArgs>
+    void QueueEvent(TArgs&&... args) {
+        GetQueue<TEvent>().pending.emplace_back(std::forward<TArgs>(args)...);
+    }
+    
+    /**
+     * @brief Opens the channel through which other threads post events of a type
+     * @tparam TEvent The type of event carried by the channel
+     * @param capacity Minimum number of events the channel holds between two
+     *                 calls to DispatchEvents; events posted beyond it are
+     *                 dropped and counted in its stats
+     * @return The channel, which lives as long as the EventManager
+     * 
+     * Must be called from the main thread, before the producers start. If
+     * the channel of the type is already open it is returned as is.
+     */
+    template <typename TEvent>
+    EventChannel<TEvent>& OpenChannel(size_t capacity) {
+        EventQueue<TEvent>& queue = GetQueue<TEvent>();
+        if (!queue.channel) {
+            queue.channel = std::make_unique<EventChannel<TEvent>>(capacity);
+        }
+        return *queue.channel;
+    }
+    
+    /**
+     * @brief Delivers the events queued since the last call
+     * 
+     * The events posted to the channels are moved to the queues first. Each
+     * event type is delivered in turn, in the order its first event was
+     * ever queued. For each type, every handler gets all the events of the
+     * type, in the order they were queued, before the next handler runs, so
+     * all handlers see the same event object. Events queued by the handlers
+     * go to a separate buffer: those of a type not yet delivered by this call,
+     * including a type queued for the first time, are delivered later in the
+     * same call, and the rest by the next call. The buffers of both sides are
+     * swapped and kept, so a frame reuses the storage of the previous ones.
+     * Calls made from inside a handler do nothing.
+     */
+    void DispatchEvents() {
+        if (dispatching) {
+            return;
+        }
+        dispatching = true;
+        for (auto& queue : queues) {
+            if (queue) {
+                queue->Receive();
+            }
+        }
+        // Handlers may queue a new event type, which grows the queues, so they are indexed again each time
+        for (size_t i = 0; i < queues.size(); i++) {
+            if (queues[i]) {
+                queues[i]->Dispatch();
+            }
+        }
+        dispatching = false;
+    }
+    
+    /**
+     * @brief Drops the queued events that were not dispatched yet, including
+     *        the ones waiting in the channels
+     */
+    void ClearQueuedEvents() {
+        for (auto& queue : queues) {
+            if (queue) {
+                queue->Clear();
             }
         }
     }
     
 private:
+    /**
+     * @brief A subscribed callback
+     */
+    struct Handler {
+        EventDelegate callback;                              ///< Callback to call
+        unsigned int id;                                     ///< Id given to the subscription handle
+        SubscriptionScope scope;                             ///< How long the subscription lasts
+        bool removed = false;                                ///< Unsubscribed while its list was being emitted
+    };
+
+    /**
+     * @brief Handlers of one event type, in subscription order
+     */
+    struct HandlerList {
+        std::vector<Handler> handlers;   ///< Subscribed handlers
+        int emitting = 0;                ///< Number of emissions of this type running
+        bool hasRemoved = false;         ///< Whether some handler waits to be freed
+    };
+
     /**
      * @brief Map of event types to their corresponding handler lists
      * 
      * Uses std::type_index as the key to identify event types at runtime.
-     * Each event type maps to a unique list of callback handlers.
+     * Lists are kept when they become empty, so subscribing again does not
+     * rebuild the map.
      */
-    std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+    std::map<std::type_index, HandlerList> subscribers;
+
+    /**
+     * @brief Id of the last subscription made
+     */
+    unsigned int lastId = 0;
+
+    /**
+     * @brief Base interface of the queues of events of one type
+     */
+    class IEventQueue {
+    public:
+        virtual ~IEventQueue() = default;
+        
+        /**
+         * @brief Moves the events posted to the channel of the type to the pending ones
+         */
+        virtual void Receive() = 0;
+        
+        /**
+         * @brief Delivers the pending events to the handlers of the type
+         */
+        virtual void Dispatch() = 0;
+        
+        /**
+         * @brief Drops the pending events
+         */
+        virtual void Clear() = 0;
+    };
+
+    /**
+     * @brief Events of one type waiting for DispatchEvents
+     * @tparam TEvent The type of the queued events
+     */
+    template <typename TEvent>
+    class EventQueue : public IEventQueue {
+    public:
+        /**
+         * @brief Events queued since the last dispatch
+         */
+        std::vector<TEvent> pending;
+        
+        /**
+         * @brief Channel of the type, if it was opened
+         */
+        std::unique_ptr<EventChannel<TEvent>> channel;
+        
+        /**
+         * @brief Constructor for EventQueue
+         * @param list Handlers of the event type
+         */
+        explicit EventQueue(HandlerList& list) : list(list) {}
+        
+        virtual void Receive() override {
+            if (channel) {
+                channel->Receive([this](TEvent& event) { pending.push_back(std::move(event)); });
+            }
+        }
+        
+        virtual void Dispatch() override {
+            if (pending.empty()) {
+                return;
+            }
+            // Events queued by the handlers are appended to the other buffer
+            std::swap(pending, delivering);
+            list.emitting++;
+            const size_t count = list.handlers.size();
+            for (size_t i = 0; i < count; i++) {
+                for (size_t j = 0; j < delivering.size() && !list.handlers[i].removed; j++) {
+                    list.handlers[i].callback.Execute(delivering[j]);
+                }
+            }
+            list.emitting--;
+            if (list.emitting == 0 && list.hasRemoved) {
+                Compact(list);
+            }
+            delivering.clear();
+        }
+        
+        virtual void Clear() override {
+            pending.clear();
+            if (channel) {
+                channel->Receive([](TEvent&) {});
+            }
+        }
+        
+    private:
+        HandlerList& list;
+        std::vector<TEvent> delivering;
+    };
+
+    /**
+     * @brief Queues of events indexed by the slot of their type
+     */
+    std::vector<std::unique_ptr<IEventQueue>> queues;
+
+    /**
+     * @brief Whether DispatchEvents is running
+     */
+    bool dispatching = false;
+
+    /**
+     * @brief Gets the queue of an event type, creating it the first time
+     */
+    template <typename TEvent>
+    EventQueue<TEvent>& GetQueue() {
+        const size_t slot = GetEventSlot<TEvent>();
+        if (slot >= queues.size()) {
+            queues.resize(slot + 1);
+        }
+        if (!queues[slot]) {
+            // Lists are never erased from the map, so the queue can keep a reference to its own
+            queues[slot] = std::make_unique<EventQueue<TEvent>>(subscribers[typeid(TEvent)]);
+        }
+        return static_cast<EventQueue<TEvent>&>(*queues[slot]);
+    }
+
+    /**
+     * @brief Gets the slot of an event type in the queues
+     * 
+     * Slots are given in order the first time each type is queued, in the
+     * same way as component ids.
+     */
+    template <typename TEvent>
+    static size_t GetEventSlot() {
+        static size_t slot = NextEventSlot()++;
+        return slot;
+    }
+
+    static size_t& NextEventSlot() {
+        static size_t next = 0;
+        return next;
+    }
+
+    /**
+     * @brief Removes the handlers of a list that match a condition
+     * 
+     * While the list is being emitted the handlers are only marked, so the
+     * callback running is not destroyed, and they are freed when it ends.
+     */
+    template <typename TFunc>
+    static void RemoveIf(HandlerList& list, TFunc&& condition) {
+        for (Handler& handler : list.handlers) {
+            if (!handler.removed && condition(handler)) {
+                handler.removed = true;
+                list.hasRemoved = true;
+            }
+        }
+        if (list.emitting == 0 && list.hasRemoved) {
+            Compact(list);
+        }
+    }
+
+    static void Compact(HandlerList& list) {
+        list.handlers.erase(std::remove_if(list.handlers.begin(), list.handlers.end(),
+            [](const Handler& handler) { return handler.removed; }), list.handlers.end());
+        list.hasRemoved = false;
+    }
 };
 
 #endif // !EVENTMANAGER_HPP
\ No newline at end of file
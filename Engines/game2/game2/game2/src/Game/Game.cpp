@@ -30,9 +30,12 @@ Game::Game()
 	this->registry = std::make_unique<Registry>();
 	assetManager = std::make_unique<AssetManager>();
 	eventManager = std::make_unique<EventManager>();
+	collisionDispatcher = std::make_unique<CollisionDispatcher>();
 	controllerManager = std::make_unique<ControllerManager>();
 	sceneManager = std::make_unique<SceneManager>();
 	animationManager = std::make_unique<AnimationManager>();
+	jobSystem = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount());
+	systemScheduler = std::make_unique<SystemScheduler>(*jobSystem);
 	camera.x = 0;
 	camera.y = 0;
 	camera.w = this->window_width;
@@ -101,6 +104,17 @@ void Game::Setup()
 	registry->AddSystem<OverlapSystem>();
 	registry->AddSystem<CounterSystem>();
 
+	// Subscriptions persist across frames and scenes
+	registry->GetSystem<UISystem>().SubscribeToClickEvent(eventManager);
+	//registry->GetSystem<DamageSystem>().SubscribeToCollisionEvent(eventManager);
+
+	lua["collision_layer"] = lua.create_table_with(
+		"default", LAYER_DEFAULT,
+		"world", LAYER_WORLD,
+		"trigger", LAYER_TRIGGER,
+		"all", LAYER_ALL
+	);
+
 	sceneManager->LoadSceneFromScript("./assets/scripts/scenes.lua", lua);
 
 	lua.open_libraries(sol::lib::base, sol::lib::math);
@@ -125,6 +139,11 @@ void Game::ProcessInput()
 			}
 			if (sdlEvent.key.keysym.sym == SDLK_i) {
 				isDebugMode = !isDebugMode;
+				if (!isDebugMode) {
+					SDL_SetWindowTitle(window, "Game Engine");
+					shownDrawCalls = -1;
+					shownSpriteCount = -1;
+				}
 				break;
 			}
 			if (sdlEvent.key.keysym.sym == SDLK_p) {
@@ -164,19 +183,35 @@ void Game::Update()
 	}
 	double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
 	millisecsPreviousFrame = SDL_GetTicks();
-	eventManager->Reset();
-	registry->GetSystem<UISystem>().SubscribeToClickEvent(eventManager);
-	registry->GetSystem<OverlapSystem>().SubscribeToCollisionEvent(eventManager);
-	//registry->GetSystem<DamageSystem>().SubscribeToCollisionEvent(eventManager);
 	registry->Update();
-	registry->GetSystem<ScriptSystem>().Update(lua, deltaTime);
-	registry->GetSystem<PhysicsSystem>().Update();
-	registry->GetSystem<MovementSystem>().Update(deltaTime);
-	registry->GetSystem<BoxCollisionSystem>().Update(lua, eventManager);
-	registry->GetSystem<CircleCollisionSystem>().Update(eventManager);
-	registry->GetSystem<AnimationSystem>().Update();
-	registry->GetSystem<CameraMovementSystem>().Update(camera);
-	registry->GetSystem<CounterSystem>().Update(this->currentDeaths);
+
+	// Debug mode runs the systems one after another, in this order
+	systemScheduler->SetSingleThreaded(isDebugMode);
+	auto& scriptSystem = registry->GetSystem<ScriptSystem>();
+	systemScheduler->Add(scriptSystem, [&] { scriptSystem.Update(lua, deltaTime); });
+	auto& physicsSystem = registry->GetSystem<PhysicsSystem>();
+	systemScheduler->Add(physicsSystem, [&] { physicsSystem.Update(); });
+	auto& movementSystem = registry->GetSystem<MovementSystem>();
+	systemScheduler->Add(movementSystem, [&] { movementSystem.Update(deltaTime, *jobSystem); });
+	auto& boxCollisionSystem = registry->GetSystem<BoxCollisionSystem>();
+	auto& overlapSystem = registry->GetSystem<OverlapSystem>();
+	// Overlaps are resolved between detection and the collision callbacks, so scripts see the resolved state
+	systemScheduler->Add(boxCollisionSystem, [&] {
+		boxCollisionSystem.DetectContacts(*jobSystem);
+		overlapSystem.Update(boxCollisionSystem.GetContacts());
+		boxCollisionSystem.ReportContacts(lua, eventManager, collisionDispatcher);
+	});
+	auto& circleCollisionSystem = registry->GetSystem<CircleCollisionSystem>();
+	systemScheduler->Add(circleCollisionSystem, [&] { circleCollisionSystem.Update(eventManager, collisionDispatcher, *jobSystem); });
+	auto& animationSystem = registry->GetSystem<AnimationSystem>();
+	systemScheduler->Add(animationSystem, [&] { animationSystem.Update(*jobSystem); });
+	auto& cameraMovementSystem = registry->GetSystem<CameraMovementSystem>();
+	systemScheduler->Add(cameraMovementSystem, [&] { cameraMovementSystem.Update(camera); });
+	auto& counterSystem = registry->GetSystem<CounterSystem>();
+	systemScheduler->Add(counterSystem, [&] { counterSystem.Update(this->currentDeaths); });
+	systemScheduler->Run();
+	// Events queued by the systems, such as collisions, and the ones posted from other threads are delivered once they are all done
+	eventManager->DispatchEvents();
 }
 
 void Game::Render()
@@ -187,6 +222,15 @@ void Game::Render()
 	registry->GetSystem<RenderTextSystem>().Update(renderer, assetManager, camera);
 	if (isDebugMode) {
 		registry->GetSystem<RenderBoxColliderSystem>().Update(renderer, camera);
+		// Sprites and batches of the frame, shown in the title when either changes
+		auto& renderSystem = registry->GetSystem<RenderSystem>();
+		if (renderSystem.GetDrawCallCount() != shownDrawCalls || renderSystem.GetSpriteCount() != shownSpriteCount) {
+			shownDrawCalls = renderSystem.GetDrawCallCount();
+			shownSpriteCount = renderSystem.GetSpriteCount();
+			std::string title = "Game Engine - sprites: " + std::to_string(shownSpriteCount)
+				+ ", draw calls: " + std::to_string(shownDrawCalls);
+			SDL_SetWindowTitle(window, title.c_str());
+		}
 	}
 	SDL_RenderPresent(renderer);
 }
@@ -207,6 +251,8 @@ void Game::RunScene()
 			this->millisecsPreviousFrame = SDL_GetTicks();
 		}
 	}
+	eventManager->ClearQueuedEvents();
+	eventManager->ClearSceneSubscriptions();
 	assetManager->ClearAssets();
 	registry->ClearAllEntities();
 }
@@ -235,6 +281,7 @@ Game::~Game()
 	this->renderer = nullptr;
 	this->registry.reset();
 	this->eventManager.reset();
+	this->collisionDispatcher.reset();
 	this->assetManager.reset();
 	this->controllerManager.reset();
 	this->sceneManager.reset();
@@ -13,10 +13,13 @@
 #include <memory>
 #include "../ECS/ECS.hpp"
 #include "../AssetManager/AssetManager.hpp"
+#include "../EventManager/CollisionDispatcher.hpp"
 #include "../EventManager/EventManager.hpp"
 #include "../ControllerManager/ControllerManager.hpp"
 #include "../SceneManager/SceneManager.hpp"
 #include "../AnimationManager/AnimationManager.hpp"
+#include "../JobSystem/JobSystem.hpp"
+#include "../Scheduler/SystemScheduler.hpp"
 
 /**
  * @brief Target frames per second for the game loop
@@ -103,6 +106,16 @@ private:
      */
     bool isDebugMode = false;
     
+    /**
+     * @brief Sprite draw calls shown in the window title in debug mode, -1 if not shown
+     */
+    int shownDrawCalls = -1;
+
+    /**
+     * @brief Sprites shown in the window title in debug mode, -1 if not shown
+     */
+    int shownSpriteCount = -1;
+    
     /**
      * @brief Timestamp of the previous frame for delta time calculation
      */
@@ -158,6 +171,11 @@ public:
      * @brief Event manager for handling game events
      */
     std::unique_ptr<EventManager> eventManager;
+
+    /**
+     * @brief Dispatcher routing collisions to handlers by collision layer
+     */
+    std::unique_ptr<CollisionDispatcher> collisionDispatcher;
     
     /**
      * @brief Controller manager for handling input devices
@@ -178,6 +196,16 @@ public:
      * @brief Animation manager for handling sprite animations
      */
     std::unique_ptr<AnimationManager> animationManager;
+
+    /**
+     * @brief Worker threads shared by the engine
+     */
+    std::unique_ptr<JobSystem> jobSystem;
+
+    /**
+     * @brief Scheduler that runs the per-frame system updates
+     */
+    std::unique_ptr<SystemScheduler> systemScheduler;
     
     /**
      * @brief Gets the singleton instance of the Game class
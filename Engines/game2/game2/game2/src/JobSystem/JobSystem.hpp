@@ -0,0 +1,189 @@
+/**
+ * @file JobSystem.hpp
+ * @brief Work-stealing pool of worker threads that run engine jobs
+ */
+
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class JobSystem
+ * @brief A fixed set of worker threads that share jobs by work stealing.
+ *
+ * Every worker owns a queue. Jobs submitted from a worker go to its own
+ * queue, which it drains newest first; jobs submitted from other threads go
+ * to a shared queue. An idle worker takes the oldest job from another queue,
+ * so a worker that splits a loop into chunks gets help from the rest.
+ *
+ * With no workers, jobs run right away on the calling thread, so code built
+ * on top of it keeps working on single-core machines.
+ */
+class JobSystem {
+public:
+    /**
+     * @brief Default number of items per chunk in ParallelFor.
+     */
+    static constexpr int DEFAULT_CHUNK_SIZE = 512;
+
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param workerCount Number of worker threads to start; 0 runs every job inline
+     */
+    explicit JobSystem(unsigned int workerCount);
+
+    /**
+     * @brief Finishes the queued jobs and joins the workers.
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Queues a job to run on a worker thread.
+     *
+     * @param job The callable to run.
+     */
+    void Submit(std::function<void()> job);
+
+    /**
+     * @brief Runs func(begin, end) over [0, count) split in chunks, and waits for all of them.
+     *
+     * The calling thread runs the first chunk and then helps with queued jobs
+     * until every chunk is done, so it may be called from inside a job. Each
+     * index is visited exactly once; chunks must not depend on each other.
+     *
+     * @tparam TFunc Callable as func(int begin, int end).
+     * @param count Number of items.
+     * @param chunkSize Number of items per job.
+     * @param func The function to call for each chunk.
+     */
+    template <typename TFunc>
+    void ParallelFor(int count, int chunkSize, TFunc func);
+
+    /**
+     * @brief Gets the number of worker threads.
+     *
+     * @return The number of workers, 0 if jobs run inline.
+     */
+    unsigned int GetWorkerCount() const;
+
+    /**
+     * @brief Picks a worker count that leaves one core for the main thread.
+     *
+     * @return The number of hardware threads minus one, or 0 if unknown.
+     */
+    static unsigned int DefaultWorkerCount();
+
+private:
+    /**
+     * @struct JobQueue
+     * @brief A queue of jobs that other threads may steal from.
+     */
+    struct JobQueue {
+        /**
+         * @brief Guards the jobs.
+         */
+        std::mutex mutex;
+
+        /**
+         * @brief Jobs waiting to run.
+         */
+        std::deque<std::function<void()>> jobs;
+    };
+
+    /**
+     * @brief Gets the index of the calling worker in this system.
+     *
+     * @return The worker index, or -1 if called from another thread.
+     */
+    int CurrentWorker() const;
+
+    /**
+     * @brief Runs one queued job, taking it from the own queue or stealing it.
+     *
+     * @param workerIndex Index of the calling worker, or -1.
+     * @return True if a job was run, false if every queue was empty.
+     */
+    bool TryRunJob(int workerIndex);
+
+    /**
+     * @brief Runs queued jobs until a counter reaches zero.
+     *
+     * @param remaining The counter to wait for.
+     */
+    void WaitFor(const std::atomic<int>& remaining);
+
+    /**
+     * @brief Body of each worker: runs jobs until the system stops.
+     *
+     * @param workerIndex Index of the worker and of its queue.
+     */
+    void WorkerLoop(int workerIndex);
+
+    /**
+     * @brief Worker threads owned by the system.
+     */
+    std::vector<std::thread> workers;
+
+    /**
+     * @brief One queue per worker, plus a last one for other threads.
+     */
+    std::vector<std::unique_ptr<JobQueue>> queues;
+
+    /**
+     * @brief Number of jobs in all the queues.
+     */
+    std::atomic<int> queuedJobs{ 0 };
+
+    /**
+     * @brief Guards sleeping and the stopping flag.
+     */
+    std::mutex sleepMutex;
+
+    /**
+     * @brief Wakes workers when a job is queued or the system stops.
+     */
+    std::condition_variable condition;
+
+    /**
+     * @brief Set by the destructor to make the workers exit.
+     */
+    bool stopping = false;
+};
+
+template <typename TFunc>
+void JobSystem::ParallelFor(int count, int chunkSize, TFunc func)
+{
+	if (count <= 0) {
+		return;
+	}
+	const int chunkCount = (count + chunkSize - 1) / chunkSize;
+	if (workers.empty() || chunkCount == 1) {
+		func(0, count);
+		return;
+	}
+	std::atomic<int> remaining(chunkCount - 1);
+	for (int chunk = 1; chunk < chunkCount; chunk++) {
+		const int begin = chunk * chunkSize;
+		const int end = std::min(count, begin + chunkSize);
+		Submit([&func, &remaining, begin, end] {
+			func(begin, end);
+			remaining.fetch_sub(1, std::memory_order_acq_rel);
+		});
+	}
+	func(0, chunkSize);
+	WaitFor(remaining);
+}
+
+#endif // !JOBSYSTEM_HPP
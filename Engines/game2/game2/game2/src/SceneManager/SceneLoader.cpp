@@ -104,13 +104,17 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 			// BoxColliderComponent
 			sol::optional<sol::table> hasBoxCollider = components["box_collider"];
 			if (hasBoxCollider != sol::nullopt) {
+				sol::optional<unsigned int> layer = components["box_collider"]["layer"];
+				sol::optional<unsigned int> mask = components["box_collider"]["mask"];
 				newEntity.AddComponent<BoxColliderComponent>(
 					components["box_collider"]["width"],
 					components["box_collider"]["heigth"],
 					glm::vec2(
 						components["box_collider"]["offset"]["x"],
 						components["box_collider"]["offset"]["y"]
-					)
+					),
+					layer.value_or(LAYER_DEFAULT),
+					mask.value_or(LAYER_ALL)
 				);
 			}
 			// CameraFollowComponent
@@ -127,10 +131,14 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 			// CircleColliderComponent
 			sol::optional<sol::table> hasCircleCollider = components["circle_collider"];
 			if (hasCircleCollider != sol::nullopt) {
+				sol::optional<unsigned int> layer = components["circle_collider"]["layer"];
+				sol::optional<unsigned int> mask = components["circle_collider"]["mask"];
 				newEntity.AddComponent<CircleColliderComponent>(
 					components["circle_collider"]["radius"],
 					components["circle_collider"]["width"],
-					components["circle_collider"]["heigth"]
+					components["circle_collider"]["heigth"],
+					layer.value_or(LAYER_DEFAULT),
+					mask.value_or(LAYER_ALL)
 				);
 			}
 			// ClickableComponent
@@ -191,6 +199,9 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 				lua["on_click"] = sol::nil;
 				lua["update"] = sol::nil;
 				lua["on_collision"] = sol::nil;
+				lua["on_collision_enter"] = sol::nil;
+				lua["on_collision_stay"] = sol::nil;
+				lua["on_collision_exit"] = sol::nil;
 				lua["on_awake"] = sol::nil;
 				lua["enemy_pig_update"] = sol::nil;
 				lua["enemy_turtle_update"] = sol::nil;
@@ -218,6 +229,21 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 				if (hasOnCollision != sol::nullopt) {
 					onCollision = lua["on_collision"];
 				}
+				sol::optional<sol::function> hasOnCollisionEnter = lua["on_collision_enter"];
+				sol::function onCollisionEnter = sol::nil;
+				if (hasOnCollisionEnter != sol::nullopt) {
+					onCollisionEnter = lua["on_collision_enter"];
+				}
+				sol::optional<sol::function> hasOnCollisionStay = lua["on_collision_stay"];
+				sol::function onCollisionStay = sol::nil;
+				if (hasOnCollisionStay != sol::nullopt) {
+					onCollisionStay = lua["on_collision_stay"];
+				}
+				sol::optional<sol::function> hasOnCollisionExit = lua["on_collision_exit"];
+				sol::function onCollisionExit = sol::nil;
+				if (hasOnCollisionExit != sol::nullopt) {
+					onCollisionExit = lua["on_collision_exit"];
+				}
 				sol::optional<sol::function> hasEnemyPigUpdate = lua["enemy_pig_update"];
 				sol::function enemyPigUpdate = sol::nil;
 				if (hasEnemyPigUpdate != sol::nullopt) {
@@ -233,7 +259,9 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities, std:
 				if (hasEnemyBirdUpdate != sol::nullopt) {
 					enemyBirdUpdate = lua["enemy_bird_update"];
 				}
-				newEntity.AddComponent<ScriptComponent>(onCollision, update, onClick, enemyPigUpdate, enemyTurtleUpdate, enemyBirdUpdate);
+				newEntity.AddComponent<ScriptComponent>(std::move(onCollision), std::move(update), std::move(onClick),
+					std::move(enemyPigUpdate), std::move(enemyTurtleUpdate), std::move(enemyBirdUpdate),
+					std::move(onCollisionEnter), std::move(onCollisionStay), std::move(onCollisionExit));
 			}
 
 			sol::optional<sol::table> hasCounter = components["counter"];
@@ -387,7 +415,12 @@ void SceneLoader::LoadColliders(std::unique_ptr<Registry>& registry, tinyxml2::X
 		Entity collider = registry->CreateEntity();
 		collider.AddComponent<TagComponent>(tag);
 		collider.AddComponent<TransformComponent>(glm::vec2(x, y));
-		collider.AddComponent<BoxColliderComponent>(w, h);
+		// Doors and other trigger areas do not block movement
+		bool isTrigger = tag.find("door") != std::string::npos
+			|| tag.find("jumpable") != std::string::npos
+			|| tag.find("slowdown") != std::string::npos;
+		collider.AddComponent<BoxColliderComponent>(w, h, glm::vec2(0),
+			isTrigger ? LAYER_TRIGGER : LAYER_WORLD);
 		if (tag == "ladder") {
 			collider.AddComponent<RigidBodyComponent>(false, false, 0);
 		}
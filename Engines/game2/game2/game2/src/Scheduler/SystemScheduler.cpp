@@ -0,0 +1,121 @@
+#include "SystemScheduler.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+SystemScheduler::SystemScheduler(JobSystem& jobSystem)
+	: jobSystem(jobSystem)
+{
+}
+
+void SystemScheduler::Add(const System& system, std::function<void()> update)
+{
+	Task task;
+	task.system = &system;
+	task.update = std::move(update);
+	tasks.push_back(std::move(task));
+}
+
+void SystemScheduler::SetSingleThreaded(bool singleThreaded)
+{
+	this->singleThreaded = singleThreaded;
+}
+
+bool SystemScheduler::Conflicts(const System& first, const System& second)
+{
+	if (first.IsExclusive() || second.IsExclusive()) {
+		return true;
+	}
+	const Signature firstAccess = first.GetReadSignature() | first.GetWriteSignature();
+	const Signature secondAccess = second.GetReadSignature() | second.GetWriteSignature();
+	return (first.GetWriteSignature() & secondAccess).any()
+		|| (second.GetWriteSignature() & firstAccess).any();
+}
+
+void SystemScheduler::RunSequentially()
+{
+	for (auto& task : tasks) {
+		task.update();
+	}
+	tasks.clear();
+}
+
+void SystemScheduler::Run()
+{
+	if (singleThreaded || jobSystem.GetWorkerCount() == 0) {
+		RunSequentially();
+		return;
+	}
+
+	const int taskCount = static_cast<int>(tasks.size());
+	for (int later = 0; later < taskCount; later++) {
+		for (int earlier = 0; earlier < later; earlier++) {
+			if (Conflicts(*tasks[earlier].system, *tasks[later].system)) {
+				tasks[earlier].dependents.push_back(later);
+				tasks[later].dependencyCount++;
+			}
+		}
+	}
+
+	std::unique_ptr<std::atomic<int>[]> pending(new std::atomic<int>[taskCount]);
+	for (int i = 0; i < taskCount; i++) {
+		pending[i] = tasks[i].dependencyCount;
+	}
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<int> mainThreadTasks;
+	int finished = 0;
+
+	// Tasks are released when their last dependency finishes; exclusive ones
+	// go back to the calling thread, the rest to the workers.
+	std::function<void(int)> finish;
+	auto dispatch = [&](int index) {
+		if (tasks[index].system->IsExclusive()) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				mainThreadTasks.push_back(index);
+			}
+			condition.notify_one();
+			return;
+		}
+		jobSystem.Submit([&, index] {
+			tasks[index].update();
+			finish(index);
+		});
+	};
+	finish = [&](int index) {
+		for (int dependent : tasks[index].dependents) {
+			if (--pending[dependent] == 0) {
+				dispatch(dependent);
+			}
+		}
+		// Notify under the lock: once Run sees the last task finished it
+		// returns and destroys the condition variable.
+		std::lock_guard<std::mutex> lock(mutex);
+		finished++;
+		condition.notify_one();
+	};
+
+	for (int i = 0; i < taskCount; i++) {
+		if (tasks[i].dependencyCount == 0) {
+			dispatch(i);
+		}
+	}
+	while (true) {
+		int index;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [&] { return !mainThreadTasks.empty() || finished == taskCount; });
+			if (mainThreadTasks.empty()) {
+				break;
+			}
+			index = mainThreadTasks.back();
+			mainThreadTasks.pop_back();
+		}
+		tasks[index].update();
+		finish(index);
+	}
+	tasks.clear();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file SystemScheduler.hpp
+ * @brief Runs the per-frame system updates concurrently when their accesses allow it
+ */
+
+#ifndef SYSTEMSCHEDULER_HPP
+#define SYSTEMSCHEDULER_HPP
+#include <functional>
+#include <vector>
+#include "../ECS/ECS.hpp"
+#include "../JobSystem/JobSystem.hpp"
+
+/**
+ * @class SystemScheduler
+ * @brief Builds a dependency graph of system updates and runs it on a job system.
+ *
+ * Updates are added in the order they would run sequentially. Two updates
+ * conflict when one writes a component the other reads or writes, or when
+ * either system is exclusive; a later update waits for every earlier one it
+ * conflicts with, so the result matches the sequential order. Updates that do
+ * not conflict run at the same time on the workers, while exclusive systems
+ * always run on the calling thread.
+ */
+class SystemScheduler {
+public:
+    /**
+     * @brief Creates a scheduler that runs on the given job system.
+     *
+     * @param jobSystem The workers used for non-exclusive systems.
+     */
+    explicit SystemScheduler(JobSystem& jobSystem);
+
+    /**
+     * @brief Queues a system update for the next Run.
+     *
+     * @param system The system being updated, used for its declared accesses.
+     * @param update Callable that performs the update.
+     */
+    void Add(const System& system, std::function<void()> update);
+
+    /**
+     * @brief Runs every queued update and waits for all of them to finish.
+     *
+     * The queue is empty afterwards.
+     */
+    void Run();
+
+    /**
+     * @brief Enables the deterministic single-threaded mode.
+     *
+     * Every update then runs on the calling thread, in the order it was added.
+     *
+     * @param singleThreaded True to run sequentially, false to run in parallel.
+     */
+    void SetSingleThreaded(bool singleThreaded);
+
+private:
+    /**
+     * @struct Task
+     * @brief A queued system update and its place in the dependency graph.
+     */
+    struct Task {
+        /**
+         * @brief The system being updated.
+         */
+        const System* system;
+
+        /**
+         * @brief Callable that performs the update.
+         */
+        std::function<void()> update;
+
+        /**
+         * @brief Tasks that must wait for this one.
+         */
+        std::vector<int> dependents;
+
+        /**
+         * @brief Number of earlier tasks this one waits for.
+         */
+        int dependencyCount = 0;
+    };
+
+    /**
+     * @brief Checks if two systems may not run at the same time.
+     *
+     * @param first The first system.
+     * @param second The second system.
+     * @return True if their accesses conflict, false otherwise.
+     */
+    static bool Conflicts(const System& first, const System& second);
+
+    /**
+     * @brief Runs every task in order on the calling thread.
+     */
+    void RunSequentially();
+
+    /**
+     * @brief Workers used for non-exclusive systems.
+     */
+    JobSystem& jobSystem;
+
+    /**
+     * @brief Updates queued for the next Run.
+     */
+    std::vector<Task> tasks;
+
+    /**
+     * @brief Whether updates run sequentially on the calling thread.
+     */
+    bool singleThreaded = false;
+};
+
+#endif // !SYSTEMSCHEDULER_HPP
@@ -26,11 +26,13 @@ public:
      * 
      * Initializes the animation system and specifies the required components.
      * Entities must have both AnimationComponent and SpriteComponent to be
-     * processed by this system.
+     * processed by this system. Both are written, and nothing else is touched,
+     * so it may run in parallel with other systems.
      */
     AnimationSystem() {
         RequiredComponent<AnimationComponent>();
         RequiredComponent<SpriteComponent>();
+        SetExclusive(false);
     }
     
     /**
@@ -47,16 +49,19 @@ public:
      * 
      * The sprite's source rectangle x-coordinate is updated to:
      * srcRect.x = currentFrame * spriteWidth
+     * 
+     * Entities are independent, so they are split in chunks across the job system.
+     * 
+     * @param jobSystem Workers that run the chunks
      */
-    void Update() {
-        for (auto entity : GetSystemEntiities()) {
-            auto& animation = entity.GetComponent<AnimationComponent>();
-            auto& sprite = entity.GetComponent<SpriteComponent>();
-            
-            animation.currentFrame = ((SDL_GetTicks() - animation.startTime)
+    void Update(JobSystem& jobSystem) {
+        const Uint32 currentTime = SDL_GetTicks();
+        registry->GetView<AnimationComponent, SpriteComponent>().ParallelEach(jobSystem,
+            [currentTime](Entity, AnimationComponent& animation, SpriteComponent& sprite) {
+            animation.currentFrame = ((currentTime - animation.startTime)
                 * animation.frameSpeedRate / 1000) % animation.numFrames;
             sprite.srcRect.x = animation.currentFrame * sprite.width;
-        }
+        });
     }
 };
 
@@ -6,47 +6,173 @@
 #ifndef BOXCOLLISIONSYSTEM_HPP
 #define BOXCOLLISIONSYSTEM_HPP
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include "../Components/BoxColliderComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
 #include "../Components/ScriptComponent.hpp"
+#include "../Components/TagComponent.hpp"
 #include "../Components/TransformComponent.hpp"
+#include "../EventManager/CollisionDispatcher.hpp"
 #include "../EventManager/EventManager.hpp"
 #include "../Events/CollisionEvent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../JobSystem/JobSystem.hpp"
+#include "../Utils/AABBTree.hpp"
+#include "../Utils/ContactBuffers.hpp"
+#include "../Utils/ContactCache.hpp"
+#include "../Utils/NarrowPhase.hpp"
+
+/**
+ * @struct BoxContact
+ * @brief Pair of box colliders overlapping in the current frame
+ */
+struct BoxContact {
+    Entity a;              ///< Entity with the lower id
+    Entity b;              ///< Entity with the higher id
+    unsigned int aLayer;   ///< Collision layer of a
+    unsigned int bLayer;   ///< Collision layer of b
+};
+
+/**
+ * @struct RaycastHit
+ * @brief First collider hit by a segment
+ */
+struct RaycastHit {
+    Entity entity;    ///< Entity owning the collider that was hit
+    float x;          ///< X coordinate where the segment enters the collider
+    float y;          ///< Y coordinate where the segment enters the collider
+    float fraction;   ///< Fraction of the segment before the hit, 0 if it starts inside
+};
 
 /**
  * @class BoxCollisionSystem
  * @brief System responsible for detecting collisions between box colliders
  * 
  * This system performs collision detection between all entities that have both
- * BoxColliderComponent and TransformComponent. When collisions are detected,
- * it emits collision events and triggers script callbacks if entities have
- * ScriptComponent with collision handlers.
+ * BoxColliderComponent and TransformComponent. A dynamic AABB tree is used as
+ * broadphase, so only boxes close to a moving collider are tested and the
+ * static level colliders are never tested against each other, nor are
+ * colliders whose layers and masks do not match. The candidate pairs are
+ * then tested in batches by the SIMD kernels of NarrowPhase. Both steps run
+ * on the worker threads, split in chunks of colliders that each fill their
+ * own ContactBuffers buffer.
+ *
+ * A frame runs in two steps. DetectContacts collects the overlapping pairs,
+ * which a resolver such as OverlapSystem can then separate, and
+ * ReportContacts emits collision events, dispatches them by layer and
+ * triggers script callbacks if entities have ScriptComponent with collision
+ * handlers, so scripts see the resolved positions and velocities.
+ * A contact cache remembers the touching pairs between frames, so scripts can
+ * react only when a contact starts or ends instead of on every frame.
+ *
+ * The broadphase also answers spatial queries from gameplay code and scripts,
+ * such as the colliders inside an area, the first one along a segment or the
+ * closest one with a tag. Queries see the boxes set by the last
+ * DetectContacts, before overlaps were resolved.
  */
 class BoxCollisionSystem : public System {
 private:
     /**
-     * @brief Checks if two axis-aligned bounding boxes are colliding
-     * 
-     * Uses the separating axis theorem to determine if two rectangles overlap.
-     * Returns true if the rectangles intersect, false otherwise.
-     * 
-     * @param aX X position of first rectangle
-     * @param aY Y position of first rectangle
-     * @param aW Width of first rectangle
-     * @param aH Height of first rectangle
-     * @param bX X position of second rectangle
-     * @param bY Y position of second rectangle
-     * @param bW Width of second rectangle
-     * @param bH Height of second rectangle
-     * @return true if rectangles are colliding, false otherwise
-     */
-    bool CheckCollision(float aX, float aY, float aW, float aH, float bX, float bY, float bW, float bH) {
-        return(
-            aX < bX + bW &&
-            aX + aW > bX &&
-            aY < bY + bH &&
-            aY + aH > bY
-        );
+     * @brief Entities checked during the current frame, indexed by entity id
+     * 
+     * Kept as a member so its storage is reused between frames.
+     */
+    std::vector<Entity> colliders;
+
+    /**
+     * @brief Collision layer of each collider this frame, indexed by entity id
+     */
+    std::vector<unsigned int> layers;
+
+    /**
+     * @brief Broadphase holding the box of every collider
+     * 
+     * Persists between frames so static colliders are only inserted once.
+     */
+    AABBBroadphase broadphase;
+
+    /**
+     * @brief Candidate pairs and narrowphase results of each chunk of colliders
+     */
+    ContactBuffers contactBuffers;
+
+    /**
+     * @brief Pairs of entity ids that overlap this frame, merged from the chunks
+     */
+    std::vector<std::pair<int, int>> contactPairs;
+
+    /**
+     * @brief Bounds of every collider this frame, stored as arrays for the batched test
+     */
+    BoxBatch boxes;
+
+    /**
+     * @brief Overlapping pairs found by the last DetectContacts, in order of entity id
+     */
+    std::vector<BoxContact> frameContacts;
+
+    /**
+     * @brief Pairs touching in the previous frame, used to report enter, stay and exit
+     */
+    ContactCache contacts;
+
+    /**
+     * @brief Checks if an entity is alive and was checked as a collider this frame
+     * 
+     * @param entity The entity to check
+     * @return true if the entity still has a collider
+     */
+    bool IsCollider(Entity entity) const {
+        return entity.IsAlive() && broadphase.Has(entity.GetId()) && colliders[entity.GetId()] == entity;
+    }
+
+    /**
+     * @brief Checks if a collider is not expected to move
+     * 
+     * Entities without a rigid body, or with a kinematic one that is not
+     * moving, such as the colliders loaded from the TMX map, are static.
+     * 
+     * @param entity The entity owning the collider
+     * @return true if the collider is static
+     */
+    static bool IsStatic(Entity entity) {
+        if (!entity.HasComponent<RigidBodyComponent>()) {
+            return true;
+        }
+        const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+        return !rigidbody.isDynamic && rigidbody.velocity == glm::vec2(0);
+    }
+
+    /**
+     * @brief Checks if a collider found by a query belongs to a live entity in one of the layers of a mask
+     * 
+     * @param id The id of the collider in the broadphase
+     * @param mask The collision layers to accept
+     * @return true if the collider can be returned by the query
+     */
+    bool Matches(int id, unsigned int mask) const {
+        return (layers[id] & mask) != 0 && colliders[id].IsAlive();
+    }
+
+    /**
+     * @brief Calls a collision callback of an entity's script, if it has one
+     * 
+     * @param lua Lua state used for script execution
+     * @param entity The entity whose script is called, set as "this"
+     * @param other The other entity of the contact, passed to the callback
+     * @param callback Member of ScriptComponent holding the callback
+     */
+    static void CallScript(sol::state& lua, Entity entity, Entity other, sol::function ScriptComponent::*callback) {
+        if (!entity.HasComponent<ScriptComponent>()) {
+            return;
+        }
+        const auto& function = entity.GetComponent<ScriptComponent>().*callback;
+        if (function != sol::nil) {
+            lua["this"] = entity;
+            function(other);
+        }
     }
     
 public:
@@ -63,63 +189,197 @@ public:
     }
     
     /**
-     * @brief Updates collision detection for all entities in the system
+     * @brief Finds the pairs of colliders that overlap in the current frame
      * 
-     * Performs pairwise collision detection between all entities with the required
-     * components. When collisions are detected, emits CollisionEvent and triggers
-     * script callbacks for entities that have ScriptComponent with onCollision handlers.
+     * Updates the box of every collider in the broadphase and only tests the
+     * pairs whose boxes overlap, whose layers match and where at least one
+     * collider moves. Boxes that only touch do not overlap. Nothing is moved
+     * or notified, so the result does not depend on the order of the pairs.
      * 
-     * @param lua Lua state used for script execution
-     * @param eventManager Event manager for emitting collision events
+     * The broadphase queries and the narrowphase run on the workers, and the
+     * pairs of every chunk are merged and sorted by entity id afterwards.
+     * 
+     * @param jobSystem Workers that run the chunks
      */
-    void Update(sol::state& lua, const std::unique_ptr<EventManager>& eventManager) {
-        auto entities = GetSystemEntiities();
+    void DetectContacts(JobSystem& jobSystem) {
+        auto view = registry->GetView<BoxColliderComponent, TransformComponent>();
+        view.Each([this](Entity entity, BoxColliderComponent& collider, TransformComponent& transform) {
+            const int id = entity.GetId();
+            if (static_cast<size_t>(id) >= colliders.size()) {
+                colliders.resize(id + 100);
+                layers.resize(id + 100);
+            }
+            colliders[id] = entity;
+            layers[id] = collider.layer;
+            AABB box;
+            box.minX = transform.position.x;
+            box.minY = transform.position.y;
+            box.maxX = transform.position.x + collider.width;
+            box.maxY = transform.position.y + collider.heigth;
+            broadphase.Set(id, box, IsStatic(entity), collider.layer, collider.mask);
+            boxes.Set(id, box.minX, box.minY, box.maxX, box.maxY);
+        });
+        // Killed entities and entities that lost a component were not set this frame
+        broadphase.RemoveStale();
+        contactBuffers.Run(jobSystem, broadphase.GetProxyCount(), [this](int begin, int end, ContactBuffers::Buffer& buffer) {
+            buffer.pairs.clear();
+            broadphase.QueryPairs(begin, end, buffer.pairs);
+            NarrowPhase::TestBoxes(boxes, buffer.pairs, buffer.hits);
+        });
+        contactBuffers.Merge(contactPairs);
         
-        // Check collisions between all pairs of entities
-        for (auto i = entities.begin(); i != entities.end(); i++) {
-            Entity a = *i;
-            const auto& aCollider = a.GetComponent<BoxColliderComponent>();
-            const auto& aTranform = a.GetComponent<TransformComponent>();
-            
-            for (auto j = i; j != entities.end(); j++) {
-                Entity b = *j;
-                if (a == b) {
-                    continue;
-                }
-                
-                const auto& bCollider = b.GetComponent<BoxColliderComponent>();
-                const auto& bTranform = b.GetComponent<TransformComponent>();
-                
-                // Check if entities are colliding
-                bool collision = CheckCollision(
-                    aTranform.position.x, aTranform.position.y, static_cast<float>(aCollider.width), static_cast<float>(aCollider.heigth),
-                    bTranform.position.x, bTranform.position.y, static_cast<float>(bCollider.width), static_cast<float>(bCollider.heigth)
-                );
-                
-                if (collision) {
-                    // Emit collision event
-                    eventManager->EmitEvent<CollisionEvent>(a, b);
-                    
-                    // Trigger script callback for entity A
-                    if (a.HasComponent<ScriptComponent>()) {
-                        const auto& script = a.GetComponent<ScriptComponent>();
-                        if (script.onCollision != sol::nil) {
-                            lua["this"] = a;
-                            script.onCollision(b);
-                        }
-                    }
-                    
-                    // Trigger script callback for entity B
-                    if (b.HasComponent<ScriptComponent>()) {
-                        const auto& script = b.GetComponent<ScriptComponent>();
-                        if (script.onCollision != sol::nil) {
-                            lua["this"] = b;
-                            script.onCollision(a);
-                        }
-                    }
-                }
+        frameContacts.clear();
+        for (const auto& pair : contactPairs) {
+            frameContacts.push_back({ colliders[pair.first], colliders[pair.second], layers[pair.first], layers[pair.second] });
+        }
+    }
+
+    /**
+     * @brief Gets the pairs found by the last DetectContacts
+     * 
+     * @return The overlapping pairs, sorted by entity id
+     */
+    const std::vector<BoxContact>& GetContacts() const {
+        return frameContacts;
+    }
+
+    /**
+     * @brief Finds the colliders that overlap or touch a box
+     * 
+     * @param box The box to search
+     * @param mask The collision layers to search
+     * @param result Receives the entities found, after its previous content
+     */
+    void QueryBox(const AABB& box, unsigned int mask, std::vector<Entity>& result) const {
+        broadphase.Query(box, [&](int id) {
+            if (Matches(id, mask)) {
+                result.push_back(colliders[id]);
+            }
+        });
+    }
+
+    /**
+     * @brief Finds the colliders that overlap or touch a circle
+     * 
+     * @param x X coordinate of the center of the circle
+     * @param y Y coordinate of the center of the circle
+     * @param radius Radius of the circle
+     * @param mask The collision layers to search
+     * @param result Receives the entities found, after its previous content
+     */
+    void QueryRadius(float x, float y, float radius, unsigned int mask, std::vector<Entity>& result) const {
+        AABB box;
+        box.minX = x - radius;
+        box.minY = y - radius;
+        box.maxX = x + radius;
+        box.maxY = y + radius;
+        broadphase.Query(box, [&](int id) {
+            if (broadphase.GetBox(id).DistanceSquared(x, y) <= radius * radius && Matches(id, mask)) {
+                result.push_back(colliders[id]);
             }
+        });
+    }
+
+    /**
+     * @brief Finds the first collider along a segment
+     * 
+     * Colliders the segment starts inside are hit at its start. When several
+     * colliders are hit at the same point, the one with the lowest entity id
+     * is returned.
+     * 
+     * @param x0 X coordinate of the start of the segment
+     * @param y0 Y coordinate of the start of the segment
+     * @param x1 X coordinate of the end of the segment
+     * @param y1 Y coordinate of the end of the segment
+     * @param mask The collision layers the segment can hit
+     * @param hit Receives the first collider hit
+     * @return true if the segment hits a collider
+     */
+    bool Raycast(float x0, float y0, float x1, float y1, unsigned int mask, RaycastHit& hit) const {
+        int id;
+        float fraction;
+        if (!broadphase.RayCast(x0, y0, x1, y1, [&](int id) { return Matches(id, mask); }, id, fraction)) {
+            return false;
+        }
+        hit.entity = colliders[id];
+        hit.x = x0 + (x1 - x0) * fraction;
+        hit.y = y0 + (y1 - y0) * fraction;
+        hit.fraction = fraction;
+        return true;
+    }
+
+    /**
+     * @brief Finds the collider with a tag that is closest to a point
+     * 
+     * Distances are measured to the closest point of each box, so a point
+     * inside a collider is at distance 0 from it.
+     * 
+     * @param x X coordinate of the point
+     * @param y Y coordinate of the point
+     * @param tag The tag the entity must have
+     * @param exclude Entity that is never returned, such as the one searching
+     * @param result Receives the closest entity
+     * @return true if a collider with the tag was found
+     */
+    bool Nearest(float x, float y, const std::string& tag, Entity exclude, Entity& result) const {
+        int id;
+        auto filter = [&](int id) {
+            const Entity& entity = colliders[id];
+            return entity != exclude && Matches(id, LAYER_ALL) && entity.HasComponent<TagComponent>()
+                && entity.GetComponent<TagComponent>().tag == tag;
+        };
+        if (!broadphase.Nearest(x, y, filter, id)) {
+            return false;
         }
+        result = colliders[id];
+        return true;
+    }
+
+    /**
+     * @brief Notifies the collisions found by the last DetectContacts
+     * 
+     * Queues a CollisionEvent for each pair, dispatches it to the handlers of
+     * both layers and triggers script callbacks for entities that have
+     * ScriptComponent with onCollision handlers. Pairs are handled in order
+     * of entity id.
+     * 
+     * On top of onCollision, which runs every frame of a contact, scripts get
+     * onCollisionEnter on the first frame of a contact, onCollisionStay on the
+     * following ones and onCollisionExit on the frame after the pair stops
+     * touching. Exits are only reported while both entities are alive and
+     * still have a collider.
+     * 
+     * @param lua Lua state used for script execution
+     * @param eventManager Event manager queueing the collision events
+     * @param collisionDispatcher Dispatcher routing collisions by layer
+     */
+    void ReportContacts(sol::state& lua, const std::unique_ptr<EventManager>& eventManager,
+                        const std::unique_ptr<CollisionDispatcher>& collisionDispatcher) {
+        contacts.Begin();
+        for (const BoxContact& contact : frameContacts) {
+            Entity a = contact.a;
+            Entity b = contact.b;
+            eventManager->QueueEvent<CollisionEvent>(a, b);
+            collisionDispatcher->Dispatch(a, contact.aLayer, b, contact.bLayer);
+            
+            // Trigger script callbacks for both entities
+            CallScript(lua, a, b, &ScriptComponent::onCollision);
+            CallScript(lua, b, a, &ScriptComponent::onCollision);
+            auto callback = contacts.Add(a, b) == ContactState::Enter
+                ? &ScriptComponent::onCollisionEnter
+                : &ScriptComponent::onCollisionStay;
+            CallScript(lua, a, b, callback);
+            CallScript(lua, b, a, callback);
+        }
+        
+        // Pairs touching last frame and not this one
+        contacts.End([&](const ContactCache::Contact& contact) {
+            if (!IsCollider(contact.a) || !IsCollider(contact.b)) {
+                return;
+            }
+            CallScript(lua, contact.a, contact.b, &ScriptComponent::onCollisionExit);
+            CallScript(lua, contact.b, contact.a, &ScriptComponent::onCollisionExit);
+        });
     }
 };
 #endif // !BOXCOLLISIONSYSTEM_HPP
\ No newline at end of file
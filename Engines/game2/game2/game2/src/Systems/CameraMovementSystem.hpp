@@ -27,11 +27,14 @@ public:
      * 
      * Initializes the camera movement system and specifies the required components.
      * Entities must have both CameraFollowComponent and TransformComponent to be
-     * processed by this system for camera following behavior.
+     * processed by this system for camera following behavior. Components are
+     * only read; the camera it writes is not touched by any other update, so
+     * it may run in parallel with other systems.
      */
     CameraMovementSystem() {
-        RequiredComponent<CameraFollowComponent>();
-        RequiredComponent<TransformComponent>();
+        RequiredComponent<CameraFollowComponent>(ComponentAccess::Read);
+        RequiredComponent<TransformComponent>(ComponentAccess::Read);
+        SetExclusive(false);
     }
     
     /**
@@ -6,11 +6,19 @@
 #ifndef CIRCLECOLLISIONSYSTEM_HPP
 #define CIRCLECOLLISIONSYSTEM_HPP
 #include <memory>
+#include <utility>
+#include <vector>
 #include "../ECS/ECS.hpp"
 #include "../Components/CircleColliderComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
 #include "../Components/TransformComponent.hpp"
+#include "../EventManager/CollisionDispatcher.hpp"
 #include "../EventManager/EventManager.hpp"
 #include "../Events/CollisionEvent.hpp"
+#include "../JobSystem/JobSystem.hpp"
+#include "../Utils/AABBTree.hpp"
+#include "../Utils/ContactBuffers.hpp"
+#include "../Utils/NarrowPhase.hpp"
 
 /**
  * @class CircleCollisionSystem
@@ -18,6 +26,11 @@
  * 
  * This system processes entities that have both CircleColliderComponent and TransformComponent,
  * checking for collisions between circular shapes and emitting collision events when detected.
+ * A dynamic AABB tree selects the pairs whose bounding boxes overlap, so the circle test only
+ * runs on nearby colliders and never between two colliders that do not move or whose layers
+ * and masks do not match. The circles are copied into arrays so the candidate pairs are tested
+ * in batches by the SIMD kernels of NarrowPhase. The search runs on the worker threads and the
+ * events are sent afterwards from the calling thread.
  */
 class CircleCollisionSystem : public System {
 public:
@@ -34,44 +47,65 @@ public:
     /**
      * @brief Updates the collision system and checks for collisions between entities
      * 
-     * Iterates through all entities with required components, performs collision detection
-     * between circular colliders, and emits collision events when collisions are detected.
+     * Computes the world-space center and scaled radius of every collider once per
+     * frame and feeds their bounding boxes to the AABB tree broadphase. The
+     * circle test then only runs on the pairs it reports, several pairs at a time
+     * with the same rounding as CheckCircularCollision, and a collision event is
+     * queued and dispatched by layer for each collision, in order of entity id.
      * 
-     * @param eventManager Unique pointer to the event manager for emitting collision events
+     * The broadphase queries and the circle tests run on the workers in chunks
+     * of colliders, and only once every chunk is done are the collisions
+     * merged and sent, so handlers always run on the calling thread.
+     * 
+     * @param eventManager Unique pointer to the event manager queueing the collision events
+     * @param collisionDispatcher Unique pointer to the dispatcher routing collisions by layer
+     * @param jobSystem Workers that run the chunks
      */
-    void Update(std::unique_ptr<EventManager>& eventManager) {
-        auto entities = GetSystemEntiities();
-        for (auto i = entities.begin(); i != entities.end(); i++) {
-            Entity a = *i;
-            auto aCollider = a.GetComponent<CircleColliderComponent>();
-            auto aTranform = a.GetComponent<TransformComponent>();
-            for (auto j = i; j != entities.end(); j++) {
-                Entity b = *j;
-                if (a == b) {
-                    continue;
-                }
-                auto bCollider = b.GetComponent<CircleColliderComponent>();
-                auto bTranform = b.GetComponent<TransformComponent>();
-                
-                // Calculate center positions accounting for scale
-                glm::vec2 aCenterPos = glm::vec2(
-                    aTranform.position.x - (aCollider.width / 2) * aTranform.scale.x,
-                    aTranform.position.y - (aCollider.height / 2) * aTranform.scale.y
-                );
-                glm::vec2 bCenterPos = glm::vec2(
-                    bTranform.position.x - (bCollider.width / 2) * bTranform.scale.x,
-                    bTranform.position.y - (bCollider.height / 2) * bTranform.scale.y
-                );
-                
-                // Calculate scaled radii
-                int aRadius = aCollider.radius * aTranform.scale.x;
-                int bRadius = bCollider.radius * bTranform.scale.x;
-                
-                bool collision = CheckCircularCollision(aRadius, bRadius, aCenterPos, bCenterPos);
-                if (collision) {
-                    eventManager->EmitEvent<CollisionEvent>(a, b);
-                }
+    void Update(std::unique_ptr<EventManager>& eventManager, std::unique_ptr<CollisionDispatcher>& collisionDispatcher,
+                JobSystem& jobSystem) {
+        auto view = registry->GetView<CircleColliderComponent, TransformComponent>();
+        view.Each([this](Entity entity, CircleColliderComponent& collider, TransformComponent& transform) {
+            const int id = entity.GetId();
+            if (static_cast<size_t>(id) >= bodies.size()) {
+                bodies.resize(id + 100);
+            }
+            Body& body = bodies[id];
+            body.entity = entity;
+            body.layer = collider.layer;
+            
+            // Calculate center position and radius accounting for scale
+            body.center = glm::vec2(
+                transform.position.x - (collider.width / 2) * transform.scale.x,
+                transform.position.y - (collider.height / 2) * transform.scale.y
+            );
+            body.radius = static_cast<int>(collider.radius * transform.scale.x);
+            AABB box;
+            box.minX = body.center.x - body.radius;
+            box.minY = body.center.y - body.radius;
+            box.maxX = body.center.x + body.radius;
+            box.maxY = body.center.y + body.radius;
+            bool isStatic = !entity.HasComponent<RigidBodyComponent>();
+            if (!isStatic) {
+                const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+                isStatic = !rigidbody.isDynamic && rigidbody.velocity == glm::vec2(0);
             }
+            broadphase.Set(id, box, isStatic, collider.layer, collider.mask);
+            circles.Set(id, body.center.x, body.center.y, static_cast<float>(body.radius));
+        });
+        // Killed entities and entities that lost a component were not set this frame
+        broadphase.RemoveStale();
+        contactBuffers.Run(jobSystem, broadphase.GetProxyCount(), [this](int begin, int end, ContactBuffers::Buffer& buffer) {
+            buffer.pairs.clear();
+            broadphase.QueryPairs(begin, end, buffer.pairs);
+            NarrowPhase::TestCircles(circles, buffer.pairs, buffer.hits);
+        });
+        contactBuffers.Merge(contactPairs);
+        
+        for (const auto& pair : contactPairs) {
+            const Body& a = bodies[pair.first];
+            const Body& b = bodies[pair.second];
+            eventManager->QueueEvent<CollisionEvent>(a.entity, b.entity);
+            collisionDispatcher->Dispatch(a.entity, a.layer, b.entity, b.layer);
         }
     }
 
@@ -79,7 +113,8 @@ public:
      * @brief Checks if two circular colliders are colliding
      * 
      * Performs distance-based collision detection between two circles by comparing
-     * the distance between their centers with the sum of their radii.
+     * the squared distance between their centers with the squared sum of their
+     * radii, so no square root is needed.
      * 
      * @param aRadius Radius of the first circle
      * @param bRadius Radius of the second circle
@@ -89,10 +124,47 @@ public:
      */
     bool CheckCircularCollision(int aRadius, int bRadius, glm::vec2 aPos, glm::vec2 bPos) {
         glm::vec2 dif = aPos - bPos;
-        double length = glm::sqrt((dif.x * dif.x) + (dif.y * dif.y));
+        double lengthSquared = (dif.x * dif.x) + (dif.y * dif.y);
+        double radii = aRadius + bRadius;
         // Hay colisión si la suma de los radios es mayor a la distancia entre centros
-        return (aRadius + bRadius) >= length;
+        return radii >= 0 && radii * radii >= lengthSquared;
     }
+
+private:
+    /**
+     * @brief World-space circle of a collider for the current frame
+     */
+    struct Body {
+        Entity entity;      ///< Entity owning the collider
+        glm::vec2 center;   ///< Center of the circle in world space
+        int radius = 0;     ///< Radius scaled by the transform
+        unsigned int layer = 0;   ///< Collision layer of the collider
+    };
+
+    /**
+     * @brief Circles of the current frame indexed by entity id, reused between frames
+     */
+    std::vector<Body> bodies;
+
+    /**
+     * @brief Broadphase holding the bounding box of every circle
+     */
+    AABBBroadphase broadphase;
+
+    /**
+     * @brief Candidate pairs and circle test results of each chunk of colliders
+     */
+    ContactBuffers contactBuffers;
+
+    /**
+     * @brief Pairs of entity ids that collide this frame, merged from the chunks
+     */
+    std::vector<std::pair<int, int>> contactPairs;
+
+    /**
+     * @brief Circles of the current frame as arrays, for the batched test
+     */
+    CircleBatch circles;
 };
 
 #endif // !CIRCLECOLLISIONSYSTEM_HPP
\ No newline at end of file
@@ -22,11 +22,13 @@ public:
     /**
      * @brief Constructor for CounterSystem
      * 
-     * Sets up the required components for this system: CounterComponent and TextComponent
+     * Sets up the required components for this system: CounterComponent and TextComponent.
+     * Only the text is written, so it may run in parallel with other systems.
      */
     CounterSystem() {
-        RequiredComponent<CounterComponent>();
+        RequiredComponent<CounterComponent>(ComponentAccess::Read);
         RequiredComponent<TextComponent>();
+        SetExclusive(false);
     }
 
     /**
@@ -23,11 +23,13 @@ public:
     /**
      * @brief Constructor for MovementSystem
      * 
-     * Sets up the required components for this system: RigidBodyComponent and TransformComponent
+     * Sets up the required components for this system: RigidBodyComponent and TransformComponent.
+     * Both are written, and nothing else is touched, so it may run in parallel with other systems.
      */
     MovementSystem() {
         RequiredComponent<RigidBodyComponent>();
         RequiredComponent<TransformComponent>();
+        SetExclusive(false);
     }
 
     /**
@@ -36,14 +38,14 @@ public:
      * Iterates through all entities with required components and updates their positions
      * based on their physics properties. For dynamic bodies, applies force-based physics
      * with acceleration and mass calculations. For static bodies, applies simple velocity-based movement.
+     * Entities are independent, so they are split in chunks across the job system.
      * 
      * @param dt Delta time in seconds since the last update
+     * @param jobSystem Workers that run the chunks
      */
-    void Update(double dt) {
-        for (auto entity : GetSystemEntiities()) {
-            auto& rigidBody = entity.GetComponent<RigidBodyComponent>();
-            auto& transform = entity.GetComponent<TransformComponent>();
-            
+    void Update(double dt, JobSystem& jobSystem) {
+        registry->GetView<RigidBodyComponent, TransformComponent>().ParallelEach(jobSystem,
+            [dt](Entity, RigidBodyComponent& rigidBody, TransformComponent& transform) {
             // Store previous position for collision detection or interpolation
             transform.previousPosition = transform.position;
             
@@ -61,7 +63,7 @@ public:
                 transform.position.x += rigidBody.velocity.x * dt;
                 transform.position.y += rigidBody.velocity.y * dt;
             }
-        }
+        });
     }
 };
 
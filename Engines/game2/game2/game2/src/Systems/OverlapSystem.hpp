@@ -6,15 +6,14 @@
 #ifndef OVERLAPSYSTEM_HPP
 #define OVERLAPSYSTEM_HPP
 
-#include <memory>
-#include <string>
+#include <vector>
 
 #include "../Components/BoxColliderComponent.hpp"
+#include "../Components/CollisionLayer.hpp"
 #include "../Components/RigidBodyComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
-#include "../EventManager/EventManager.hpp"
-#include "../Events/CollisionEvent.hpp"
+#include "BoxCollisionSystem.hpp"
 
 /**
  * @enum Direction
@@ -28,98 +27,90 @@ enum Direction {top, left, bottom, right};
  * 
  * This system processes entities with BoxColliderComponent, RigidBodyComponent, and TransformComponent,
  * handling collision resolution by repositioning entities and adjusting their velocities to prevent overlap.
+ * It runs once per frame over the contacts found by BoxCollisionSystem, after detection and before the
+ * collisions are reported, so the result only depends on the contact list and not on event order.
  */
 class OverlapSystem : public System {
 private:
     /**
-     * @brief Checks if two entities are colliding from a specific direction
+     * @brief How one contact is resolved, computed before any entity is moved
+     */
+	struct Resolution {
+		Entity fixed;        ///< Heavier entity, which stays in place
+		Entity moving;       ///< Lighter entity, which is pushed out
+		Direction direction; ///< Side of the fixed entity the moving one is pushed to
+	};
+
+    /**
+     * @brief Resolutions of the current frame, kept to reuse the storage
+     */
+	std::vector<Resolution> resolutions;
+
+    /**
+     * @brief Finds the side from which a box reached another one
      * 
-     * Performs directional collision detection between two box colliders using their
-     * previous positions to determine collision direction.
+     * Uses the previous positions of both boxes and checks the sides in the
+     * order top, bottom, right, left.
      * 
-     * @param a First entity to check collision for
-     * @param b Second entity to check collision against
-     * @param dir Direction to check collision from (top, bottom, left, right)
-     * @return true if collision is detected from the specified direction, false otherwise
+     * @param aPos Previous position of the fixed box
+     * @param aW Width of the fixed box
+     * @param aH Height of the fixed box
+     * @param bPos Previous position of the moving box
+     * @param bW Width of the moving box
+     * @param bH Height of the moving box
+     * @param dir Receives the side of the fixed box the moving one came from
+     * @return true if a side was found, false otherwise
      */
-	bool CheckCollision(Entity a, Entity b, Direction dir) {
-		auto& aCollider = a.GetComponent<BoxColliderComponent>();
-		auto& bCollider = b.GetComponent<BoxColliderComponent>();
-		auto& aTransform = a.GetComponent<TransformComponent>();
-		auto& bTransform = b.GetComponent<TransformComponent>();
-		
-		float aX = aTransform.previousPosition.x;
-		float aY = aTransform.previousPosition.y;
-		float aW = static_cast<float>(aCollider.width);
-		float aH = static_cast<float>(aCollider.heigth);
-
-		float bX = bTransform.previousPosition.x;
-		float bY = bTransform.previousPosition.y;
-		float bW = static_cast<float>(bCollider.width);
-		float bH = static_cast<float>(bCollider.heigth);
-	
-		if (Direction::top == dir) {
-			return (
-				aX < bX + bW &&
-				aX + aW > bX &&
-				aY > bY
-				);
-		} else if (Direction::bottom == dir) {
-			return (
-				aX < bX + bW &&
-				aX + aW > bX &&
-				aY < bY
-				);
-		} else if (Direction::left == dir) {
-			return (
-				aY < bY + bH &&
-				aY + aH > bY &&
-				aX > bX
-				);
-		} else if (Direction::right == dir) {
-			return (
-				aY < bY + bH &&
-				aY + aH > bY &&
-				aX < bX
-				);
+	static bool FindDirection(glm::vec2 aPos, float aW, float aH, glm::vec2 bPos, float bW, float bH, Direction& dir) {
+		const bool overlapX = aPos.x < bPos.x + bW && aPos.x + aW > bPos.x;
+		const bool overlapY = aPos.y < bPos.y + bH && aPos.y + aH > bPos.y;
+		if (overlapX && aPos.y > bPos.y) {
+			dir = Direction::top;
+		}
+		else if (overlapX && aPos.y < bPos.y) {
+			dir = Direction::bottom;
+		}
+		else if (overlapY && aPos.x < bPos.x) {
+			dir = Direction::right;
+		}
+		else if (overlapY && aPos.x > bPos.x) {
+			dir = Direction::left;
 		}
 		else {
 			return false;
 		}
-
+		return true;
 	}
 
     /**
-     * @brief Resolves collision overlap between two entities
+     * @brief Moves an entity out of another one and stops it along the push
      * 
-     * Repositions the second entity to avoid overlap with the first entity and
-     * adjusts its velocity based on the collision direction.
-     * 
-     * @param a Reference entity (stationary)
-     * @param b Entity to be repositioned to avoid overlap
+     * @param resolution The contact to resolve
+     * @param view View used to read the components without looking up their pools
      */
-	void AvoidOverlap(Entity a, Entity b) {
-		auto& aCollider = a.GetComponent<BoxColliderComponent>();
-		auto& aTransform = a.GetComponent<TransformComponent>();
-		auto& bCollider = b.GetComponent<BoxColliderComponent>();
-		auto& bTransform = b.GetComponent<TransformComponent>();
-		auto& bRigidbody = b.GetComponent<RigidBodyComponent>();
-		if (CheckCollision(a, b, Direction::top)) {
+	template <typename TView>
+	static void AvoidOverlap(const Resolution& resolution, const TView& view) {
+		const auto& aCollider = view.template Get<BoxColliderComponent>(resolution.fixed);
+		const auto& aTransform = view.template Get<TransformComponent>(resolution.fixed);
+		const auto& bCollider = view.template Get<BoxColliderComponent>(resolution.moving);
+		auto& bTransform = view.template Get<TransformComponent>(resolution.moving);
+		auto& bRigidbody = view.template Get<RigidBodyComponent>(resolution.moving);
+		if (resolution.direction == Direction::top) {
 			bTransform.position = glm::vec2(bTransform.position.x,
 				aTransform.position.y - bCollider.heigth);
 			bRigidbody.velocity = glm::vec2(bRigidbody.velocity.x, 0.0f);
 		}
-		else if (CheckCollision(a, b, Direction::bottom)) {
+		else if (resolution.direction == Direction::bottom) {
 			bTransform.position = glm::vec2(bTransform.position.x,
 				aTransform.position.y + aCollider.heigth);
 			bRigidbody.velocity = glm::vec2(bRigidbody.velocity.x, 0.0f);
 		}
-		else if (CheckCollision(a, b, Direction::right)) {
+		else if (resolution.direction == Direction::right) {
 			bTransform.position = glm::vec2(aTransform.position.x + aCollider.width,
 				bTransform.position.y);
 			bRigidbody.velocity = glm::vec2(0.0f, bRigidbody.velocity.y);
 		}
-		else if (CheckCollision(a, b, Direction::left)) {
+		else {
 			bTransform.position = glm::vec2(aTransform.position.x - bCollider.width,
 				bTransform.position.y);
 			bRigidbody.velocity = glm::vec2(0.0f, bRigidbody.velocity.y);
@@ -139,52 +130,51 @@ public:
 	}
 
     /**
-     * @brief Subscribes this system to collision events
-     * 
-     * Registers the OnCollisionEvent method as a callback for CollisionEvent,
-     * allowing the system to respond when collisions occur.
+     * @brief Resolves the overlaps between solid entities found this frame
      * 
-     * @param eventManager Unique pointer to the event manager for subscribing to events
-     */
-	void SubscribeToCollisionEvent(const std::unique_ptr<EventManager>& eventManager) {
-		eventManager->SubscribeToEvent<CollisionEvent, OverlapSystem>(this, &OverlapSystem::OnCollisionEvent);
-	}
-
-    /**
-     * @brief Handles collision events and resolves overlaps
+     * Contacts with a trigger collider, or with an entity that has no rigid
+     * body, are skipped. For every pair of solid entities the lighter one is
+     * pushed out of the heavier one, from the side it came from according to
+     * their previous positions.
      * 
-     * Called when a collision event is triggered. Checks for special entity tags
-     * (door, jumpable, slowdown) to skip collision resolution, then resolves
-     * overlaps between solid entities based on their mass properties.
+     * The first pass only reads components to decide how each contact is
+     * resolved, and the second pass moves the entities, in the order of the
+     * contacts, which BoxCollisionSystem sorts by entity id.
      * 
-     * @param e Reference to the collision event containing the two colliding entities
+     * @param contacts Overlapping pairs found by BoxCollisionSystem::DetectContacts
      */
-	void OnCollisionEvent(CollisionEvent& e) {
-		auto& aRigidbody = e.a.GetComponent<RigidBodyComponent>();
-		auto& bRigidbody = e.b.GetComponent<RigidBodyComponent>();
-		if (e.a.HasComponent<TagComponent>()) {
-			if (e.a.GetComponent<TagComponent>().tag.find("door") != std::string::npos ||
-				e.a.GetComponent<TagComponent>().tag.find("jumpable") != std::string::npos ||
-				e.a.GetComponent<TagComponent>().tag.find("slowdown") != std::string::npos) {
-				return;
+	void Update(const std::vector<BoxContact>& contacts) {
+		auto view = registry->GetView<BoxColliderComponent, RigidBodyComponent, TransformComponent>();
+		resolutions.clear();
+		for (const BoxContact& contact : contacts) {
+			if ((contact.aLayer | contact.bLayer) & LAYER_TRIGGER) {
+				continue;
 			}
-		}
-		if (e.b.HasComponent<TagComponent>()) {
-			if (e.b.GetComponent<TagComponent>().tag.find("door") != std::string::npos ||
-				e.b.GetComponent<TagComponent>().tag.find("jumpable") != std::string::npos ||
-				e.b.GetComponent<TagComponent>().tag.find("slowdown") != std::string::npos) {
-				return;
+			if (!contact.a.HasComponent<RigidBodyComponent>() || !contact.b.HasComponent<RigidBodyComponent>()) {
+				continue;
 			}
-		}
-		if (aRigidbody.isSolid && bRigidbody.isSolid) {
-			if (aRigidbody.mass >= bRigidbody.mass) {
-				AvoidOverlap(e.a, e.b);
+			const auto& aRigidbody = view.Get<RigidBodyComponent>(contact.a);
+			const auto& bRigidbody = view.Get<RigidBodyComponent>(contact.b);
+			if (!aRigidbody.isSolid || !bRigidbody.isSolid) {
+				continue;
 			}
-			else {
-				AvoidOverlap(e.b, e.a);
+			Resolution resolution;
+			resolution.fixed = aRigidbody.mass >= bRigidbody.mass ? contact.a : contact.b;
+			resolution.moving = aRigidbody.mass >= bRigidbody.mass ? contact.b : contact.a;
+			const auto& aCollider = view.Get<BoxColliderComponent>(resolution.fixed);
+			const auto& bCollider = view.Get<BoxColliderComponent>(resolution.moving);
+			if (FindDirection(view.Get<TransformComponent>(resolution.fixed).previousPosition,
+					static_cast<float>(aCollider.width), static_cast<float>(aCollider.heigth),
+					view.Get<TransformComponent>(resolution.moving).previousPosition,
+					static_cast<float>(bCollider.width), static_cast<float>(bCollider.heigth),
+					resolution.direction)) {
+				resolutions.push_back(resolution);
 			}
 		}
+		for (const Resolution& resolution : resolutions) {
+			AvoidOverlap(resolution, view);
+		}
 	}
 };
 
-#endif // !OVERLAPSYSTEM_HPP
\ No newline at end of file
+#endif // !OVERLAPSYSTEM_HPP
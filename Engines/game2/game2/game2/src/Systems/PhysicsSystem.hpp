@@ -22,9 +22,11 @@ public:
      * 
      * Initializes the physics system and sets up the required component type.
      * Only entities with RigidBodyComponent will be processed by this system.
+     * It only touches rigid bodies, so it may run in parallel with other systems.
      */
     PhysicsSystem() {
         RequiredComponent<RigidBodyComponent>();
+        SetExclusive(false);
     }
     
     /**
@@ -6,10 +6,15 @@
 #ifndef RENDERSYSTEM_HPP
 #define RENDERSYSTEM_HPP
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
 #include "../AssetManager/AssetManager.hpp"
 #include "../Components/SpriteComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Utils/SpriteBatch.hpp"
 
 /**
  * @class RenderSystem
@@ -41,17 +46,38 @@ public:
      * position, entity transforms (position, rotation, scale), and sprite
      * properties (source rectangle, flipping).
      * 
+     * Sprites are drawn in the order their entities were created, so later
+     * entities are drawn on top. The view walks the pools, whose order changes
+     * when components are removed or packed, so the sprites are collected and
+     * sorted by creation order first. Consecutive sprites sharing a texture
+     * are then submitted together through the sprite batch, and the texture is
+     * only looked up in the asset manager when the texture id changes from the
+     * previous sprite.
+     * 
      * @param renderer SDL renderer used for drawing operations
      * @param AssetManager Asset manager containing loaded textures
      * @param camera Camera rectangle used for viewport calculations
      */
     void Update(SDL_Renderer* renderer, const std::unique_ptr<AssetManager>& AssetManager, SDL_Rect& camera) {
-        for (auto entity : GetSystemEntiities()) {
-            const auto sprite = entity.GetComponent<SpriteComponent>();
-            const auto transform = entity.GetComponent<TransformComponent>();
-            
-            // Source rectangle from sprite sheet
-            SDL_Rect srcRect = sprite.srcRect;
+        drawItems.clear();
+        registry->GetView<SpriteComponent, TransformComponent>().Each(
+            [&](Entity entity, const SpriteComponent& sprite, const TransformComponent& transform) {
+            drawItems.push_back({ registry->GetCreationOrder(entity), &sprite, &transform });
+        });
+        std::sort(drawItems.begin(), drawItems.end(), [](const DrawItem& a, const DrawItem& b) {
+            return a.order < b.order;
+        });
+        
+        batch.Begin(renderer);
+        const std::string* textureId = nullptr;
+        SDL_Texture* texture = nullptr;
+        for (const DrawItem& item : drawItems) {
+            const SpriteComponent& sprite = *item.sprite;
+            const TransformComponent& transform = *item.transform;
+            if (textureId == nullptr || sprite.textureId != *textureId) {
+                textureId = &sprite.textureId;
+                texture = AssetManager->GetTexture(sprite.textureId);
+            }
             
             // Destination rectangle with camera offset and scaling applied
             SDL_Rect dstRect = {
@@ -61,17 +87,46 @@ public:
                 static_cast<int>(sprite.height * transform.scale.y),
             };
             
-            // Render sprite with rotation and optional horizontal flip
-            SDL_RenderCopyEx(
-                renderer,
-                AssetManager->GetTexture(sprite.textureId),
-                &srcRect,
-                &dstRect,
-                transform.rotation,
-                NULL,
-                (sprite.flip) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE
-            );
+            // Sprite with rotation and optional horizontal flip
+            batch.Draw(texture, sprite.srcRect, dstRect, transform.rotation, sprite.flip);
         }
+        batch.End();
+    }
+    
+    /**
+     * @brief Gets the number of render calls made by the last Update
+     * 
+     * @return Number of batches submitted, at most one per change of texture
+     */
+    int GetDrawCallCount() const {
+        return batch.GetDrawCallCount();
+    }
+    
+    /**
+     * @brief Gets the number of sprites drawn by the last Update
+     */
+    int GetSpriteCount() const {
+        return batch.GetSpriteCount();
     }
+    
+private:
+    /**
+     * @brief Sprite of an entity waiting to be drawn
+     */
+    struct DrawItem {
+        std::uint64_t order;                      ///< Creation order of the entity
+        const SpriteComponent* sprite;            ///< Sprite to draw
+        const TransformComponent* transform;      ///< Placement of the sprite
+    };
+    
+    /**
+     * @brief Sprites of the frame sorted by creation order, kept to reuse the storage
+     */
+    std::vector<DrawItem> drawItems;
+    
+    /**
+     * @brief Batch collecting the sprites of a frame
+     */
+    SpriteBatch batch;
 };
 #endif // RENDERSYSTEM_HPP
\ No newline at end of file
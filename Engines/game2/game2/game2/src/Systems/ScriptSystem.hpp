@@ -55,6 +55,10 @@ public:
         lua.set_function("right_collision", RightCollision);
         lua.set_function("bottom_collision", BottomCollision);
         lua.set_function("top_collision", TopCollision);
+        lua.set_function("query_aabb", QueryAABB);
+        lua.set_function("query_radius", QueryRadius);
+        lua.set_function("raycast", Raycast);
+        lua.set_function("nearest", Nearest);
         lua.set_function("get_position", GetPosition);
         lua.set_function("set_position", SetPosition);
         lua.set_function("get_size", GetSize);
@@ -0,0 +1,841 @@
+/**
+ * @file AABBTree.hpp
+ * @brief Dynamic bounding volume hierarchy used as a collision broadphase
+ */
+
+#ifndef AABBTREE_HPP
+#define AABBTREE_HPP
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct AABB
+ * @brief Axis-aligned bounding box given by its corners
+ */
+struct AABB {
+    float minX = 0.0f;   ///< Left side of the box
+    float minY = 0.0f;   ///< Top side of the box
+    float maxX = 0.0f;   ///< Right side of the box
+    float maxY = 0.0f;   ///< Bottom side of the box
+
+    /**
+     * @brief Checks if this box and another one overlap or touch
+     *
+     * @param other The other box
+     * @return true if the boxes share at least one point
+     */
+    bool Overlaps(const AABB& other) const {
+        return minX <= other.maxX && other.minX <= maxX
+            && minY <= other.maxY && other.minY <= maxY;
+    }
+
+    /**
+     * @brief Checks if another box lies completely inside this one
+     *
+     * @param other The other box
+     * @return true if the other box is contained in this box
+     */
+    bool Contains(const AABB& other) const {
+        return minX <= other.minX && other.maxX <= maxX
+            && minY <= other.minY && other.maxY <= maxY;
+    }
+
+    /**
+     * @brief Gets the squared distance from a point to the box
+     *
+     * @param x X coordinate of the point
+     * @param y Y coordinate of the point
+     * @return 0 if the point is inside the box
+     */
+    float DistanceSquared(float x, float y) const {
+        const float dx = std::max({ minX - x, 0.0f, x - maxX });
+        const float dy = std::max({ minY - y, 0.0f, y - maxY });
+        return dx * dx + dy * dy;
+    }
+
+    /**
+     * @brief Finds where a segment enters the box
+     *
+     * The segment goes from (x, y) to (x + dx, y + dy) and points on it are
+     * given as a fraction of its length. A segment that starts inside the
+     * box enters it at fraction 0.
+     *
+     * @param x X coordinate of the start of the segment
+     * @param y Y coordinate of the start of the segment
+     * @param dx Length of the segment in x
+     * @param dy Length of the segment in y
+     * @param maxFraction Only entries up to this fraction are reported
+     * @param fraction Receives the fraction where the segment enters the box
+     * @return true if the segment enters the box before maxFraction
+     */
+    bool RayCast(float x, float y, float dx, float dy, float maxFraction, float& fraction) const {
+        float enter = 0.0f;
+        float exit = maxFraction;
+        if (!ClipSlab(x, dx, minX, maxX, enter, exit) || !ClipSlab(y, dy, minY, maxY, enter, exit)) {
+            return false;
+        }
+        fraction = enter;
+        return true;
+    }
+
+    /**
+     * @brief Gets the perimeter of the box, used as the insertion cost
+     */
+    float Perimeter() const {
+        return 2.0f * ((maxX - minX) + (maxY - minY));
+    }
+
+    /**
+     * @brief Gets the smallest box that contains two boxes
+     */
+    static AABB Union(const AABB& a, const AABB& b) {
+        AABB box;
+        box.minX = std::min(a.minX, b.minX);
+        box.minY = std::min(a.minY, b.minY);
+        box.maxX = std::max(a.maxX, b.maxX);
+        box.maxY = std::max(a.maxY, b.maxY);
+        return box;
+    }
+
+    bool operator==(const AABB& other) const {
+        return minX == other.minX && minY == other.minY
+            && maxX == other.maxX && maxY == other.maxY;
+    }
+
+private:
+    /**
+     * @brief Narrows the part of a segment that lies between two sides of a box
+     *
+     * @return false if the part left is empty
+     */
+    static bool ClipSlab(float start, float delta, float low, float high, float& enter, float& exit) {
+        if (delta == 0.0f) {
+            return low <= start && start <= high;
+        }
+        float t0 = (low - start) / delta;
+        float t1 = (high - start) / delta;
+        if (t1 < t0) {
+            std::swap(t0, t1);
+        }
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        return enter <= exit;
+    }
+};
+
+/**
+ * @class AABBTree
+ * @brief Balanced binary tree of boxes where each leaf holds one proxy
+ *
+ * Each inner node stores the union of the boxes of its children, so a query
+ * only descends into the subtrees whose box overlaps the query box. Leaves
+ * are inserted next to the sibling that grows the tree the least, and tree
+ * rotations keep its height logarithmic while proxies come and go.
+ *
+ * Nodes live in a vector and are referenced by index, and freed nodes are
+ * recycled, so the tree does not allocate once it has reached its size.
+ */
+class AABBTree {
+public:
+    /**
+     * @brief Index used for a missing node
+     */
+    static constexpr int NULL_NODE = -1;
+
+    /**
+     * @brief Inserts a leaf
+     *
+     * @param box The box stored in the leaf
+     * @param userId Id reported by queries for this leaf
+     * @return The index of the leaf, used to remove it
+     */
+    int Insert(const AABB& box, int userId) {
+        const int leaf = AllocateNode();
+        nodes[leaf].box = box;
+        nodes[leaf].userId = userId;
+        nodes[leaf].height = 0;
+        InsertLeaf(leaf);
+        return leaf;
+    }
+
+    /**
+     * @brief Removes a leaf
+     *
+     * @param leaf The index returned by Insert
+     */
+    void Remove(int leaf) {
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+    }
+
+    /**
+     * @brief Gets the box stored in a leaf
+     *
+     * @param leaf The index returned by Insert
+     * @return The box of the leaf
+     */
+    const AABB& GetBox(int leaf) const {
+        return nodes[leaf].box;
+    }
+
+    /**
+     * @brief Calls a function for every leaf whose box overlaps a box
+     *
+     * @tparam TFunc Callable taking the user id of the leaf
+     * @param box The query box
+     * @param func Function called once per overlapping leaf
+     */
+    template <typename TFunc>
+    void Query(const AABB& box, TFunc&& func) const {
+        if (root == NULL_NODE) {
+            return;
+        }
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[index];
+            if (!node.box.Overlaps(box)) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                func(node.userId);
+            }
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    /**
+     * @brief Calls a function for every leaf whose box a segment enters
+     *
+     * The function returns the fraction where the segment should now end, so
+     * a search for the closest hit can return the fraction of its best hit
+     * and the leaves farther along the segment are skipped.
+     *
+     * @tparam TFunc Callable taking the user id of the leaf and the current
+     *               end fraction, and returning the new end fraction
+     * @param x0 X coordinate of the start of the segment
+     * @param y0 Y coordinate of the start of the segment
+     * @param x1 X coordinate of the end of the segment
+     * @param y1 Y coordinate of the end of the segment
+     * @param maxFraction Fraction of the segment to search, 1 for all of it
+     * @param func Function called once per leaf the segment enters
+     * @return The end fraction after the last call
+     */
+    template <typename TFunc>
+    float RayCast(float x0, float y0, float x1, float y1, float maxFraction, TFunc&& func) const {
+        if (root == NULL_NODE) {
+            return maxFraction;
+        }
+        const float dx = x1 - x0;
+        const float dy = y1 - y0;
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[index];
+            float fraction;
+            if (!node.box.RayCast(x0, y0, dx, dy, maxFraction, fraction)) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                maxFraction = func(node.userId, maxFraction);
+            }
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+        return maxFraction;
+    }
+
+    /**
+     * @brief Calls a function for the leaves that may be closest to a point
+     *
+     * The function returns the squared distance of the closest match found so
+     * far, and subtrees whose box is not closer than that are skipped. The
+     * closer child of each node is visited first, so good matches are found
+     * early.
+     *
+     * @tparam TFunc Callable taking the user id of the leaf and the current
+     *               best squared distance, and returning the new one
+     * @param x X coordinate of the point
+     * @param y Y coordinate of the point
+     * @param bestDistanceSquared Squared distance of the best match so far
+     * @param func Function called for the leaves closer than the best match
+     * @return The best squared distance after the last call
+     */
+    template <typename TFunc>
+    float Nearest(float x, float y, float bestDistanceSquared, TFunc&& func) const {
+        if (root == NULL_NODE) {
+            return bestDistanceSquared;
+        }
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[index];
+            if (node.box.DistanceSquared(x, y) >= bestDistanceSquared) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                bestDistanceSquared = func(node.userId, bestDistanceSquared);
+            }
+            else if (nodes[node.left].box.DistanceSquared(x, y) < nodes[node.right].box.DistanceSquared(x, y)) {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+            else {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+        return bestDistanceSquared;
+    }
+
+    /**
+     * @brief Removes every leaf
+     */
+    void Clear() {
+        nodes.clear();
+        root = NULL_NODE;
+        freeList = NULL_NODE;
+    }
+
+private:
+    /**
+     * @brief Leaf or inner node of the tree
+     *
+     * Freed nodes use parent to link the free list.
+     */
+    struct Node {
+        AABB box;
+        int parent = NULL_NODE;
+        int left = NULL_NODE;
+        int right = NULL_NODE;
+        int userId = -1;
+        int height = -1;   ///< 0 for leaves, -1 for free nodes
+
+        bool IsLeaf() const {
+            return left == NULL_NODE;
+        }
+    };
+
+    std::vector<Node> nodes;
+    int root = NULL_NODE;
+    int freeList = NULL_NODE;
+
+    int AllocateNode() {
+        if (freeList == NULL_NODE) {
+            nodes.emplace_back();
+            return static_cast<int>(nodes.size()) - 1;
+        }
+        const int index = freeList;
+        freeList = nodes[index].parent;
+        nodes[index] = Node();
+        return index;
+    }
+
+    void FreeNode(int index) {
+        nodes[index].parent = freeList;
+        nodes[index].height = -1;
+        freeList = index;
+    }
+
+    void InsertLeaf(int leaf) {
+        if (root == NULL_NODE) {
+            root = leaf;
+            nodes[leaf].parent = NULL_NODE;
+            return;
+        }
+
+        // Descend towards the sibling that makes the tree grow the least
+        const AABB leafBox = nodes[leaf].box;
+        int index = root;
+        while (!nodes[index].IsLeaf()) {
+            const int left = nodes[index].left;
+            const int right = nodes[index].right;
+            const float area = nodes[index].box.Perimeter();
+            const float combinedArea = AABB::Union(nodes[index].box, leafBox).Perimeter();
+            const float cost = 2.0f * combinedArea;
+            const float inheritanceCost = 2.0f * (combinedArea - area);
+            const float leftCost = DescendCost(left, leafBox) + inheritanceCost;
+            const float rightCost = DescendCost(right, leafBox) + inheritanceCost;
+            if (cost < leftCost && cost < rightCost) {
+                break;
+            }
+            index = leftCost < rightCost ? left : right;
+        }
+
+        const int sibling = index;
+        const int oldParent = nodes[sibling].parent;
+        const int newParent = AllocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].box = AABB::Union(leafBox, nodes[sibling].box);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].left = sibling;
+        nodes[newParent].right = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+        if (oldParent == NULL_NODE) {
+            root = newParent;
+        }
+        else if (nodes[oldParent].left == sibling) {
+            nodes[oldParent].left = newParent;
+        }
+        else {
+            nodes[oldParent].right = newParent;
+        }
+
+        Refit(nodes[leaf].parent);
+    }
+
+    void RemoveLeaf(int leaf) {
+        if (leaf == root) {
+            root = NULL_NODE;
+            return;
+        }
+        const int parent = nodes[leaf].parent;
+        const int grandParent = nodes[parent].parent;
+        const int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+        if (grandParent == NULL_NODE) {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            FreeNode(parent);
+            return;
+        }
+        if (nodes[grandParent].left == parent) {
+            nodes[grandParent].left = sibling;
+        }
+        else {
+            nodes[grandParent].right = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+        Refit(grandParent);
+    }
+
+    /**
+     * @brief Cost of pushing a new box down into a child
+     */
+    float DescendCost(int child, const AABB& leafBox) const {
+        const AABB box = AABB::Union(leafBox, nodes[child].box);
+        if (nodes[child].IsLeaf()) {
+            return box.Perimeter();
+        }
+        return box.Perimeter() - nodes[child].box.Perimeter();
+    }
+
+    /**
+     * @brief Rebalances and recomputes boxes and heights up to the root
+     */
+    void Refit(int index) {
+        while (index != NULL_NODE) {
+            index = Balance(index);
+            const int left = nodes[index].left;
+            const int right = nodes[index].right;
+            nodes[index].height = 1 + std::max(nodes[left].height, nodes[right].height);
+            nodes[index].box = AABB::Union(nodes[left].box, nodes[right].box);
+            index = nodes[index].parent;
+        }
+    }
+
+    /**
+     * @brief Rotates the taller child of a node up if the node is unbalanced
+     *
+     * @param a The node to balance
+     * @return The node now at the position of a
+     */
+    int Balance(int a) {
+        if (nodes[a].IsLeaf() || nodes[a].height < 2) {
+            return a;
+        }
+        const int b = nodes[a].left;
+        const int c = nodes[a].right;
+        const int balance = nodes[c].height - nodes[b].height;
+        if (balance > 1) {
+            return RotateUp(a, c, b, false);
+        }
+        if (balance < -1) {
+            return RotateUp(a, b, c, true);
+        }
+        return a;
+    }
+
+    /**
+     * @brief Makes the child pivot the parent of a
+     *
+     * The taller grandchild stays under pivot and the shorter one takes the
+     * place of pivot under a.
+     *
+     * @param a The unbalanced node
+     * @param pivot The taller child of a
+     * @param other The shorter child of a
+     * @param pivotIsLeft Whether pivot is the left child of a
+     * @return pivot, which now takes the place of a
+     */
+    int RotateUp(int a, int pivot, int other, bool pivotIsLeft) {
+        const int f = nodes[pivot].left;
+        const int g = nodes[pivot].right;
+
+        nodes[pivot].left = a;
+        nodes[pivot].parent = nodes[a].parent;
+        nodes[a].parent = pivot;
+        const int parent = nodes[pivot].parent;
+        if (parent == NULL_NODE) {
+            root = pivot;
+        }
+        else if (nodes[parent].left == a) {
+            nodes[parent].left = pivot;
+        }
+        else {
+            nodes[parent].right = pivot;
+        }
+
+        const int taller = nodes[f].height > nodes[g].height ? f : g;
+        const int shorter = taller == f ? g : f;
+        nodes[pivot].right = taller;
+        if (pivotIsLeft) {
+            nodes[a].left = shorter;
+        }
+        else {
+            nodes[a].right = shorter;
+        }
+        nodes[shorter].parent = a;
+        nodes[a].box = AABB::Union(nodes[other].box, nodes[shorter].box);
+        nodes[a].height = 1 + std::max(nodes[other].height, nodes[shorter].height);
+        nodes[pivot].box = AABB::Union(nodes[a].box, nodes[taller].box);
+        nodes[pivot].height = 1 + std::max(nodes[a].height, nodes[taller].height);
+        return pivot;
+    }
+};
+
+/**
+ * @class AABBBroadphase
+ * @brief Collision broadphase that keeps static and moving colliders in two AABB trees
+ *
+ * Proxies are identified by small non-negative ids (the collision systems use
+ * entity ids). Each one is stored with a fat box, enlarged by a margin and by
+ * its last displacement, and it is only reinserted when its real box leaves
+ * the fat one. Colliders that do not move stay in the static tree, so after
+ * the scene is loaded they are never touched again and static-static pairs
+ * are never reported. Each proxy also has a collision layer and mask, and a
+ * pair is only reported when each proxy has the layer of the other one in its
+ * mask.
+ */
+class AABBBroadphase {
+public:
+    /**
+     * @brief Margin in pixels added around each box in the trees
+     */
+    static constexpr float FAT_MARGIN = 8.0f;
+
+    /**
+     * @brief Checks if a proxy is stored
+     *
+     * @param id The id of the proxy
+     * @return true if the proxy has been set and not removed
+     */
+    bool Has(int id) const {
+        return id >= 0
+            && static_cast<size_t>(id) < proxies.size()
+            && proxies[id].leaf != AABBTree::NULL_NODE;
+    }
+
+    /**
+     * @brief Inserts a proxy or updates its box
+     *
+     * A proxy that is not static, or whose box changed since the last call, is
+     * kept in the moving tree. Its leaf is only reinserted when the box leaves
+     * the fat box stored in the tree.
+     *
+     * @param id The id of the proxy
+     * @param box The current box of the collider
+     * @param isStatic Whether the collider is not expected to move
+     * @param layer Collision layer bits of the proxy
+     * @param mask Collision layers the proxy can pair with
+     */
+    void Set(int id, const AABB& box, bool isStatic,
+             unsigned int layer = 0xFFFFFFFFu, unsigned int mask = 0xFFFFFFFFu) {
+        if (static_cast<size_t>(id) >= proxies.size()) {
+            proxies.resize(id + 100);
+        }
+        Proxy& proxy = proxies[id];
+        if (proxy.leaf == AABBTree::NULL_NODE) {
+            proxy.isStatic = isStatic;
+            proxy.leaf = GetTree(isStatic).Insert(Fatten(box, 0.0f, 0.0f), id);
+            activeIds.push_back(id);
+        }
+        else {
+            isStatic = isStatic && box == proxy.box;
+            if (isStatic != proxy.isStatic) {
+                GetTree(proxy.isStatic).Remove(proxy.leaf);
+                proxy.isStatic = isStatic;
+                proxy.leaf = GetTree(isStatic).Insert(Fatten(box, 0.0f, 0.0f), id);
+            }
+            else if (!GetTree(isStatic).GetBox(proxy.leaf).Contains(box)) {
+                GetTree(isStatic).Remove(proxy.leaf);
+                proxy.leaf = GetTree(isStatic).Insert(
+                    Fatten(box, box.minX - proxy.box.minX, box.minY - proxy.box.minY), id);
+            }
+        }
+        proxy.box = box;
+        proxy.layer = layer;
+        proxy.mask = mask;
+        proxy.seen = true;
+    }
+
+    /**
+     * @brief Removes a proxy
+     *
+     * Does nothing if the proxy is not stored.
+     *
+     * @param id The id of the proxy
+     */
+    void Remove(int id) {
+        if (!Has(id)) {
+            return;
+        }
+        RemoveProxy(proxies[id]);
+        activeIds.erase(std::find(activeIds.begin(), activeIds.end(), id));
+    }
+
+    /**
+     * @brief Removes every proxy that was not set since the last call
+     *
+     * Lets a system feed its current colliders each frame and drop the ones
+     * that were killed or lost their components.
+     */
+    void RemoveStale() {
+        size_t kept = 0;
+        for (int id : activeIds) {
+            Proxy& proxy = proxies[id];
+            if (proxy.seen) {
+                proxy.seen = false;
+                activeIds[kept++] = id;
+            }
+            else {
+                RemoveProxy(proxy);
+            }
+        }
+        activeIds.resize(kept);
+    }
+
+    /**
+     * @brief Removes every proxy
+     */
+    void Clear() {
+        proxies.clear();
+        activeIds.clear();
+        staticTree.Clear();
+        movingTree.Clear();
+    }
+
+    /**
+     * @brief Gets the number of stored proxies
+     */
+    int GetProxyCount() const {
+        return static_cast<int>(activeIds.size());
+    }
+
+    /**
+     * @brief Collects the pairs of proxies whose boxes overlap and whose layers match
+     *
+     * Only moving proxies query the trees, so pairs of static colliders are
+     * never reported. Each pair is reported once, as (lower id, higher id),
+     * and the output is sorted so dispatch order is stable.
+     *
+     * @param pairs Vector that receives the overlapping pairs; it is cleared first
+     */
+    void QueryPairs(std::vector<std::pair<int, int>>& pairs) const {
+        pairs.clear();
+        QueryPairs(0, GetProxyCount(), pairs);
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    /**
+     * @brief Collects the pairs found by a range of the stored proxies
+     *
+     * Splitting [0, GetProxyCount()) in ranges finds every pair exactly once,
+     * so the ranges can be searched on different threads as long as no proxy
+     * is set or removed meanwhile. Pairs are appended unsorted.
+     *
+     * @param begin First proxy of the range
+     * @param end Proxy after the last one of the range
+     * @param pairs Vector the pairs are appended to
+     */
+    void QueryPairs(int begin, int end, std::vector<std::pair<int, int>>& pairs) const {
+        for (int index = begin; index < end; index++) {
+            const int id = activeIds[index];
+            const Proxy& proxy = proxies[id];
+            if (proxy.isStatic) {
+                continue;
+            }
+            staticTree.Query(proxy.box, [&](int other) {
+                if (proxy.box.Overlaps(proxies[other].box) && CanPair(proxy, proxies[other])) {
+                    pairs.emplace_back(std::min(id, other), std::max(id, other));
+                }
+            });
+            // Both moving proxies find each other, so only the lower id reports
+            movingTree.Query(proxy.box, [&](int other) {
+                if (id < other && proxy.box.Overlaps(proxies[other].box) && CanPair(proxy, proxies[other])) {
+                    pairs.emplace_back(id, other);
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief Calls a function for every proxy whose box overlaps a box
+     *
+     * @tparam TFunc Callable taking the id of the proxy
+     * @param box The query box
+     * @param func Function called once per overlapping proxy
+     */
+    template <typename TFunc>
+    void Query(const AABB& box, TFunc&& func) const {
+        auto visit = [&](int id) {
+            if (box.Overlaps(proxies[id].box)) {
+                func(id);
+            }
+        };
+        staticTree.Query(box, visit);
+        movingTree.Query(box, visit);
+    }
+
+    /**
+     * @brief Finds the first proxy a segment enters
+     *
+     * @tparam TFunc Callable taking the id of a proxy and returning true if
+     *               the segment can hit it
+     * @param x0 X coordinate of the start of the segment
+     * @param y0 Y coordinate of the start of the segment
+     * @param x1 X coordinate of the end of the segment
+     * @param y1 Y coordinate of the end of the segment
+     * @param filter Function choosing which proxies can be hit
+     * @param hitId Receives the id of the proxy hit first
+     * @param hitFraction Receives the fraction of the segment where it is hit
+     * @return true if the segment hits a proxy
+     */
+    template <typename TFunc>
+    bool RayCast(float x0, float y0, float x1, float y1, TFunc&& filter, int& hitId, float& hitFraction) const {
+        const float dx = x1 - x0;
+        const float dy = y1 - y0;
+        hitId = -1;
+        auto visit = [&](int id, float maxFraction) {
+            float fraction;
+            if (proxies[id].box.RayCast(x0, y0, dx, dy, maxFraction, fraction)
+                && (hitId == -1 || fraction < hitFraction || (fraction == hitFraction && id < hitId))
+                && filter(id)) {
+                hitId = id;
+                hitFraction = fraction;
+                return fraction;
+            }
+            return maxFraction;
+        };
+        const float maxFraction = staticTree.RayCast(x0, y0, x1, y1, 1.0f, visit);
+        movingTree.RayCast(x0, y0, x1, y1, maxFraction, visit);
+        return hitId != -1;
+    }
+
+    /**
+     * @brief Finds the proxy closest to a point
+     *
+     * @tparam TFunc Callable taking the id of a proxy and returning true if
+     *               it can be chosen
+     * @param x X coordinate of the point
+     * @param y Y coordinate of the point
+     * @param filter Function choosing which proxies can be returned
+     * @param hitId Receives the id of the closest proxy
+     * @return true if some proxy was chosen
+     */
+    template <typename TFunc>
+    bool Nearest(float x, float y, TFunc&& filter, int& hitId) const {
+        hitId = -1;
+        float hitDistanceSquared = std::numeric_limits<float>::infinity();
+        auto visit = [&](int id, float bestDistanceSquared) {
+            const float distanceSquared = proxies[id].box.DistanceSquared(x, y);
+            if ((distanceSquared < hitDistanceSquared || (distanceSquared == hitDistanceSquared && id < hitId))
+                && filter(id)) {
+                hitId = id;
+                hitDistanceSquared = distanceSquared;
+                // Keep visiting boxes at the same distance so ties go to the lowest id
+                return std::nextafter(distanceSquared, std::numeric_limits<float>::infinity());
+            }
+            return bestDistanceSquared;
+        };
+        const float bestDistanceSquared = staticTree.Nearest(x, y, hitDistanceSquared, visit);
+        movingTree.Nearest(x, y, bestDistanceSquared, visit);
+        return hitId != -1;
+    }
+
+    /**
+     * @brief Gets the box a proxy was last set with
+     *
+     * @param id The id of a stored proxy
+     * @return The box of the proxy
+     */
+    const AABB& GetBox(int id) const {
+        return proxies[id].box;
+    }
+
+private:
+    /**
+     * @brief State of a stored collider
+     */
+    struct Proxy {
+        AABB box;                          ///< Box as last set
+        int leaf = AABBTree::NULL_NODE;    ///< Leaf in the tree it lives in
+        unsigned int layer = 0;            ///< Collision layer bits
+        unsigned int mask = 0;             ///< Collision layers it can pair with
+        bool isStatic = false;             ///< Whether it lives in the static tree
+        bool seen = false;                 ///< Set since the last RemoveStale
+    };
+
+    std::vector<Proxy> proxies;
+    std::vector<int> activeIds;
+    AABBTree staticTree;
+    AABBTree movingTree;
+
+    AABBTree& GetTree(bool isStatic) {
+        return isStatic ? staticTree : movingTree;
+    }
+
+    static bool CanPair(const Proxy& a, const Proxy& b) {
+        return (a.layer & b.mask) != 0 && (b.layer & a.mask) != 0;
+    }
+
+    void RemoveProxy(Proxy& proxy) {
+        GetTree(proxy.isStatic).Remove(proxy.leaf);
+        proxy.leaf = AABBTree::NULL_NODE;
+    }
+
+    /**
+     * @brief Enlarges a box by the margin and by twice its displacement
+     *
+     * Extending the box in the direction of motion lets a moving collider
+     * stay in the same leaf for several frames.
+     */
+    static AABB Fatten(const AABB& box, float dx, float dy) {
+        AABB fat;
+        fat.minX = box.minX - FAT_MARGIN + std::min(0.0f, 2.0f * dx);
+        fat.minY = box.minY - FAT_MARGIN + std::min(0.0f, 2.0f * dy);
+        fat.maxX = box.maxX + FAT_MARGIN + std::max(0.0f, 2.0f * dx);
+        fat.maxY = box.maxY + FAT_MARGIN + std::max(0.0f, 2.0f * dy);
+        return fat;
+    }
+};
+
+#endif // !AABBTREE_HPP
@@ -0,0 +1,87 @@
+/**
+ * @file ContactBuffers.hpp
+ * @brief Per-chunk buffers used to find collision contacts on worker threads
+ */
+
+#ifndef CONTACTBUFFERS_HPP
+#define CONTACTBUFFERS_HPP
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "../JobSystem/JobSystem.hpp"
+
+/**
+ * @class ContactBuffers
+ * @brief Splits the search for touching pairs in chunks and merges the result
+ *
+ * The proxies of a broadphase are split in chunks of CHUNK_SIZE and each chunk
+ * runs as a job that finds the candidate pairs of its proxies and tests them
+ * in the narrowphase. Every chunk writes to its own buffer, so the jobs never
+ * share memory and need no locks. Once all of them are done, the pairs that
+ * touch are merged and sorted by entity id on the calling thread, so the
+ * result does not depend on how the jobs were scheduled and events can be
+ * sent in the same order as with a single thread.
+ *
+ * The buffers are kept between frames to reuse their storage.
+ */
+class ContactBuffers {
+public:
+    /**
+     * @brief Number of proxies searched by each job
+     */
+    static constexpr int CHUNK_SIZE = 128;
+
+    /**
+     * @brief Pairs found by one chunk
+     */
+    struct Buffer {
+        std::vector<std::pair<int, int>> pairs;   ///< Candidate pairs of entity ids
+        std::vector<unsigned char> hits;          ///< 1 for each candidate pair that touches
+    };
+
+    /**
+     * @brief Runs a search over every chunk of proxies and waits for all of them
+     *
+     * @tparam TFunc Callable as func(int begin, int end, Buffer& buffer), which
+     *               fills the buffer with the candidates of proxies [begin, end)
+     *               and the narrowphase result of each one
+     * @param jobSystem Workers that run the chunks
+     * @param count Number of proxies
+     * @param func Function called once per chunk
+     */
+    template <typename TFunc>
+    void Run(JobSystem& jobSystem, int count, TFunc&& func) {
+        chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (buffers.size() < static_cast<size_t>(chunkCount)) {
+            buffers.resize(chunkCount);
+        }
+        jobSystem.ParallelFor(count, CHUNK_SIZE, [&](int begin, int end) {
+            func(begin, end, buffers[begin / CHUNK_SIZE]);
+        });
+    }
+
+    /**
+     * @brief Collects the pairs that touch from the buffers of the last Run
+     *
+     * @param contacts Receives the pairs, as (lower id, higher id) sorted by
+     *                 entity id; it is cleared first
+     */
+    void Merge(std::vector<std::pair<int, int>>& contacts) const {
+        contacts.clear();
+        for (int chunk = 0; chunk < chunkCount; chunk++) {
+            const Buffer& buffer = buffers[chunk];
+            for (size_t i = 0; i < buffer.pairs.size(); i++) {
+                if (buffer.hits[i]) {
+                    contacts.push_back(buffer.pairs[i]);
+                }
+            }
+        }
+        std::sort(contacts.begin(), contacts.end());
+    }
+
+private:
+    std::vector<Buffer> buffers;
+    int chunkCount = 0;
+};
+
+#endif // !CONTACTBUFFERS_HPP
@@ -0,0 +1,130 @@
+/**
+ * @file ContactCache.hpp
+ * @brief Set of touching collider pairs kept between frames
+ */
+
+#ifndef CONTACTCACHE_HPP
+#define CONTACTCACHE_HPP
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "../ECS/ECS.hpp"
+
+/**
+ * @enum ContactState
+ * @brief Whether a touching pair started touching this frame or was already touching
+ */
+enum class ContactState {
+    Enter,   ///< The pair was not touching in the previous frame
+    Stay     ///< The pair was already touching in the previous frame
+};
+
+/**
+ * @class ContactCache
+ * @brief Tracks which pairs of entities are touching to report contact transitions
+ *
+ * Each frame the collision system adds every pair that is touching, and the
+ * cache tells whether the pair just started touching or was already touching.
+ * When the frame ends, the pairs of the previous frame that were not added
+ * again are reported as exits.
+ *
+ * Contacts are kept in vectors sorted by pair key, so looking up a pair is a
+ * binary search and finding the exits is a single merge of both frames. The
+ * storage of both vectors is reused between frames.
+ */
+class ContactCache {
+public:
+    /**
+     * @brief A pair of touching entities
+     */
+    struct Contact {
+        uint64_t key;   ///< Key built from both entity ids, lower id first
+        Entity a;       ///< Entity with the lower id
+        Entity b;       ///< Entity with the higher id
+    };
+
+    /**
+     * @brief Starts a new frame of contacts
+     */
+    void Begin() {
+        current.clear();
+    }
+
+    /**
+     * @brief Adds a pair that is touching in the current frame
+     *
+     * @param a The first entity of the pair
+     * @param b The second entity of the pair
+     * @return Enter if the pair was not touching in the previous frame, Stay otherwise
+     */
+    ContactState Add(Entity a, Entity b) {
+        if (b.GetId() < a.GetId()) {
+            std::swap(a, b);
+        }
+        const uint64_t key = MakeKey(a.GetId(), b.GetId());
+        current.push_back({ key, a, b });
+        auto it = std::lower_bound(previous.begin(), previous.end(), key, CompareKey);
+        // A pair whose entity was replaced by a new one with the same id starts a new contact
+        if (it != previous.end() && it->key == key && it->a == a && it->b == b) {
+            return ContactState::Stay;
+        }
+        return ContactState::Enter;
+    }
+
+    /**
+     * @brief Ends the frame and reports the pairs that stopped touching
+     *
+     * @tparam TFunc Callable taking the Contact that ended
+     * @param onExit Function called once per pair of the previous frame that was not added again
+     */
+    template <typename TFunc>
+    void End(TFunc&& onExit) {
+        if (!std::is_sorted(current.begin(), current.end(), CompareContacts)) {
+            std::sort(current.begin(), current.end(), CompareContacts);
+        }
+        auto it = current.begin();
+        for (const Contact& contact : previous) {
+            while (it != current.end() && it->key < contact.key) {
+                ++it;
+            }
+            if (it == current.end() || it->key != contact.key || it->a != contact.a || it->b != contact.b) {
+                onExit(contact);
+            }
+        }
+        std::swap(previous, current);
+    }
+
+    /**
+     * @brief Forgets every contact without reporting exits
+     */
+    void Clear() {
+        previous.clear();
+        current.clear();
+    }
+
+private:
+    /**
+     * @brief Contacts of the previous frame, sorted by key
+     */
+    std::vector<Contact> previous;
+
+    /**
+     * @brief Contacts added during the current frame
+     */
+    std::vector<Contact> current;
+
+    static uint64_t MakeKey(int a, int b) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    }
+
+    static bool CompareKey(const Contact& contact, uint64_t key) {
+        return contact.key < key;
+    }
+
+    static bool CompareContacts(const Contact& a, const Contact& b) {
+        return a.key < b.key;
+    }
+};
+
+#endif // !CONTACTCACHE_HPP
@@ -0,0 +1,383 @@
+/**
+ * @file NarrowPhase.hpp
+ * @brief Batched collision tests over collider bounds stored as structure of arrays
+ */
+
+#ifndef NARROWPHASE_HPP
+#define NARROWPHASE_HPP
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NARROWPHASE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit the instructions of a function compiled for a wider instruction set
+#if defined(NARROWPHASE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NARROWPHASE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NARROWPHASE_TARGET(isa)
+#endif
+
+/**
+ * @enum SimdLevel
+ * @brief Instruction sets the narrowphase kernels can use, from narrowest to widest
+ */
+enum class SimdLevel {
+    Scalar,   ///< One pair at a time, on any CPU
+    SSE2,     ///< Four pairs at a time
+    AVX2      ///< Eight pairs at a time, loading the bounds with gathers
+};
+
+/**
+ * @struct BoxBatch
+ * @brief Bounds of the box colliders of a frame, one array per side, indexed by entity id
+ */
+struct BoxBatch {
+    std::vector<float> minX;   ///< Left side of each box
+    std::vector<float> minY;   ///< Top side of each box
+    std::vector<float> maxX;   ///< Right side of each box
+    std::vector<float> maxY;   ///< Bottom side of each box
+
+    /**
+     * @brief Stores the bounds of a box, growing the arrays if needed
+     *
+     * @param id The entity id of the collider
+     * @param left Left side of the box
+     * @param top Top side of the box
+     * @param right Right side of the box
+     * @param bottom Bottom side of the box
+     */
+    void Set(int id, float left, float top, float right, float bottom) {
+        if (static_cast<size_t>(id) >= minX.size()) {
+            const size_t size = id + 100;
+            minX.resize(size);
+            minY.resize(size);
+            maxX.resize(size);
+            maxY.resize(size);
+        }
+        minX[id] = left;
+        minY[id] = top;
+        maxX[id] = right;
+        maxY[id] = bottom;
+    }
+};
+
+/**
+ * @struct CircleBatch
+ * @brief Circles of the colliders of a frame, one array per field, indexed by entity id
+ */
+struct CircleBatch {
+    std::vector<float> x;        ///< X coordinate of each center
+    std::vector<float> y;        ///< Y coordinate of each center
+    std::vector<float> radius;   ///< Radius of each circle
+
+    /**
+     * @brief Stores a circle, growing the arrays if needed
+     *
+     * @param id The entity id of the collider
+     * @param centerX X coordinate of the center
+     * @param centerY Y coordinate of the center
+     * @param r Radius of the circle
+     */
+    void Set(int id, float centerX, float centerY, float r) {
+        if (static_cast<size_t>(id) >= x.size()) {
+            const size_t size = id + 100;
+            x.resize(size);
+            y.resize(size);
+            radius.resize(size);
+        }
+        x[id] = centerX;
+        y[id] = centerY;
+        radius[id] = r;
+    }
+};
+
+/**
+ * @class NarrowPhase
+ * @brief Tests the candidate pairs of a broadphase in batches
+ *
+ * The bounds of every collider are gathered once per frame into a BoxBatch
+ * or CircleBatch, and the kernels test several pairs with each instruction:
+ * eight with AVX2 and four with SSE2. The widest instruction set supported by
+ * the CPU is detected the first time a kernel runs, and the scalar kernel is
+ * used on other CPUs and for the pairs left over at the end of a batch. Every
+ * kernel gives the same result as the scalar one.
+ *
+ * Boxes default to SSE2 even on AVX2 CPUs: the box test is four compares,
+ * so the AVX2 kernel spends more on its gathers than it saves and measured
+ * slower than SSE2 (bench/NarrowPhaseBench.cpp). Circles use AVX2.
+ */
+class NarrowPhase {
+public:
+    /**
+     * @brief Gets the instruction set used by the circle kernel
+     */
+    static SimdLevel GetSimdLevel() {
+        return ActiveLevel();
+    }
+
+    /**
+     * @brief Gets the instruction set used by the box kernel
+     */
+    static SimdLevel GetBoxSimdLevel() {
+        return ActiveBoxLevel();
+    }
+
+    /**
+     * @brief Selects the instruction set used by both kernels
+     *
+     * Levels the CPU does not support are lowered to the widest supported one.
+     * Unlike the default, an explicit AVX2 also applies to boxes, so the box
+     * kernels can be compared.
+     *
+     * @param level The requested instruction set
+     */
+    static void SetSimdLevel(SimdLevel level) {
+        ActiveLevel() = std::min(level, DetectSimdLevel());
+        ActiveBoxLevel() = ActiveLevel();
+    }
+
+    /**
+     * @brief Tests which pairs of boxes overlap
+     *
+     * Boxes that only touch do not overlap.
+     *
+     * @param boxes Bounds of the colliders, indexed by entity id
+     * @param pairs Pairs of entity ids to test
+     * @param hits Receives 1 for each pair that overlaps and 0 otherwise
+     */
+    static void TestBoxes(const BoxBatch& boxes, const std::vector<std::pair<int, int>>& pairs,
+                          std::vector<unsigned char>& hits) {
+        hits.resize(pairs.size());
+        size_t done = 0;
+#if defined(NARROWPHASE_X86)
+        if (GetBoxSimdLevel() == SimdLevel::AVX2) {
+            done = TestBoxesAVX2(boxes, pairs.data(), pairs.size(), hits.data());
+        }
+        else if (GetBoxSimdLevel() == SimdLevel::SSE2) {
+            done = TestBoxesSSE2(boxes, pairs.data(), pairs.size(), hits.data());
+        }
+#endif
+        TestBoxesScalar(boxes, pairs.data(), done, pairs.size(), hits.data());
+    }
+
+    /**
+     * @brief Tests which pairs of circles overlap or touch
+     *
+     * @param circles Circles of the colliders, indexed by entity id
+     * @param pairs Pairs of entity ids to test
+     * @param hits Receives 1 for each pair that collides and 0 otherwise
+     */
+    static void TestCircles(const CircleBatch& circles, const std::vector<std::pair<int, int>>& pairs,
+                            std::vector<unsigned char>& hits) {
+        hits.resize(pairs.size());
+        size_t done = 0;
+#if defined(NARROWPHASE_X86)
+        if (GetSimdLevel() == SimdLevel::AVX2) {
+            done = TestCirclesAVX2(circles, pairs.data(), pairs.size(), hits.data());
+        }
+        else if (GetSimdLevel() == SimdLevel::SSE2) {
+            done = TestCirclesSSE2(circles, pairs.data(), pairs.size(), hits.data());
+        }
+#endif
+        TestCirclesScalar(circles, pairs.data(), done, pairs.size(), hits.data());
+    }
+
+    /**
+     * @brief Checks which instruction sets the CPU and the operating system support
+     *
+     * @return The widest instruction set the kernels can use
+     */
+    static SimdLevel DetectSimdLevel() {
+#if defined(NARROWPHASE_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return SimdLevel::SSE2;
+        }
+#elif defined(NARROWPHASE_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        // AVX registers are only usable if the operating system saves them
+        if (maxLeaf >= 7 && osUsesXSave && avx && (_xgetbv(0) & 6) == 6) {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5)) {
+                return SimdLevel::AVX2;
+            }
+        }
+        if (sse2) {
+            return SimdLevel::SSE2;
+        }
+#endif
+        return SimdLevel::Scalar;
+    }
+
+private:
+    static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int), "pairs are loaded as consecutive ints");
+
+    static SimdLevel& ActiveLevel() {
+        static SimdLevel level = DetectSimdLevel();
+        return level;
+    }
+
+    static SimdLevel& ActiveBoxLevel() {
+        static SimdLevel level = std::min(DetectSimdLevel(), SimdLevel::SSE2);
+        return level;
+    }
+
+    static void TestBoxesScalar(const BoxBatch& boxes, const std::pair<int, int>* pairs,
+                                size_t begin, size_t end, unsigned char* hits) {
+        for (size_t i = begin; i < end; i++) {
+            const int a = pairs[i].first;
+            const int b = pairs[i].second;
+            hits[i] = boxes.minX[a] < boxes.maxX[b] && boxes.maxX[a] > boxes.minX[b]
+                && boxes.minY[a] < boxes.maxY[b] && boxes.maxY[a] > boxes.minY[b];
+        }
+    }
+
+    static void TestCirclesScalar(const CircleBatch& circles, const std::pair<int, int>* pairs,
+                                  size_t begin, size_t end, unsigned char* hits) {
+        for (size_t i = begin; i < end; i++) {
+            const int a = pairs[i].first;
+            const int b = pairs[i].second;
+            const float dx = circles.x[a] - circles.x[b];
+            const float dy = circles.y[a] - circles.y[b];
+            const float dx2 = dx * dx;
+            const float dy2 = dy * dy;
+            const float lengthSquared = dx2 + dy2;
+            const float radii = circles.radius[a] + circles.radius[b];
+            hits[i] = radii >= 0.0f && radii * radii >= lengthSquared;
+        }
+    }
+
+#if defined(NARROWPHASE_X86)
+    NARROWPHASE_TARGET("sse2")
+    static size_t TestBoxesSSE2(const BoxBatch& boxes, const std::pair<int, int>* pairs,
+                                size_t count, unsigned char* hits) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const int a0 = pairs[i].first, a1 = pairs[i + 1].first, a2 = pairs[i + 2].first, a3 = pairs[i + 3].first;
+            const int b0 = pairs[i].second, b1 = pairs[i + 1].second, b2 = pairs[i + 2].second, b3 = pairs[i + 3].second;
+            const __m128 aMinX = _mm_setr_ps(boxes.minX[a0], boxes.minX[a1], boxes.minX[a2], boxes.minX[a3]);
+            const __m128 aMinY = _mm_setr_ps(boxes.minY[a0], boxes.minY[a1], boxes.minY[a2], boxes.minY[a3]);
+            const __m128 aMaxX = _mm_setr_ps(boxes.maxX[a0], boxes.maxX[a1], boxes.maxX[a2], boxes.maxX[a3]);
+            const __m128 aMaxY = _mm_setr_ps(boxes.maxY[a0], boxes.maxY[a1], boxes.maxY[a2], boxes.maxY[a3]);
+            const __m128 bMinX = _mm_setr_ps(boxes.minX[b0], boxes.minX[b1], boxes.minX[b2], boxes.minX[b3]);
+            const __m128 bMinY = _mm_setr_ps(boxes.minY[b0], boxes.minY[b1], boxes.minY[b2], boxes.minY[b3]);
+            const __m128 bMaxX = _mm_setr_ps(boxes.maxX[b0], boxes.maxX[b1], boxes.maxX[b2], boxes.maxX[b3]);
+            const __m128 bMaxY = _mm_setr_ps(boxes.maxY[b0], boxes.maxY[b1], boxes.maxY[b2], boxes.maxY[b3]);
+            const __m128 overlapX = _mm_and_ps(_mm_cmplt_ps(aMinX, bMaxX), _mm_cmpgt_ps(aMaxX, bMinX));
+            const __m128 overlapY = _mm_and_ps(_mm_cmplt_ps(aMinY, bMaxY), _mm_cmpgt_ps(aMaxY, bMinY));
+            StoreHits(_mm_movemask_ps(_mm_and_ps(overlapX, overlapY)), 4, hits + i);
+        }
+        return i;
+    }
+
+    NARROWPHASE_TARGET("sse2")
+    static size_t TestCirclesSSE2(const CircleBatch& circles, const std::pair<int, int>* pairs,
+                                  size_t count, unsigned char* hits) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const int a0 = pairs[i].first, a1 = pairs[i + 1].first, a2 = pairs[i + 2].first, a3 = pairs[i + 3].first;
+            const int b0 = pairs[i].second, b1 = pairs[i + 1].second, b2 = pairs[i + 2].second, b3 = pairs[i + 3].second;
+            const __m128 dx = _mm_sub_ps(
+                _mm_setr_ps(circles.x[a0], circles.x[a1], circles.x[a2], circles.x[a3]),
+                _mm_setr_ps(circles.x[b0], circles.x[b1], circles.x[b2], circles.x[b3]));
+            const __m128 dy = _mm_sub_ps(
+                _mm_setr_ps(circles.y[a0], circles.y[a1], circles.y[a2], circles.y[a3]),
+                _mm_setr_ps(circles.y[b0], circles.y[b1], circles.y[b2], circles.y[b3]));
+            const __m128 radii = _mm_add_ps(
+                _mm_setr_ps(circles.radius[a0], circles.radius[a1], circles.radius[a2], circles.radius[a3]),
+                _mm_setr_ps(circles.radius[b0], circles.radius[b1], circles.radius[b2], circles.radius[b3]));
+            const __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            const __m128 collide = _mm_and_ps(_mm_cmpge_ps(radii, _mm_setzero_ps()),
+                                              _mm_cmpge_ps(_mm_mul_ps(radii, radii), lengthSquared));
+            StoreHits(_mm_movemask_ps(collide), 4, hits + i);
+        }
+        return i;
+    }
+
+    /**
+     * @brief Loads the entity ids of eight pairs, first ids and second ids in separate registers
+     */
+    NARROWPHASE_TARGET("avx2")
+    static void LoadPairsAVX2(const std::pair<int, int>* pairs, __m256i& first, __m256i& second) {
+        // a0 b0 a1 b1 a2 b2 a3 b3 and a4 b4 a5 b5 a6 b6 a7 b7
+        const __m256 low = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs)));
+        const __m256 high = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 4)));
+        // Shuffles work inside each 128-bit half, giving a0 a1 a4 a5 a2 a3 a6 a7, so the halves are reordered after
+        const __m256i evens = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m256i odds = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+        first = _mm256_permute4x64_epi64(evens, _MM_SHUFFLE(3, 1, 2, 0));
+        second = _mm256_permute4x64_epi64(odds, _MM_SHUFFLE(3, 1, 2, 0));
+    }
+
+    NARROWPHASE_TARGET("avx2")
+    static size_t TestBoxesAVX2(const BoxBatch& boxes, const std::pair<int, int>* pairs,
+                                size_t count, unsigned char* hits) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i a, b;
+            LoadPairsAVX2(pairs + i, a, b);
+            const __m256 aMinX = _mm256_i32gather_ps(boxes.minX.data(), a, 4);
+            const __m256 aMinY = _mm256_i32gather_ps(boxes.minY.data(), a, 4);
+            const __m256 aMaxX = _mm256_i32gather_ps(boxes.maxX.data(), a, 4);
+            const __m256 aMaxY = _mm256_i32gather_ps(boxes.maxY.data(), a, 4);
+            const __m256 bMinX = _mm256_i32gather_ps(boxes.minX.data(), b, 4);
+            const __m256 bMinY = _mm256_i32gather_ps(boxes.minY.data(), b, 4);
+            const __m256 bMaxX = _mm256_i32gather_ps(boxes.maxX.data(), b, 4);
+            const __m256 bMaxY = _mm256_i32gather_ps(boxes.maxY.data(), b, 4);
+            const __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(aMinX, bMaxX, _CMP_LT_OQ),
+                                                  _mm256_cmp_ps(aMaxX, bMinX, _CMP_GT_OQ));
+            const __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(aMinY, bMaxY, _CMP_LT_OQ),
+                                                  _mm256_cmp_ps(aMaxY, bMinY, _CMP_GT_OQ));
+            StoreHits(_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY)), 8, hits + i);
+        }
+        return i;
+    }
+
+    NARROWPHASE_TARGET("avx2")
+    static size_t TestCirclesAVX2(const CircleBatch& circles, const std::pair<int, int>* pairs,
+                                  size_t count, unsigned char* hits) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i a, b;
+            LoadPairsAVX2(pairs + i, a, b);
+            const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(circles.x.data(), a, 4),
+                                            _mm256_i32gather_ps(circles.x.data(), b, 4));
+            const __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(circles.y.data(), a, 4),
+                                            _mm256_i32gather_ps(circles.y.data(), b, 4));
+            const __m256 radii = _mm256_add_ps(_mm256_i32gather_ps(circles.radius.data(), a, 4),
+                                               _mm256_i32gather_ps(circles.radius.data(), b, 4));
+            // Separate multiply and add, without FMA, to round exactly like the scalar kernel
+            const __m256 lengthSquared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+            const __m256 collide = _mm256_and_ps(_mm256_cmp_ps(radii, _mm256_setzero_ps(), _CMP_GE_OQ),
+                                                 _mm256_cmp_ps(_mm256_mul_ps(radii, radii), lengthSquared, _CMP_GE_OQ));
+            StoreHits(_mm256_movemask_ps(collide), 8, hits + i);
+        }
+        return i;
+    }
+#endif
+
+    static void StoreHits(int mask, int lanes, unsigned char* hits) {
+        for (int lane = 0; lane < lanes; lane++) {
+            hits[lane] = (mask >> lane) & 1;
+        }
+    }
+};
+
+#endif // !NARROWPHASE_HPP
@@ -1,17 +1,19 @@
 /**
  * @file Pool.hpp
- * @brief Template-based object pool implementation for ECS component storage
+ * @brief Sparse-set object pool implementation for ECS component storage
  */
 
 #ifndef POOL_HPP
 #define POOL_HPP
 #include <vector>
+#include <cassert>
+#include <utility>
 //std::vector<IPool> pools;
 
 /**
  * @class IPool
  * @brief Base interface for type-erased component pools
- * 
+ *
  * This interface allows different typed pools to be stored in the same
  * container while maintaining type safety through virtual dispatch.
  */
@@ -21,135 +23,290 @@ public:
      * @brief Virtual destructor for proper cleanup of derived classes
      */
     virtual ~IPool() = default;
+
+    /**
+     * @brief Removes the component owned by an entity, if there is one
+     *
+     * Lets the registry clean up every pool of a killed entity without
+     * knowing the concrete component types.
+     *
+     * @param entityId The id of the entity whose component is removed
+     */
+    virtual void RemoveEntityFromPool(int entityId) = 0;
 };
 
 /**
  * @class Pool
- * @brief Template-based pool for storing components of a specific type
- * 
- * This class provides efficient storage and access for components in an ECS
- * system. It uses a contiguous vector for cache-friendly memory layout and
- * provides indexed access to components.
- * 
+ * @brief Sparse-set pool for storing components of a specific type
+ *
+ * Components are kept packed in a dense vector, so the pool only grows with
+ * the number of entities that actually own this component. A sparse vector
+ * maps each entity id to its slot in the dense vector, and a parallel dense
+ * vector maps each slot back to its entity id. Removal swaps the last
+ * component into the freed slot, which keeps the dense storage contiguous
+ * and lets systems iterate only live components.
+ *
  * @tparam TComponent The type of component to store in this pool
  */
 template <typename TComponent>
 class Pool : public IPool {
 public:
     /**
-     * @brief Constructor that initializes the pool with a specified capacity
-     * 
-     * Creates a pool with preallocated storage to avoid frequent reallocations
-     * during component addition.
-     * 
-     * @param size Initial capacity of the pool (default: 1000)
+     * @brief Constructor that reserves storage for a number of components
+     *
+     * Reserves dense storage to avoid frequent reallocations during
+     * component addition. No components are created.
+     *
+     * @param capacity Initial capacity of the pool (default: 100)
      */
-    Pool(int size = 1000) {
-        data.resize(size);
+    Pool(int capacity = 100) {
+        data.reserve(capacity);
+        indexToEntityId.reserve(capacity);
     }
-    
+
     /**
      * @brief Virtual destructor for proper cleanup
      */
     virtual ~Pool() = default;
-    
+
     /**
      * @brief Checks if the pool contains no components
-     * 
+     *
      * @return true if the pool is empty, false otherwise
      */
     bool isEmpty() const {
         return data.empty();
     }
-    
+
     /**
-     * @brief Gets the current size of the pool
-     * 
-     * @return The number of elements the pool can currently hold
+     * @brief Gets the number of live components in the pool
+     *
+     * @return The number of components currently stored
      */
     int GetSize() const {
         return static_cast<int>(data.size());
     }
-    
-    /**
-     * @brief Resizes the pool to a new capacity
-     * 
-     * This operation may invalidate existing references to components
-     * if the new size is smaller than the current size.
-     * 
-     * @param n New capacity of the pool
-     */
-    void Resize(int n) {
-        data.resize(n);
-    }
-    
+
     /**
      * @brief Clears all components from the pool
-     * 
-     * This operation removes all elements and may deallocate memory,
-     * invalidating all existing references to components.
+     *
+     * This operation removes all elements and invalidates all existing
+     * references to components.
      */
     void Clear() {
         data.clear();
+        indexToEntityId.clear();
+        entityIdToIndex.clear();
+    }
+
+    /**
+     * @brief Checks if an entity owns a component in this pool
+     *
+     * @param entityId The id of the entity to check
+     * @return true if the entity has a component stored, false otherwise
+     */
+    bool Has(int entityId) const {
+        return entityId >= 0
+            && static_cast<size_t>(entityId) < entityIdToIndex.size()
+            && entityIdToIndex[entityId] != INVALID_INDEX;
+    }
+
+    /**
+     * @brief Sets the component of an entity
+     *
+     * Overwrites the component if the entity already owns one, otherwise
+     * appends it to the dense storage. Appending may cause reallocation,
+     * invalidating existing references.
+     *
+     * @param entityId The id of the entity that owns the component
+     * @param object The component to store for the entity
+     */
+    void Set(int entityId, TComponent object) {
+        if (Has(entityId)) {
+            data[entityIdToIndex[entityId]] = std::move(object);
+            return;
+        }
+        if (static_cast<size_t>(entityId) >= entityIdToIndex.size()) {
+            entityIdToIndex.resize(entityId + 100, INVALID_INDEX);
+        }
+        entityIdToIndex[entityId] = static_cast<int>(data.size());
+        indexToEntityId.push_back(entityId);
+        data.push_back(std::move(object));
+    }
+
+    /**
+     * @brief Constructs the component of an entity in place
+     *
+     * Arguments are forwarded to the component constructor, so the component
+     * is built directly in the dense storage with no temporary to copy. This
+     * also works for move-only components. If the entity already owns a
+     * component it is replaced.
+     *
+     * @tparam TArgs Types of the constructor arguments
+     * @param entityId The id of the entity that owns the component
+     * @param args Arguments forwarded to the component constructor
+     * @return Reference to the stored component
+     */
+    template <typename... TArgs>
+    TComponent& Emplace(int entityId, TArgs&&... args) {
+        if (Has(entityId)) {
+            TComponent& component = data[entityIdToIndex[entityId]];
+            component = TComponent(std::forward<TArgs>(args)...);
+            return component;
+        }
+        if (static_cast<size_t>(entityId) >= entityIdToIndex.size()) {
+            entityIdToIndex.resize(entityId + 100, INVALID_INDEX);
+        }
+        entityIdToIndex[entityId] = static_cast<int>(data.size());
+        indexToEntityId.push_back(entityId);
+        return data.emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    /**
+     * @brief Removes the component of an entity
+     *
+     * The last component is moved into the freed slot, so this runs in
+     * constant time but changes the iteration order. Does nothing if the
+     * entity has no component in this pool.
+     *
+     * @param entityId The id of the entity whose component is removed
+     */
+    void Remove(int entityId) {
+        if (!Has(entityId)) {
+            return;
+        }
+        const int index = entityIdToIndex[entityId];
+        const int lastIndex = static_cast<int>(data.size()) - 1;
+        if (index != lastIndex) {
+            const int lastEntityId = indexToEntityId[lastIndex];
+            data[index] = std::move(data[lastIndex]);
+            indexToEntityId[index] = lastEntityId;
+            entityIdToIndex[lastEntityId] = index;
+        }
+        data.pop_back();
+        indexToEntityId.pop_back();
+        entityIdToIndex[entityId] = INVALID_INDEX;
+    }
+
+    /**
+     * @brief Removes the component of an entity through the base interface
+     *
+     * @param entityId The id of the entity whose component is removed
+     */
+    void RemoveEntityFromPool(int entityId) override {
+        Remove(entityId);
     }
-    
+
+    /**
+     * @brief Gets a reference to the component of an entity
+     *
+     * The entity must own a component in this pool; check with Has() first
+     * when that is not guaranteed by the caller.
+     *
+     * @param entityId The id of the entity whose component is retrieved
+     * @return Reference to the component of the entity
+     */
+    TComponent& Get(int entityId) {
+        assert(Has(entityId) && "Pool::Get on an entity without a component");
+        return data[entityIdToIndex[entityId]];
+    }
+
+    /**
+     * @brief Operator overload for array-like access by entity id
+     *
+     * Same contract as Get().
+     *
+     * @param entityId The id of the entity whose component is retrieved
+     * @return Reference to the component of the entity
+     */
+    TComponent& operator[](int entityId) {
+        return Get(entityId);
+    }
+
+    /**
+     * @brief Gets the id of the entity owning the component at a dense slot
+     *
+     * @param index Slot in the dense storage, in [0, GetSize())
+     * @return The id of the entity that owns the component
+     */
+    int GetEntityId(int index) const {
+        return indexToEntityId[index];
+    }
+
+    /**
+     * @brief Gets the dense slot holding the component of an entity
+     *
+     * @param entityId The id of the entity, which must own a component here
+     * @return Slot in the dense storage, in [0, GetSize())
+     */
+    int GetIndex(int entityId) const {
+        assert(Has(entityId) && "Pool::GetIndex on an entity without a component");
+        return entityIdToIndex[entityId];
+    }
+
     /**
-     * @brief Adds a component to the end of the pool
-     * 
-     * This operation may cause reallocation if the pool is at capacity,
-     * potentially invalidating existing references.
-     * 
-     * @param object The component to add to the pool
+     * @brief Swaps the components stored at two dense slots
+     *
+     * Both mapping vectors are updated, so every entity keeps its own
+     * component; only the iteration order changes.
+     *
+     * @param first The first slot
+     * @param second The second slot
      */
-    void Add(TComponent object) {
-        data.push_back(object);
+    void SwapSlots(int first, int second) {
+        if (first == second) {
+            return;
+        }
+        std::swap(data[first], data[second]);
+        std::swap(indexToEntityId[first], indexToEntityId[second]);
+        entityIdToIndex[indexToEntityId[first]] = first;
+        entityIdToIndex[indexToEntityId[second]] = second;
     }
-    
+
     /**
-     * @brief Sets a component at a specific index
-     * 
-     * This operation overwrites the component at the given index.
-     * No bounds checking is performed.
-     * 
-     * @param index The index where to place the component
-     * @param object The component to store at the index
+     * @brief Gets a pointer to the packed components
+     *
+     * @return Pointer to the first component, valid until the pool grows
      */
-    void Set(unsigned int index, TComponent object) {
-        data[index] = object;
+    TComponent* GetData() {
+        return data.data();
     }
-    
+
     /**
-     * @brief Gets a reference to the component at a specific index
-     * 
-     * This operation provides direct access to the component for reading
-     * or modification. No bounds checking is performed.
-     * 
-     * @param index The index of the component to retrieve
-     * @return Reference to the component at the specified index
+     * @brief Iterator to the first live component
      */
-    TComponent& Get(unsigned int index) {
-        return static_cast<TComponent&>(data[index]);
+    typename std::vector<TComponent>::iterator begin() {
+        return data.begin();
     }
-    
+
     /**
-     * @brief Operator overload for array-like access to components
-     * 
-     * Provides convenient syntax for accessing components using square brackets.
-     * No bounds checking is performed.
-     * 
-     * @param index The index of the component to retrieve
-     * @return Reference to the component at the specified index
+     * @brief Iterator past the last live component
      */
-    TComponent& operator[](unsigned int index) {
-        return static_cast<TComponent&>(data[index]);
+    typename std::vector<TComponent>::iterator end() {
+        return data.end();
     }
-    
+
 private:
     /**
-     * @brief Internal storage for components
-     * 
+     * @brief Marker stored in the sparse vector for entities without a component
+     */
+    static constexpr int INVALID_INDEX = -1;
+
+    /**
+     * @brief Packed storage for the live components
+     *
      * Uses std::vector for contiguous memory layout and efficient access patterns
      */
     std::vector<TComponent> data;
+
+    /**
+     * @brief Entity id owning each slot of the dense storage
+     */
+    std::vector<int> indexToEntityId;
+
+    /**
+     * @brief Slot in the dense storage for each entity id, or INVALID_INDEX
+     */
+    std::vector<int> entityIdToIndex;
 };
-#endif // !POOL_HPP
\ No newline at end of file
+#endif // !POOL_HPP